@@ -0,0 +1,86 @@
+#include "frame-capture.h"
+#include "gpu-resources.h"
+#include "opengl-wrapper.h"
+
+#include <algorithm>
+
+namespace gl {
+
+    frame_capture::frame_capture(frame_encoder& encoder, size_t ring_size)
+        : m_encoder(encoder), m_slots(std::max<size_t>(ring_size, 1)) {
+
+        for (slot& current: m_slots) {
+            gl::raw::gen_buffers(1, &current.buffer);
+            gpu_resources::on_created(resource_category::BUFFER);
+        }
+    }
+
+    void frame_capture::capture(size_t width, size_t height) {
+        slot& current = m_slots[m_next];
+        m_next = (m_next + 1) % m_slots.size();
+
+        // Read ring_size - 1 frames ago, GPU is almost certainly done with it
+        if (current.is_pending)
+            collect(current);
+
+        if (width == 0 || height == 0)
+            return; // Minimized window
+
+        const size_t size = width * height * 4;
+
+        gl::raw::bind_buffer(GL_PIXEL_PACK_BUFFER, current.buffer);
+        if (current.buffer_size != size) {
+            gl::raw::buffer_data(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) size, nullptr, GL_STREAM_READ);
+
+            gpu_resources::on_resized(resource_category::BUFFER, current.buffer_size, size);
+            current.buffer_size = size;
+        }
+
+        // With a pack buffer bound, this only queues a copy into the buffer
+        gl::raw::pixel_storei(GL_PACK_ALIGNMENT, 1);
+        gl::raw::read_pixels(0, 0, (GLsizei) width, (GLsizei) height,
+                             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        gl::raw::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        current.width = width, current.height = height;
+        current.is_pending = true;
+        current.read.insert();
+    }
+
+    void frame_capture::collect(slot& current) {
+        current.read.wait();
+        current.is_pending = false;
+
+        rgba_image image = m_encoder.acquire_image();
+
+        image.width = current.width, image.height = current.height;
+        image.pixels.resize(current.buffer_size);
+
+        gl::raw::bind_buffer(GL_PIXEL_PACK_BUFFER, current.buffer);
+        gl::raw::get_buffer_sub_data(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) current.buffer_size,
+                                     image.pixels.data());
+        gl::raw::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        ++ m_captured;
+        m_encoder.submit(std::move(image), true);
+    }
+
+    void frame_capture::flush() {
+        // Oldest first, so frames keep their order
+        for (size_t i = 0; i < m_slots.size(); ++ i) {
+            slot& current = m_slots[(m_next + i) % m_slots.size()];
+
+            if (current.is_pending)
+                collect(current);
+        }
+    }
+
+    size_t frame_capture::get_captured_count() const { return m_captured; }
+
+    frame_capture::~frame_capture() {
+        for (slot& current: m_slots)
+            gpu_resources::release(resource_category::BUFFER, current.buffer, current.buffer_size);
+    }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "fence.h"
+#include "frame-encoder.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace gl {
+
+    // Reads frames back without stalling: pixels are copied into one of
+    // /ring_size/ pixel pack buffers asynchronously, and are collected from it
+    // only when the buffer comes around again, that is /ring_size/ - 1 frames
+    // later, when GPU is long done with it. Collected frames go to /encoder/.
+    class frame_capture {
+    public:
+        // Should be created on GL thread, /encoder/ should outlive capture
+        explicit frame_capture(frame_encoder& encoder, size_t ring_size = 3);
+
+        // This class shouldn't be copied or moved
+        frame_capture(const frame_capture&) = delete;
+        frame_capture& operator=(const frame_capture&) = delete;
+
+        // Starts reading current framebuffer (of size in pixels), should be
+        // called after frame is drawn, but before buffers are swapped
+        void capture(size_t width, size_t height);
+
+        // Collects every frame that's still being read (blocks until GPU is
+        // done with them), e.g. once the last frame is captured
+        void flush();
+
+        size_t get_captured_count() const;
+
+        ~frame_capture();
+
+    private:
+        struct slot final {
+            unsigned int buffer = 0;
+            size_t buffer_size = 0;
+
+            size_t width = 0, height = 0;
+            bool is_pending = false;
+
+            fence read;
+        };
+
+        frame_encoder& m_encoder;
+
+        std::vector<slot> m_slots;
+        size_t m_next = 0; // Slot of the next capture, the oldest pending one
+
+        size_t m_captured = 0;
+
+        void collect(slot& current);
+    };
+
+}
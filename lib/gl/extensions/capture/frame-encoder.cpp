@@ -0,0 +1,157 @@
+#include "frame-encoder.h"
+#include "image-files.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    frame_encoder::frame_encoder(write_function write, size_t queue_size)
+        : m_write(std::move(write)), m_queue_size(std::max<size_t>(queue_size, 1)) {
+
+        m_worker = std::thread(&frame_encoder::worker_loop, this);
+    }
+
+    // --------------------------------- DESTINATIONS --------------------------------
+
+    frame_encoder::write_function frame_encoder::image_sequence(std::string prefix, image_format format) {
+        return [prefix = std::move(prefix), format](const rgba_image& image, size_t index) {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%06zu", index);
+
+            if (format == image_format::PNG)
+                image_files::write_png(prefix + number + ".png", image);
+            else
+                image_files::write_ppm(prefix + number + ".ppm", image);
+        };
+    }
+
+    frame_encoder::write_function frame_encoder::raw_pipe(const std::string& command) {
+        std::shared_ptr<FILE> pipe(popen(command.c_str(), "w"), [](FILE* file) {
+            if (file != nullptr)
+                pclose(file);
+        });
+
+        if (pipe == nullptr)
+            throw std::runtime_error("Failed to start \"" + command + "\"!");
+
+        return [pipe](const rgba_image& image, size_t) {
+            if (std::fwrite(image.pixels.data(), 1, image.pixels.size(), pipe.get()) != image.pixels.size())
+                throw std::runtime_error("Failed to write frame to the pipe!");
+        };
+    }
+
+    // ---------------------------------- SUBMISSION ---------------------------------
+
+    rgba_image frame_encoder::acquire_image() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free_images.empty())
+            return {};
+
+        rgba_image image = std::move(m_free_images.back());
+        m_free_images.pop_back();
+
+        return image;
+    }
+
+    void frame_encoder::submit(rgba_image image, bool is_bottom_up) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frame_written.wait(lock, [this] { return m_error || m_queued.size() < m_queue_size; });
+
+            rethrow_error();
+            m_queued.push_back({ std::move(image), is_bottom_up, m_submitted ++ });
+        }
+
+        m_frame_posted.notify_one();
+    }
+
+    void frame_encoder::finish() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_frame_written.wait(lock, [this] { return m_error || (m_queued.empty() && !m_is_writing); });
+
+        rethrow_error();
+    }
+
+    size_t frame_encoder::get_written_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    void frame_encoder::rethrow_error() {
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+    // ------------------------------------ WORKER -----------------------------------
+
+    void frame_encoder::worker_loop() {
+        while (true) {
+            frame current;
+            bool has_failed = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_frame_posted.wait(lock, [this] { return m_stopping || !m_queued.empty(); });
+
+                // Everything that was submitted is still written
+                if (m_queued.empty())
+                    break;
+
+                current = std::move(m_queued.front());
+                m_queued.pop_front();
+
+                m_is_writing = true;
+                has_failed = m_error != nullptr;
+            }
+
+            // After the first error frames are only recycled
+            std::exception_ptr error;
+            try {
+                rgba_image& image = current.image;
+
+                if (current.is_bottom_up) {
+                    const size_t row_size = image.width * 4;
+                    for (size_t y = 0; y < image.height / 2; ++ y)
+                        std::swap_ranges(image.get_pixel(0, y), image.get_pixel(0, y) + row_size,
+                                         image.get_pixel(0, image.height - 1 - y));
+                }
+
+                if (!has_failed)
+                    m_write(image, current.index);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                if (error && !m_error)
+                    m_error = error;
+                else if (!has_failed)
+                    ++ m_written;
+
+                m_is_writing = false;
+
+                // Keeps a queue's worth of images, frames are usually the same size
+                if (m_free_images.size() <= m_queue_size)
+                    m_free_images.push_back(std::move(current.image));
+            }
+
+            m_frame_written.notify_all();
+        }
+    }
+
+    frame_encoder::~frame_encoder() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_frame_posted.notify_one();
+        m_worker.join();
+    }
+
+}
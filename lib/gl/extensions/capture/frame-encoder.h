@@ -0,0 +1,88 @@
+#pragma once
+
+#include "rgba-image.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gl {
+
+    enum class image_format { PPM, PNG };
+
+    // Writes captured frames on a worker thread, so rendering thread only
+    // hands them over. At most /queue_size/ frames wait to be written, when
+    // writing is slower than rendering, submit blocks instead of piling up
+    // frames in memory. Images are recycled once they are written. After the
+    // first error nothing else is written, it's rethrown by submit and finish.
+    class frame_encoder {
+    public:
+        // Called on the worker for each frame, in order of submission
+        using write_function = std::function<void(const rgba_image& frame, size_t index)>;
+
+        explicit frame_encoder(write_function write, size_t queue_size = 4);
+
+        // This class shouldn't be copied or moved
+        frame_encoder(const frame_encoder&) = delete;
+        frame_encoder& operator=(const frame_encoder&) = delete;
+
+        // ==> Ready-made destinations:
+
+        // Files "<prefix><index, six digits>.ppm" (or ".png")
+        static write_function image_sequence(std::string prefix, image_format format);
+
+        // Raw RGBA frames to standard input of /command/, e.g. for a video encoder:
+        // ffmpeg -f rawvideo -pix_fmt rgba -s 1920x1080 -r 60 -i - video.mp4
+        static write_function raw_pipe(const std::string& command);
+
+        // ==> Called on rendering thread:
+
+        // Empty image, or one that was already written (to reuse its memory)
+        rgba_image acquire_image();
+
+        // GL reads rows from bottom to top, /is_bottom_up/ frames are flipped
+        // on the worker
+        void submit(rgba_image frame, bool is_bottom_up = false);
+
+        // Waits until every submitted frame is written
+        void finish();
+
+        size_t get_written_count() const;
+
+        // Writes what's already submitted, errors are dropped
+        ~frame_encoder();
+
+    private:
+        struct frame final {
+            rgba_image image;
+            bool is_bottom_up;
+            size_t index;
+        };
+
+        write_function m_write;
+        const size_t m_queue_size;
+
+        std::thread m_worker;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_frame_posted, m_frame_written;
+
+        std::deque<frame> m_queued;
+        std::vector<rgba_image> m_free_images;
+
+        size_t m_submitted = 0, m_written = 0;
+        bool m_is_writing = false, m_stopping = false;
+
+        std::exception_ptr m_error;
+
+        void worker_loop();
+        void rethrow_error(); // Should be called with mutex locked
+    };
+
+}
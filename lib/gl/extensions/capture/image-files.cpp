@@ -0,0 +1,182 @@
+#include "image-files.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace gl::image_files {
+
+    static std::ofstream open_file(const std::string& path) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Failed to open image file \"" + path + "\"!");
+
+        return file;
+    }
+
+    static void close_file(std::ofstream& file, const std::string& path) {
+        file.close();
+        if (!file)
+            throw std::runtime_error("Failed to write image file \"" + path + "\"!");
+    }
+
+    // ------------------------------------- PPM -------------------------------------
+
+    void write_ppm(const std::string& path, const rgba_image& image) {
+        std::ofstream file = open_file(path);
+        file << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+        std::vector<char> row(image.width * 3);
+        for (size_t y = 0; y < image.height; ++ y) {
+            const uint8_t* pixel = image.get_pixel(0, y);
+
+            for (size_t x = 0; x < image.width; ++ x, pixel += 4)
+                std::copy(pixel, pixel + 3, row.begin() + x * 3);
+
+            file.write(row.data(), (std::streamsize) row.size());
+        }
+
+        close_file(file, path);
+    }
+
+    // ------------------------------------- PNG -------------------------------------
+
+    static const std::array<uint32_t, 256>& get_crc_table() {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> result {};
+
+            for (uint32_t i = 0; i < 256; ++ i) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; ++ bit)
+                    value = value & 1 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+
+                result[i] = value;
+            }
+
+            return result;
+        }();
+
+        return table;
+    }
+
+    static void append_u32(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back((uint8_t) (value >> 24)), out.push_back((uint8_t) (value >> 16));
+        out.push_back((uint8_t) (value >> 8)),  out.push_back((uint8_t) value);
+    }
+
+    static uint32_t update_crc(uint32_t crc, const uint8_t* data, size_t size) {
+        const std::array<uint32_t, 256>& table = get_crc_table();
+
+        for (size_t i = 0; i < size; ++ i)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+        return crc;
+    }
+
+    // Sums are reduced once per 5552 bytes, the most that can't overflow
+    static void update_adler(uint32_t& a, uint32_t& b, const uint8_t* data, size_t size) {
+        while (size > 0) {
+            const size_t count = std::min<size_t>(size, 5552);
+
+            for (size_t i = 0; i < count; ++ i)
+                a += data[i], b += a;
+
+            a %= 65521, b %= 65521;
+            data += count, size -= count;
+        }
+    }
+
+    // Length, type, data and CRC of type and data
+    static void write_chunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> prefix, suffix;
+
+        append_u32(prefix, (uint32_t) data.size());
+        prefix.insert(prefix.end(), type, type + 4);
+
+        uint32_t crc = update_crc(0xffffffffu, prefix.data() + 4, 4);
+        crc = update_crc(crc, data.data(), data.size());
+
+        append_u32(suffix, crc ^ 0xffffffffu);
+
+        file.write((const char*) prefix.data(), (std::streamsize) prefix.size());
+        file.write((const char*) data.data(), (std::streamsize) data.size());
+        file.write((const char*) suffix.data(), (std::streamsize) suffix.size());
+    }
+
+    void write_png(const std::string& path, const rgba_image& image) {
+        if (image.width == 0 || image.height == 0)
+            throw std::invalid_argument("PNG image can't be empty!");
+
+        std::ofstream file = open_file(path);
+
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        file.write((const char*) signature, sizeof(signature));
+
+        std::vector<uint8_t> header;
+        append_u32(header, (uint32_t) image.width);
+        append_u32(header, (uint32_t) image.height);
+
+        // 8 bits per channel, RGBA, default compression, filtering and no interlace
+        header.insert(header.end(), { 8, 6, 0, 0, 0 });
+        write_chunk(file, "IHDR", header);
+
+        // ==> Scanlines (each starts with "no filter" byte) in a zlib stream:
+
+        const size_t row_size = image.width * 4 + 1;
+        const size_t raw_size = row_size * image.height;
+
+        constexpr size_t max_block = 65535; // Largest stored block
+        const size_t block_count = (raw_size + max_block - 1) / max_block;
+
+        std::vector<uint8_t> stream;
+        stream.reserve(2 + raw_size + block_count * 5 + 4);
+        stream.insert(stream.end(), { 0x78, 0x01 });
+
+        uint32_t adler_a = 1, adler_b = 0;
+        size_t written = 0, row_offset = 0, y = 0;
+
+        while (written < raw_size) {
+            const size_t block = std::min(max_block, raw_size - written);
+            const bool is_last = written + block == raw_size;
+
+            stream.insert(stream.end(), {
+                (uint8_t) is_last,
+                (uint8_t) block, (uint8_t) (block >> 8),
+                (uint8_t) ~block, (uint8_t) (~block >> 8)
+            });
+
+            // Rows don't line up with blocks, copy byte ranges of both
+            for (size_t left = block; left > 0; ) {
+                const size_t count = std::min(left, row_size - row_offset);
+                const size_t start = stream.size();
+
+                if (row_offset == 0) {
+                    stream.push_back(0); // Filter type
+                    stream.insert(stream.end(), image.get_pixel(0, y), image.get_pixel(0, y) + count - 1);
+                } else {
+                    const uint8_t* row = image.get_pixel(0, y) + row_offset - 1;
+                    stream.insert(stream.end(), row, row + count);
+                }
+
+                update_adler(adler_a, adler_b, stream.data() + start, stream.size() - start);
+
+                left -= count, row_offset += count;
+                if (row_offset == row_size)
+                    row_offset = 0, ++ y;
+            }
+
+            written += block;
+        }
+
+        append_u32(stream, adler_b << 16 | adler_a);
+
+        write_chunk(file, "IDAT", stream);
+        write_chunk(file, "IEND", {});
+
+        close_file(file, path);
+    }
+
+}
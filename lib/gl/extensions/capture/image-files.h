@@ -0,0 +1,16 @@
+#pragma once
+
+#include "rgba-image.h"
+
+#include <string>
+
+namespace gl::image_files {
+
+    // Binary PPM (P6), alpha is dropped. Fastest to write, largest on disk.
+    void write_ppm(const std::string& path, const rgba_image& image);
+
+    // 8-bit RGBA PNG, stored without compression (deflate's "stored" blocks),
+    // so it's cheap to write and readable everywhere, but as big as PPM
+    void write_png(const std::string& path, const rgba_image& image);
+
+}
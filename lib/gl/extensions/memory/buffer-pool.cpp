@@ -0,0 +1,261 @@
+#include "buffer-pool.h"
+#include "opengl-wrapper.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    buffer_pool::buffer_pool(vertex_layout layout, size_t block_capacity)
+        : m_layout(std::move(layout)), m_vertex_size(m_layout.get_stride()),
+          m_block_capacity(block_capacity) {
+
+        if (m_vertex_size == 0 || m_block_capacity == 0)
+            throw std::invalid_argument("Buffer pool needs a layout and non-empty blocks!");
+    }
+
+    // ==> Allocation:
+
+    buffer_pool::handle buffer_pool::allocate(size_t count) {
+        if (count == 0)
+            throw std::invalid_argument("Buffer pool can't allocate an empty range!");
+
+        range where { 0, 0, count };
+
+        bool is_found = false;
+        for (size_t i = 0; i < m_blocks.size() && !is_found; ++ i) {
+            if (const std::optional<size_t> first = m_blocks[i].space.allocate(count)) {
+                where.block = i, where.first = *first;
+                is_found = true;
+            }
+        }
+
+        if (!is_found) {
+            where.block = add_block(std::max(count, m_block_capacity));
+            where.first = *m_blocks[where.block].space.allocate(count);
+        }
+
+        ++ m_blocks[where.block].live_count;
+
+        if (!m_free_slots.empty()) {
+            const handle id = m_free_slots.back();
+            m_free_slots.pop_back();
+
+            m_slots[id] = { where, true };
+            return id;
+        }
+
+        if (m_slots.size() > std::numeric_limits<handle>::max())
+            throw std::length_error("Buffer pool is out of handles!");
+
+        m_slots.push_back({ where, true });
+        return (handle) (m_slots.size() - 1);
+    }
+
+    void buffer_pool::update(handle id, raw_data data, size_t offset) {
+        const range& where = get_slot(id).where;
+
+        const size_t size = where.count * m_vertex_size;
+        if (offset > size || data.size > size - offset)
+            throw std::out_of_range("Buffer pool update is out of allocation's bounds!");
+
+        m_blocks[where.block].vertices.update(where.first * m_vertex_size + offset, data);
+    }
+
+    void buffer_pool::free(handle id) {
+        const range where = get_slot(id).where;
+
+        block& owner = m_blocks[where.block];
+        owner.space.free(where.first, where.count);
+        -- owner.live_count;
+
+        m_slots[id].is_alive = false;
+        m_free_slots.push_back(id);
+    }
+
+    const buffer_pool::range& buffer_pool::get_range(handle id) const {
+        return get_slot(id).where;
+    }
+
+    const buffer_pool::slot& buffer_pool::get_slot(handle id) const {
+        if (id >= m_slots.size() || !m_slots[id].is_alive)
+            throw std::out_of_range("Buffer pool has no such allocation!");
+
+        return m_slots[id];
+    }
+
+    size_t buffer_pool::add_block(size_t capacity) {
+        // Firsts and counts of glMultiDrawArrays are ints
+        if (capacity > (size_t) std::numeric_limits<int>::max())
+            throw std::length_error("Buffer pool block is too big to be drawn!");
+
+        block& added = m_blocks.emplace_back(block { vertex_array(m_layout), range_allocator(capacity) });
+        added.vertices.reserve(capacity * m_vertex_size);
+
+        return m_blocks.size() - 1;
+    }
+
+    // ==> Drawing:
+
+    void buffer_pool::draw(drawing_type type, const shaders::shader_program& shader,
+                           std::span<const handle> ids) {
+
+        for (handle id: ids) {
+            const range& where = get_slot(id).where;
+
+            block& owner = m_blocks[where.block];
+            owner.firsts.push_back((int) where.first);
+            owner.counts.push_back((int) where.count);
+        }
+
+        draw_collected(type, shader);
+    }
+
+    void buffer_pool::draw(drawing_type type, const shaders::shader_program& shader) {
+        for (const slot& current: m_slots) {
+            if (!current.is_alive)
+                continue;
+
+            block& owner = m_blocks[current.where.block];
+            owner.firsts.push_back((int) current.where.first);
+            owner.counts.push_back((int) current.where.count);
+        }
+
+        draw_collected(type, shader);
+    }
+
+    void buffer_pool::draw_collected(drawing_type type, const shaders::shader_program& shader) {
+        for (block& current: m_blocks) {
+            if (current.firsts.empty())
+                continue;
+
+            gl::draw(type, current.vertices, shader, current.firsts, current.counts);
+
+            current.firsts.clear();
+            current.counts.clear();
+        }
+    }
+
+    // ==> Maintenance:
+
+    size_t buffer_pool::defragment() {
+        size_t moved = 0;
+
+        // Single free range is as good as it gets, there's nothing to merge
+        for (size_t i = 0; i < m_blocks.size(); ++ i)
+            if (m_blocks[i].live_count != 0 && m_blocks[i].space.get_free_range_count() > 1)
+                moved += compact(i);
+
+        // ==> Drop empty blocks, blocks after them shift down:
+
+        std::vector<size_t> new_index(m_blocks.size());
+
+        size_t kept = 0;
+        for (size_t i = 0; i < m_blocks.size(); ++ i) {
+            new_index[i] = kept;
+
+            if (m_blocks[i].live_count != 0) {
+                if (kept != i)
+                    m_blocks[kept] = std::move(m_blocks[i]);
+
+                ++ kept;
+            }
+        }
+
+        if (kept != m_blocks.size()) {
+            m_blocks.erase(m_blocks.begin() + (std::ptrdiff_t) kept, m_blocks.end());
+
+            for (slot& current: m_slots)
+                if (current.is_alive)
+                    current.where.block = new_index[current.where.block];
+        }
+
+        return moved;
+    }
+
+    size_t buffer_pool::compact(size_t block_index) {
+        block& target = m_blocks[block_index];
+
+        m_ordered.clear();
+        for (handle id = 0; id < m_slots.size(); ++ id)
+            if (m_slots[id].is_alive && m_slots[id].where.block == block_index)
+                m_ordered.push_back(id);
+
+        std::ranges::sort(m_ordered, {}, [this](handle id) { return m_slots[id].where.first; });
+
+        // Copying within one buffer is undefined for overlapping ranges, and
+        // frames in flight may still read it, so vertices go to a new one
+        vertex_buffer packed({ nullptr, target.space.get_capacity() * m_vertex_size });
+
+        gl::raw::bind_buffer(GL_COPY_READ_BUFFER, target.vertices.get_buffer().get_id());
+        gl::raw::bind_buffer(GL_COPY_WRITE_BUFFER, packed.get_id());
+
+        // Neighbouring allocations are copied together, as one run
+        size_t run_source = 0, run_target = 0, run_count = 0;
+        const auto copy_run = [&]() {
+            if (run_count != 0)
+                gl::raw::copy_buffer_sub_data(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                              (GLintptr) (run_source * m_vertex_size),
+                                              (GLintptr) (run_target * m_vertex_size),
+                                              (GLsizeiptr) (run_count * m_vertex_size));
+        };
+
+        size_t used = 0, moved = 0;
+        for (handle id: m_ordered) {
+            range& where = m_slots[id].where;
+
+            if (run_count != 0 && where.first == run_source + run_count)
+                run_count += where.count;
+            else {
+                copy_run();
+                run_source = where.first, run_target = used, run_count = where.count;
+            }
+
+            if (where.first != used)
+                moved += where.count;
+
+            where.first = used;
+            used += where.count;
+        }
+
+        copy_run();
+
+        // Old buffer is released along with frames that still use it
+        target.vertices.assign(std::move(packed), used);
+        target.space.reset(used);
+
+        return moved;
+    }
+
+    size_t buffer_pool::get_block_count() const { return m_blocks.size(); }
+    size_t buffer_pool::get_live_count() const { return m_slots.size() - m_free_slots.size(); }
+
+    size_t buffer_pool::get_used_vertices() const {
+        size_t used = 0;
+        for (const block& current: m_blocks)
+            used += current.space.get_capacity() - current.space.get_free();
+
+        return used;
+    }
+
+    size_t buffer_pool::get_free_vertices() const {
+        size_t free = 0;
+        for (const block& current: m_blocks)
+            free += current.space.get_free();
+
+        return free;
+    }
+
+    double buffer_pool::get_fragmentation() const {
+        size_t free = 0, largest = 0;
+        for (const block& current: m_blocks) {
+            free += current.space.get_free();
+            largest += current.space.get_largest_free();
+        }
+
+        return free == 0 ? 0.0 : 1.0 - (double) largest / (double) free;
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "opengl-setup.h"
+#include "range-allocator.h"
+#include "vertex-array.h"
+#include "vertex-buffer.h"
+#include "vertex-layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    // Vertices of many small objects (e.g. retained shapes) in a few big
+    // buffers. Each object gets a range of a block (one vertex_array with
+    // its buffer) instead of a buffer of its own, so drawing any number of
+    // objects binds each block once and draws its ranges with a single
+    // glMultiDrawArrays: cost of a draw scales with blocks, not objects.
+    //
+    // Objects are referred to by handles, which stay valid when their
+    // vertices are moved by defragment. Must be created and used on GL thread.
+    class buffer_pool {
+    public:
+        using handle = uint32_t;
+
+        struct range final {
+            size_t block;
+            size_t first, count; // In vertices
+        };
+
+        // Blocks fit /block_capacity/ vertices of /layout/ (bigger objects
+        // get a block of their own size)
+        explicit buffer_pool(vertex_layout layout, size_t block_capacity = 1 << 16);
+
+        // This class shouldn't be copied or moved
+        buffer_pool(const buffer_pool&) = delete;
+        buffer_pool& operator=(const buffer_pool&) = delete;
+
+        // ==> Allocation:
+
+        // Vertices are left uninitialized, see update
+        handle allocate(size_t count);
+
+        // Allocates and uploads /vertices/ at once
+        template <typename vertex_type>
+        handle add(std::span<const vertex_type> vertices) {
+            const handle id = allocate(vertices.size());
+            update(id, { vertices.data(), vertices.size_bytes() });
+
+            return id;
+        }
+
+        // Overwrites part of allocation, /offset/ is in bytes from its start
+        void update(handle id, raw_data data, size_t offset = 0);
+
+        void free(handle id);
+
+        const range& get_range(handle id) const;
+
+        // ==> Drawing:
+
+        // Draws given allocations, grouped by block (in order of blocks, so
+        // objects that should be drawn in order must not rely on it)
+        void draw(drawing_type type, const shaders::shader_program& shader,
+                  std::span<const handle> ids);
+
+        // Draws every allocation that's alive
+        void draw(drawing_type type, const shaders::shader_program& shader);
+
+        // ==> Maintenance:
+
+        // Packs allocations of fragmented blocks at blocks' starts and
+        // drops blocks that are empty. Vertices are copied on GPU into a
+        // new buffer, old one is deleted when frames using it are done.
+        // Returns number of vertices that were moved.
+        size_t defragment();
+
+        size_t get_block_count() const;
+        size_t get_live_count() const;
+
+        size_t get_used_vertices() const;
+        size_t get_free_vertices() const;
+
+        // Part of free space (0 to 1) that is outside of the largest free
+        // range of its block, hints at when to defragment
+        double get_fragmentation() const;
+
+    private:
+        struct block final {
+            vertex_array vertices;
+            range_allocator space;
+
+            size_t live_count = 0;
+
+            // Ranges collected for the next draw, reused between draws
+            std::vector<int> firsts {}, counts {};
+        };
+
+        struct slot final {
+            range where;
+            bool is_alive;
+        };
+
+        vertex_layout m_layout;
+        size_t m_vertex_size, m_block_capacity;
+
+        std::vector<block> m_blocks;
+
+        std::vector<slot> m_slots;
+        std::vector<handle> m_free_slots;
+
+        // Handles of one block ordered by first vertex, used by defragment
+        std::vector<handle> m_ordered;
+
+        const slot& get_slot(handle id) const;
+        size_t add_block(size_t capacity);
+
+        void draw_collected(drawing_type type, const shaders::shader_program& shader);
+        size_t compact(size_t block_index);
+    };
+
+}
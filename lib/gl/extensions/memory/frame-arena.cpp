@@ -0,0 +1,119 @@
+#include "frame-arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace gl {
+
+    frame_arena::frame_arena(size_t block_size, bool use_huge_pages, size_t shrink_window)
+        : m_block_size(std::max<size_t>(block_size, 64)), m_use_huge_pages(use_huge_pages),
+          m_high_water(shrink_window) {}
+
+    // ------------------------------------ BLOCKS -----------------------------------
+
+    void frame_arena::add_block(size_t size) {
+        block new_block { nullptr, size };
+
+        if (m_use_huge_pages) {
+            new_block.size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+
+            void* mapping = mmap(nullptr, new_block.size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+            // Just a hint, regular pages are fine too
+            madvise(mapping, new_block.size, MADV_HUGEPAGE);
+#endif
+
+            new_block.data = static_cast<std::byte*>(mapping);
+        } else
+            new_block.data = static_cast<std::byte*>(::operator new(size, std::align_val_t(64)));
+
+        m_blocks.push_back(new_block);
+        m_reserved += new_block.size;
+
+        ++ m_block_allocations;
+    }
+
+    void frame_arena::release_blocks() {
+        for (const block& current: m_blocks) {
+            if (m_use_huge_pages)
+                munmap(current.data, current.size);
+            else
+                ::operator delete(current.data, std::align_val_t(64));
+        }
+
+        m_blocks.clear();
+        m_reserved = 0;
+    }
+
+    // ---------------------------------- ALLOCATION ---------------------------------
+
+    void* frame_arena::do_allocate(size_t bytes, size_t alignment) {
+        while (true) {
+            if (m_current == m_blocks.size())
+                add_block(std::max(m_block_size, bytes + alignment));
+
+            const block& current = m_blocks[m_current];
+
+            const uintptr_t address = reinterpret_cast<uintptr_t>(current.data) + m_offset;
+            const size_t padding = (alignment - address % alignment) % alignment;
+
+            if (padding + bytes <= current.size - m_offset) {
+                std::byte* result = current.data + m_offset + padding;
+
+                m_offset += padding + bytes;
+                m_used += padding + bytes;
+
+                return result;
+            }
+
+            // Rest of the block is wasted until reset
+            ++ m_current, m_offset = 0;
+        }
+    }
+
+    void frame_arena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+        (void) pointer, (void) bytes, (void) alignment; // Freed by reset
+    }
+
+    bool frame_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    // ------------------------------------ RESET ------------------------------------
+
+    void frame_arena::reset() {
+        m_high_water.push(m_used);
+
+        // Room for the largest recent frame (and some growth), in whole blocks
+        const size_t peak = m_high_water.get();
+        const size_t target = (peak + peak / 8 + m_block_size - 1) / m_block_size * m_block_size;
+
+        const bool has_spilled = m_current > 0;
+        const bool is_oversized = m_reserved > 2 * std::max(target, m_block_size);
+
+        if (has_spilled || is_oversized) {
+            release_blocks();
+
+            if (target != 0)
+                add_block(target);
+        }
+
+        m_current = 0, m_offset = 0;
+        m_used = 0;
+    }
+
+    size_t frame_arena::get_used()     const { return m_used; }
+    size_t frame_arena::get_reserved() const { return m_reserved; }
+
+    size_t frame_arena::get_block_allocations() const { return m_block_allocations; }
+
+    frame_arena::~frame_arena() { release_blocks(); }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "high-water-mark.h"
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace gl {
+
+    // Memory for data that lives a single frame (e.g. through std::pmr
+    // containers): allocation just bumps a pointer, deallocation does nothing,
+    // and everything is freed at once by reset, which keeps the memory for the
+    // next frame. Once a frame fits, frames don't touch the heap at all.
+    //
+    // Frame that didn't fit into one block makes reset replace all blocks with
+    // a single one that fits the largest frame of the last /shrink_window/
+    // frames, the same happens when that's less than half of what's kept, so
+    // memory is given back some time after a spike. Not thread safe.
+    class frame_arena final: public std::pmr::memory_resource {
+    public:
+        static constexpr size_t default_block_size = 1 << 20;
+        static constexpr size_t huge_page_size = 2 << 20;
+
+        // Huge pages (if system has them) make TLB misses rarer for big frames,
+        // with them blocks are rounded up to huge_page_size
+        explicit frame_arena(size_t block_size = default_block_size,
+                             bool use_huge_pages = false, size_t shrink_window = 120);
+
+        // This class shouldn't be copied or moved
+        frame_arena(const frame_arena&) = delete;
+        frame_arena& operator=(const frame_arena&) = delete;
+
+        // Invalidates everything allocated since the previous reset
+        void reset();
+
+        size_t get_used()     const; // Bytes allocated since the last reset
+        size_t get_reserved() const; // Bytes of all blocks
+
+        // Blocks requested from the system so far, stops growing once frames fit
+        size_t get_block_allocations() const;
+
+        ~frame_arena() override;
+
+    private:
+        struct block final {
+            std::byte* data;
+            size_t size;
+        };
+
+        const size_t m_block_size;
+        const bool m_use_huge_pages;
+
+        std::vector<block> m_blocks;
+        size_t m_current = 0, m_offset = 0; // Where next allocation goes
+
+        size_t m_used = 0, m_reserved = 0;
+        size_t m_block_allocations = 0;
+
+        high_water_mark m_high_water; // Of bytes used per frame
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void add_block(size_t size);
+        void release_blocks();
+    };
+
+}
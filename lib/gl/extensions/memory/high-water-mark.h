@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace gl {
+
+    // Largest value of the last /window/ frames, so that memory kept for a
+    // spike can be given back once the spike is that many frames old
+    class high_water_mark final {
+    public:
+        explicit high_water_mark(size_t window = 120)
+            : m_values(std::max<size_t>(window, 1), 0) {}
+
+        void push(size_t value) {
+            const size_t evicted = m_values[m_next];
+
+            m_values[m_next] = value;
+            m_next = (m_next + 1) % m_values.size();
+
+            // Only a full rescan can find the next largest one
+            if (value >= m_max)
+                m_max = value;
+            else if (evicted == m_max)
+                m_max = *std::max_element(m_values.begin(), m_values.end());
+        }
+
+        size_t get() const { return m_max; }
+        size_t get_window() const { return m_values.size(); }
+
+    private:
+        std::vector<size_t> m_values; // Ring of the last frames
+        size_t m_next = 0, m_max = 0;
+    };
+
+}
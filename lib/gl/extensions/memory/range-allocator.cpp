@@ -0,0 +1,97 @@
+#include "range-allocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace gl {
+
+    range_allocator::range_allocator(size_t capacity): m_capacity(capacity) {
+        reset();
+    }
+
+    std::optional<size_t> range_allocator::allocate(size_t count) {
+        if (count == 0)
+            throw std::invalid_argument("Can't allocate an empty range!");
+
+        const auto fit = m_by_size.lower_bound({ count, 0 });
+        if (fit == m_by_size.end())
+            return std::nullopt;
+
+        const auto [fit_count, offset] = *fit;
+        erase(m_by_offset.find(offset));
+
+        // Remainder stays where it was, so allocations pack from the start
+        if (fit_count > count)
+            insert(offset + count, fit_count - count);
+
+        return offset;
+    }
+
+    void range_allocator::free(size_t offset, size_t count) {
+        if (count == 0)
+            return;
+
+        if (offset > m_capacity || count > m_capacity - offset)
+            throw std::out_of_range("Freed range is out of allocator's space!");
+
+        auto next = m_by_offset.lower_bound(offset);
+        if (next != m_by_offset.end() && next->first < offset + count)
+            throw std::invalid_argument("Freed range overlaps a free one!");
+
+        // ==> Merge with free neighbours on both sides:
+
+        if (next != m_by_offset.begin()) {
+            const auto previous = std::prev(next);
+            if (previous->first + previous->second > offset)
+                throw std::invalid_argument("Freed range overlaps a free one!");
+
+            if (previous->first + previous->second == offset) {
+                offset = previous->first, count += previous->second;
+                erase(previous);
+            }
+        }
+
+        if (next != m_by_offset.end() && next->first == offset + count) {
+            count += next->second;
+            erase(next);
+        }
+
+        insert(offset, count);
+    }
+
+    void range_allocator::reset(size_t used) {
+        if (used > m_capacity)
+            throw std::out_of_range("Allocator can't use more than its capacity!");
+
+        m_by_offset.clear();
+        m_by_size.clear();
+        m_free = 0;
+
+        if (used < m_capacity)
+            insert(used, m_capacity - used);
+    }
+
+    size_t range_allocator::get_capacity() const { return m_capacity; }
+    size_t range_allocator::get_free() const { return m_free; }
+
+    size_t range_allocator::get_largest_free() const {
+        return m_by_size.empty() ? 0 : m_by_size.rbegin()->first;
+    }
+
+    size_t range_allocator::get_free_range_count() const { return m_by_offset.size(); }
+
+    void range_allocator::insert(size_t offset, size_t count) {
+        m_by_offset.emplace(offset, count);
+        m_by_size.emplace(count, offset);
+
+        m_free += count;
+    }
+
+    void range_allocator::erase(std::map<size_t, size_t>::iterator range) {
+        m_by_size.erase({ range->second, range->first });
+        m_free -= range->second;
+
+        m_by_offset.erase(range);
+    }
+
+}
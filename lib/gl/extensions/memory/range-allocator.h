@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+
+namespace gl {
+
+    // Hands out ranges [offset, offset + count) of a space of fixed size
+    // (e.g. vertices of one GPU buffer). Free ranges are kept coalesced,
+    // both by offset (to merge neighbours on free) and by size (to find the
+    // best fit, smallest free range that's big enough, in logarithmic time).
+    class range_allocator final {
+    public:
+        explicit range_allocator(size_t capacity);
+
+        // Nothing when there's no free range of /count/ (that isn't 0)
+        std::optional<size_t> allocate(size_t count);
+
+        // Range should be one that was allocated, or a part of it
+        void free(size_t offset, size_t count);
+
+        // Everything but [0, used) becomes free (e.g. after compaction)
+        void reset(size_t used = 0);
+
+        size_t get_capacity() const;
+        size_t get_free() const;
+
+        size_t get_largest_free() const;
+        size_t get_free_range_count() const;
+
+    private:
+        size_t m_capacity, m_free = 0;
+
+        std::map<size_t, size_t> m_by_offset;          // Offset -> count
+        std::set<std::pair<size_t, size_t>> m_by_size; // (count, offset)
+
+        void insert(size_t offset, size_t count);
+        void erase(std::map<size_t, size_t>::iterator range);
+    };
+
+}
@@ -0,0 +1,100 @@
+#include "overdraw-view.h"
+#include "opengl-wrapper.h"
+#include "vec-layout.h"
+
+#include <algorithm>
+
+namespace gl {
+
+    overdraw_view::overdraw_view()
+        : m_counting_shader("res/overdraw-count.glsl"),
+          m_heatmap_shader("res/overdraw-heatmap.glsl"),
+          m_fullscreen_triangle(math::vector_layout<float, 2>(),
+                                std::vector<float> { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }) {
+
+        m_heatmap_shader.uniform("counts", 0);
+    }
+
+    void overdraw_view::set_max_overdraw(float max_overdraw) {
+        m_max_overdraw = max_overdraw;
+    }
+
+    // ------------------------------------ COUNTING ---------------------------------
+
+    void overdraw_view::begin(size_t width, size_t height) {
+        m_target.resize(width, height, texture::format::RED_FLOAT);
+        m_target.bind();
+
+        // Clear values of the window aren't touched
+        const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, farthest = 1.0f;
+
+        gl::raw::clear_bufferfv(GL_COLOR, 0, zero);
+        gl::raw::clear_bufferfv(GL_DEPTH, 0, &farthest);
+
+        // For renderers that don't set blending themselves
+        gl::raw::enable(GL_BLEND);
+        gl::raw::blend_func(GL_ONE, GL_ONE);
+    }
+
+    void overdraw_view::end(std::vector<size_t> triangles_per_layer) {
+        const size_t width = m_target.get_width(), height = m_target.get_height();
+
+        // ==> Sum counts (target is still bound for reading):
+
+        m_counts.resize(width * height);
+
+        gl::raw::pixel_storei(GL_PACK_ALIGNMENT, 1);
+        gl::raw::read_pixels(0, 0, (GLsizei) width, (GLsizei) height,
+                             GL_RED, GL_FLOAT, m_counts.data());
+
+        m_report = {};
+        m_report.total_pixels = m_counts.size();
+        m_report.triangles_per_layer = std::move(triangles_per_layer);
+
+        double fragments = 0.0; // Counts are small whole numbers, but there are many
+        for (float count: m_counts) {
+            fragments += count;
+
+            if (count > 0.0f)
+                ++ m_report.covered_pixels;
+
+            m_report.max = std::max(m_report.max, count);
+        }
+
+        m_report.fragments = (size_t) fragments;
+        if (m_report.covered_pixels != 0)
+            m_report.average = (float) (fragments / (double) m_report.covered_pixels);
+
+        // ==> Show heatmap instead of the frame:
+
+        framebuffer::bind_default();
+        gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        m_target.get_color().bind(0);
+        m_heatmap_shader.uniform("max_overdraw", m_max_overdraw);
+
+        gl::draw(drawing_type::TRIANGLES, m_fullscreen_triangle, m_heatmap_shader, 0, 3);
+    }
+
+    const shaders::shader_program& overdraw_view::get_counting_shader() const {
+        return m_counting_shader;
+    }
+
+    const overdraw_report& overdraw_view::get_report() const { return m_report; }
+
+    // ------------------------------------ REPORT -----------------------------------
+
+    std::ostream& operator<<(std::ostream& out, const overdraw_report& report) {
+        out << "overdraw: " << report.fragments << " fragments, "
+            << report.covered_pixels << "/" << report.total_pixels << " pixels covered, "
+            << "average " << report.average << ", max " << report.max;
+
+        for (size_t layer = 0; layer < report.triangles_per_layer.size(); ++ layer)
+            if (report.triangles_per_layer[layer] != 0)
+                out << "\n    layer " << layer << ": "
+                    << report.triangles_per_layer[layer] << " triangles";
+
+        return out;
+    }
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "framebuffer.h"
+#include "opengl-setup.h"
+#include "vertex-array.h"
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace gl {
+
+    struct overdraw_report final {
+        size_t fragments = 0;      // Fragments shaded in the whole frame
+        size_t covered_pixels = 0; // Pixels shaded at least once
+        size_t total_pixels = 0;
+
+        float average = 0.0f; // Fragments per covered pixel
+        float max = 0.0f;     // Fragments of the worst pixel
+
+        std::vector<size_t> triangles_per_layer;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const overdraw_report& report);
+
+    // Fill rate diagnostics: frame is drawn into a float target with a shader
+    // that adds one per fragment, so each pixel counts how many times it was
+    // shaded, then shown as a heatmap (black is never, red is /max_overdraw/
+    // or more). Reading counts back stalls the pipeline, it's for debugging.
+    class overdraw_view {
+    public:
+        // Should be created on GL thread
+        overdraw_view();
+
+        // This class shouldn't be copied or moved
+        overdraw_view(const overdraw_view&) = delete;
+        overdraw_view& operator=(const overdraw_view&) = delete;
+
+        void set_max_overdraw(float max_overdraw);
+
+        // Redirects drawing to counting target of framebuffer's size (in pixels),
+        // renderer should then draw everything with get_counting_shader
+        void begin(size_t width, size_t height);
+
+        // Goes back to the window, sums the counts and draws the heatmap
+        void end(std::vector<size_t> triangles_per_layer);
+
+        const shaders::shader_program& get_counting_shader() const;
+        const overdraw_report& get_report() const;
+
+    private:
+        framebuffer m_target;
+
+        shaders::shader_program m_counting_shader;
+        shaders::shader_program m_heatmap_shader;
+
+        vertex_array m_fullscreen_triangle;
+
+        float m_max_overdraw = 8.0f;
+
+        std::vector<float> m_counts; // Read back from target
+        overdraw_report m_report;
+    };
+
+}
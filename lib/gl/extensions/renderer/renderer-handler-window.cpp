@@ -1,6 +1,9 @@
 #include "renderer-handler-window.h"
 #include "renderer.h"
 
+#include <stdexcept>
+#include <utility>
+
 namespace gl {
 
     void renderer_handler_window::setup_current_renderer() {
@@ -9,7 +12,9 @@ namespace gl {
 
         current_renderer->setup_ensure_once(this->get_glfw_window(),
                                             (size_t) this->width,
-                                            (size_t) this->height);
+                                            (size_t) this->height,
+                                            (size_t) this->framebuffer_width,
+                                            (size_t) this->framebuffer_height);
     }
 
     void renderer_handler_window::setup() {
@@ -18,10 +23,87 @@ namespace gl {
     }
 
     void renderer_handler_window::draw()  {
-        if (current_renderer != nullptr)
+        if (is_overdraw_enabled && current_renderer != nullptr)
+            draw_overdraw();
+        else if (current_renderer != nullptr)
             current_renderer->draw();
 
         window_draw();
+
+        if (capture != nullptr)
+            capture->capture((size_t) framebuffer_width, (size_t) framebuffer_height);
+    }
+
+    void renderer_handler_window::teardown() {
+        window_teardown();
+
+        if (current_renderer != nullptr)
+            current_renderer->teardown();
+
+        if (capture != nullptr)
+            capture->flush();
+    }
+
+    void renderer_handler_window::set_frame_capture(frame_capture* new_capture) {
+        capture = new_capture;
+    }
+
+    void renderer_handler_window::on_resized(int new_width, int new_height) {
+        (void) new_width, (void) new_height; // Already stored in window
+
+        // Renderer is set up only once, this just updates its dimensions
+        setup_current_renderer();
+    }
+
+    // ---------------------------------- OVERDRAW ---------------------------------
+
+    void renderer_handler_window::on_events(std::span<const window_event> batch) {
+        for (const window_event& event: batch)
+            if (event.type == window_event::event_type::KEY_PRESSED &&
+                event.pressed_key == overdraw_key && !event.is_repeat)
+                set_overdraw_enabled(!is_overdraw_enabled);
+
+        gl::window::on_events(batch);
+    }
+
+    void renderer_handler_window::set_overdraw_key(key new_key) { overdraw_key = new_key; }
+
+    void renderer_handler_window::set_overdraw_enabled(bool enabled) {
+        is_overdraw_enabled = enabled;
+        last_report_time = 0.0; // Report the first frame right away
+    }
+
+    bool renderer_handler_window::is_overdraw_mode() const { return is_overdraw_enabled; }
+
+    const overdraw_report& renderer_handler_window::get_overdraw_report() const {
+        if (overdraw == nullptr)
+            throw std::runtime_error("Overdraw mode wasn't used yet!");
+
+        return overdraw->get_report();
+    }
+
+    void renderer_handler_window::set_overdraw_callback(overdraw_function on_report) {
+        on_overdraw_report = std::move(on_report);
+    }
+
+    void renderer_handler_window::draw_overdraw() {
+        if (overdraw == nullptr)
+            overdraw = std::make_unique<overdraw_view>();
+
+        // Window size is in screen coordinates, target needs pixels
+        overdraw->begin((size_t) framebuffer_width, (size_t) framebuffer_height);
+
+        current_renderer->set_override_shader(&overdraw->get_counting_shader());
+        current_renderer->draw();
+        current_renderer->set_override_shader(nullptr);
+
+        overdraw->end(current_renderer->get_triangles_per_layer());
+
+        const double now = glfwGetTime();
+        if (on_overdraw_report && now - last_report_time >= 1.0) {
+            on_overdraw_report(overdraw->get_report());
+            last_report_time = now;
+        }
     }
 
     void renderer_handler_window::set_renderer(renderer* new_renderer) {
@@ -1,24 +1,75 @@
 #pragma once
 
+#include "frame-capture.h"
 #include "opengl-setup.h"
+#include "overdraw-view.h"
 #include "renderer.h"
 
+#include <functional>
+#include <memory>
+#include <span>
+
 namespace gl {
 
     class renderer_handler_window: public gl::window {
+    public:
+        using overdraw_function = std::function<void(const overdraw_report& report)>;
+
     private:
         renderer* current_renderer = nullptr;
         void setup_current_renderer();
 
+        // ==> Overdraw diagnostics:
+
+        key overdraw_key = key::F2;
+        bool is_overdraw_enabled = false;
+
+        std::unique_ptr<overdraw_view> overdraw; // Created on first use
+
+        overdraw_function on_overdraw_report;
+        double last_report_time = 0.0;
+
+        void draw_overdraw();
+
+        frame_capture* capture = nullptr;
+
     public:
         using gl::window::window;
 
-        void setup() override;
-        void draw()  override;
+        void setup()    override;
+        void draw()     override;
+        void teardown() override;
+
+        void on_resized(int new_width, int new_height) override;
+
+        // Handles overdraw key, then calls the usual handlers
+        void on_events(std::span<const window_event> batch) override;
+
+        // ==> Overdraw mode: shows how many times each pixel is shaded as
+        // a heatmap and reports frame totals (about once a second)
+
+        void set_overdraw_key(key new_key);
+        void set_overdraw_enabled(bool enabled);
+
+        bool is_overdraw_mode() const;
+
+        // Totals of the last frame drawn in overdraw mode
+        const overdraw_report& get_overdraw_report() const;
+
+        // Called from draw with totals about once a second in overdraw
+        // mode (e.g. to log them or put them in title), can be empty
+        void set_overdraw_callback(overdraw_function on_report);
+
+        // ==> Frame export: every drawn frame (including window_draw's part)
+        // is read back through /new_capture/ (can be null), which is flushed
+        // at teardown, while GL context is still alive
+
+        void set_frame_capture(frame_capture* new_capture);
 
         // Additional option for window to add something
-        virtual void window_setup() {}
-        virtual void window_draw()  {}
+        virtual void window_setup()    {}
+        virtual void window_draw()     {}
+        virtual void window_teardown() {}
 
         void set_renderer(renderer* new_renderer);
 
@@ -4,10 +4,14 @@ namespace gl {
 
     renderer::renderer(): is_set_up(false) {}
 
-    void renderer::setup_ensure_once(GLFWwindow* current_window, const size_t new_width, const size_t new_height) {
+    void renderer::setup_ensure_once(GLFWwindow* current_window, const size_t new_width, const size_t new_height,
+                                     const size_t new_framebuffer_width, const size_t new_framebuffer_height) {
         this->width  = new_width;  // Setup renderer's dimensions 
         this->height = new_height;
 
+        this->framebuffer_width  = new_framebuffer_width;
+        this->framebuffer_height = new_framebuffer_height;
+
         if (!is_set_up) {
             this->glfw_window = current_window;
 
@@ -21,4 +25,7 @@ namespace gl {
     size_t renderer::get_width()  const { return this->width;  }
     size_t renderer::get_height() const { return this->height; }
 
+    size_t renderer::get_framebuffer_width()  const { return this->framebuffer_width;  }
+    size_t renderer::get_framebuffer_height() const { return this->framebuffer_height; }
+
 };
@@ -3,6 +3,11 @@
 #include <GLFW/glfw3.h>
 #include <cstddef>
 #include <functional>
+#include <vector>
+
+namespace gl::shaders {
+    class shader_program;
+}
 
 namespace gl {
 
@@ -10,6 +15,7 @@ namespace gl {
     private:
         GLFWwindow* glfw_window;
         size_t width, height;
+        size_t framebuffer_width, framebuffer_height;
 
         bool is_set_up;
 
@@ -19,13 +25,34 @@ namespace gl {
         virtual void setup() {};
         virtual void draw() = 0;
 
+        // Called once drawing is over, while GL context is still alive
+        virtual void teardown() {};
+
         size_t get_width()  const;
         size_t get_height() const;
 
+        // Size in pixels, differs from the one above on high-DPI screens
+        size_t get_framebuffer_width()  const;
+        size_t get_framebuffer_height() const;
+
+        // ==> Diagnostics (see renderer_handler_window's overdraw mode):
+
+        // Everything should be drawn with /shader/ (it takes the same vertices
+        // as renderer's own shaders) and additive blending, null restores normal
+        // drawing. Renderers that can't do that draw as usual.
+        virtual void set_override_shader(const shaders::shader_program* shader) {
+            (void) shader; // Ignore parameter
+        }
+
+        // Triangles submitted in the last frame, indexed by layer
+        virtual std::vector<size_t> get_triangles_per_layer() const { return {}; }
+
         GLFWwindow* get_glfw_window() const;
         virtual void setup_ensure_once(GLFWwindow* current_window,
                                        size_t new_width,
-                                       size_t new_height);
+                                       size_t new_height,
+                                       size_t new_framebuffer_width,
+                                       size_t new_framebuffer_height);
 
         virtual ~renderer() = default;
     };
@@ -0,0 +1,93 @@
+#include "command-recorder.h"
+
+#include <stdexcept>
+
+namespace gl {
+
+    command_recorder::command_recorder(const std::string& path)
+        : m_file(path, std::ios::binary), m_path(path) {
+
+        if (!m_file)
+            throw std::runtime_error("Failed to open recording \"" + path + "\"!");
+
+        const uint32_t sizes[2] = { sizeof(colored_vertex), sizeof(window_event) };
+
+        m_file.write(file_magic, sizeof(file_magic));
+        m_file.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    }
+
+    // ------------------------------------ FRAMES -----------------------------------
+
+    void command_recorder::add_events(std::span<const window_event> events) {
+        m_events.insert(m_events.end(), events.begin(), events.end());
+    }
+
+    void command_recorder::begin_frame(size_t viewport_width, size_t viewport_height, double time) {
+        if (m_is_recording)
+            throw std::runtime_error("Previous frame wasn't ended!");
+
+        m_header = {};
+        m_header.viewport_width  = (uint32_t) viewport_width;
+        m_header.viewport_height = (uint32_t) viewport_height;
+        m_header.time = time;
+
+        m_calls.clear();
+        m_call_count = 0;
+
+        m_is_recording = true;
+    }
+
+    void command_recorder::end_frame() {
+        if (!m_is_recording)
+            throw std::runtime_error("Frame wasn't begun!");
+
+        flush_allocation();
+        m_is_recording = false;
+
+        m_header.event_count = (uint32_t) m_events.size();
+        m_header.call_count  = (uint32_t) m_call_count;
+        m_header.calls_size  = m_calls.size();
+
+        m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+        m_file.write(reinterpret_cast<const char*>(m_events.data()),
+                     (std::streamsize) (m_events.size() * sizeof(window_event)));
+        m_file.write(reinterpret_cast<const char*>(m_calls.data()), (std::streamsize) m_calls.size());
+
+        // Frames are written whole, so recording can be stopped at any point
+        m_file.flush();
+        if (!m_file)
+            throw std::runtime_error("Failed to write recording \"" + m_path + "\"!");
+
+        m_events.clear();
+        ++ m_frame_count;
+    }
+
+    size_t command_recorder::get_frame_count() const { return m_frame_count; }
+
+    // ---------------------------------- ALLOCATION ---------------------------------
+
+    void command_recorder::record_allocation(const std::vector<colored_vertex>& vertices,
+                                             size_t first, size_t count) {
+        flush_allocation();
+
+        m_pending_vertices = &vertices;
+        m_pending_first = first, m_pending_count = count;
+    }
+
+    void command_recorder::flush_allocation() {
+        if (m_pending_vertices == nullptr)
+            return;
+
+        const std::vector<colored_vertex>& vertices = *m_pending_vertices;
+        m_pending_vertices = nullptr;
+
+        if (m_pending_first + m_pending_count > vertices.size())
+            throw std::runtime_error("Allocated vertices were removed before they were recorded!");
+
+        m_calls.push_back(static_cast<uint8_t>(recorded_call::ALLOCATE));
+        write(std::span<const colored_vertex>(vertices.data() + m_pending_first, m_pending_count));
+
+        ++ m_call_count;
+    }
+
+}
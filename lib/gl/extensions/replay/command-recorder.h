@@ -0,0 +1,145 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "opengl-setup.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace gl {
+
+    // Every drawing_manager call that can be recorded, values are stored in files
+    enum class recorded_call: uint8_t {
+        // ==> Settings:
+        SET_COLOR = 1, SET_ALPHA, SET_WIDTH, SET_AXES, SET_VIEWPORT_SIZE,
+        SET_ANTIALIASING, SET_CULLING,
+
+        // ==> Draw state:
+        SET_LAYER, SET_SHADER, SET_BLEND, SET_TEXTURE, RESERVE_DEPTH,
+
+        // ==> Shapes:
+        DRAW_INTERPOLATED_TRIANGLE, DRAW_TRIANGLE, DRAW_LINE, DRAW_ANTIALIASED_LINE,
+        DRAW_VECTOR, DRAW_CIRCLE, DRAW_RING, DRAW_ROUNDED_RECT,
+
+        // ==> Batches, plots and text:
+        DRAW_TRIANGLES, DRAW_LINES, DRAW_PLOT, DRAW_TEXT, DRAW_TICKS,
+
+        // ==> Raw vertices (see drawing_manager::allocate):
+        ALLOCATE
+    };
+
+    // Writes drawing_manager calls (see drawing_manager::set_recorder) and
+    // window events of every frame into a file, so the same frames can be
+    // replayed later without the application (see command_replay), e.g. to
+    // compare performance of two builds on exactly the same input.
+    //
+    // Layout (native byte order, replayed on the same kind of machine):
+    //     char     magic[8] = "VDCALL01"
+    //     uint32_t vertex_size, event_size (sizeof's, to catch layout changes)
+    //     frames, each:
+    //         frame_header
+    //         window_event events[event_count]
+    //         calls: uint8_t recorded_call followed by its arguments as they
+    //                are in memory, spans and strings are prefixed by uint32
+    //                element count (calls_size bytes in total)
+    //
+    // Calls are buffered per frame and written once frame ends.
+    class command_recorder final {
+    public:
+        struct frame_header final {
+            uint32_t viewport_width, viewport_height;
+            double time; // In glfwGetTime's seconds
+            uint32_t event_count, call_count;
+            uint64_t calls_size;
+        };
+
+        static constexpr char file_magic[8] = { 'V', 'D', 'C', 'A', 'L', 'L', '0', '1' };
+
+        explicit command_recorder(const std::string& path);
+
+        // This class shouldn't be copied or moved
+        command_recorder(const command_recorder&) = delete;
+        command_recorder& operator=(const command_recorder&) = delete;
+
+        // ==> Called by frame's owner (e.g. simple_drawing_renderer):
+
+        // Events are stored with the next frame that begins
+        void add_events(std::span<const window_event> events);
+
+        void begin_frame(size_t viewport_width, size_t viewport_height, double time);
+
+        // Writes the frame, vertices of allocate calls are read here at the
+        // latest, so their vector should still be alive (and not cleared)
+        void end_frame();
+
+        size_t get_frame_count() const;
+
+        // ==> Called by drawing_manager:
+
+        template <typename... argument_types>
+        void record(recorded_call call, const argument_types&... arguments) {
+            flush_allocation();
+
+            m_calls.push_back(static_cast<uint8_t>(call));
+            (write(arguments), ...);
+
+            ++ m_call_count;
+        }
+
+        // Allocated vertices are filled after allocate returns, so they're
+        // copied when the next call is recorded (or frame ends) instead
+        void record_allocation(const std::vector<colored_vertex>& vertices,
+                               size_t first, size_t count);
+
+    private:
+        std::ofstream m_file;
+        std::string m_path;
+
+        frame_header m_header {};
+        bool m_is_recording = false;
+
+        std::vector<window_event> m_events;
+
+        std::vector<uint8_t> m_calls;
+        size_t m_call_count = 0;
+
+        const std::vector<colored_vertex>* m_pending_vertices = nullptr;
+        size_t m_pending_first = 0, m_pending_count = 0;
+
+        size_t m_frame_count = 0;
+
+        void flush_allocation();
+
+        void write_bytes(const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            m_calls.insert(m_calls.end(), bytes, bytes + size);
+        }
+
+        template <typename value_type>
+        void write(const value_type& value) {
+            static_assert(std::is_trivially_copyable_v<value_type>,
+                          "Only trivially copyable arguments can be recorded!");
+
+            write_bytes(&value, sizeof(value));
+        }
+
+        template <typename value_type>
+        void write(std::span<const value_type> values) {
+            write((uint32_t) values.size());
+            write_bytes(values.data(), values.size_bytes());
+        }
+
+        void write(std::string_view text) {
+            write((uint32_t) text.size());
+            write_bytes(text.data(), text.size());
+        }
+    };
+
+}
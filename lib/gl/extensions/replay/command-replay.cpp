@@ -0,0 +1,252 @@
+#include "command-replay.h"
+#include "command-recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    // Reads arguments of calls one by one, checking that they're in range
+    class call_reader final {
+    public:
+        call_reader(const std::byte* data, size_t size)
+            : m_data(data), m_size(size) {}
+
+        bool is_done() const { return m_offset == m_size; }
+        size_t get_offset() const { return m_offset; }
+
+        void skip(size_t size) { take(size); }
+
+        template <typename value_type>
+        value_type read() {
+            std::array<std::byte, sizeof(value_type)> bytes;
+            std::memcpy(bytes.data(), take(sizeof(value_type)), sizeof(value_type));
+
+            return std::bit_cast<value_type>(bytes);
+        }
+
+        // Spans are copied into /target/, since recording isn't aligned
+        template <typename value_type>
+        void read_span(std::vector<value_type>& target) {
+            read_values(target, read<uint32_t>());
+        }
+
+        template <typename value_type>
+        void read_values(std::vector<value_type>& target, size_t count) {
+            if (count > (m_size - m_offset) / sizeof(value_type))
+                throw std::runtime_error("Recording is truncated!");
+
+            target.clear();
+            for (size_t i = 0; i < count; ++ i)
+                target.push_back(read<value_type>());
+        }
+
+        void read_text(std::string& target) {
+            const size_t count = read<uint32_t>();
+            const std::byte* data = take(count);
+
+            target.assign(reinterpret_cast<const char*>(data), count);
+        }
+
+    private:
+        const std::byte* m_data;
+        size_t m_size, m_offset = 0;
+
+        const std::byte* take(size_t size) {
+            if (size > m_size - m_offset)
+                throw std::runtime_error("Recording is truncated!");
+
+            const std::byte* data = m_data + m_offset;
+            m_offset += size;
+
+            return data;
+        }
+    };
+
+    command_replay::command_replay(const std::string& path): m_file(path) {
+        call_reader reader(m_file.data(), m_file.size());
+
+        const auto magic = reader.read<std::array<char, 8>>();
+        if (std::memcmp(magic.data(), command_recorder::file_magic, magic.size()) != 0)
+            throw std::runtime_error("Not a recording: \"" + path + "\"!");
+
+        const uint32_t vertex_size = reader.read<uint32_t>(), event_size = reader.read<uint32_t>();
+        if (vertex_size != sizeof(colored_vertex) || event_size != sizeof(window_event))
+            throw std::runtime_error("Recording \"" + path + "\" was made by an incompatible build!");
+
+        while (!reader.is_done()) {
+            const auto header = reader.read<command_recorder::frame_header>();
+
+            recorded_frame frame;
+            frame.viewport_width  = header.viewport_width;
+            frame.viewport_height = header.viewport_height;
+            frame.time = header.time;
+
+            reader.read_values(frame.events, header.event_count);
+
+            frame.call_count = header.call_count;
+            frame.calls_offset = reader.get_offset(), frame.calls_size = (size_t) header.calls_size;
+
+            reader.skip(frame.calls_size);
+            m_frames.push_back(std::move(frame));
+        }
+
+        // Frames are replayed in order, each is read once
+        m_file.advise(mapped_file::access_pattern::SEQUENTIAL);
+    }
+
+    size_t command_replay::get_frame_count() const { return m_frames.size(); }
+
+    const recorded_frame& command_replay::get_frame(size_t index) const {
+        if (index >= m_frames.size())
+            throw std::out_of_range("Recording has no such frame!");
+
+        return m_frames[index];
+    }
+
+    // ------------------------------------ REPLAY -----------------------------------
+
+    void command_replay::replay(size_t index, drawing_manager& mgr) {
+        using math::vec2;
+
+        const recorded_frame& frame = get_frame(index);
+        call_reader reader(m_file.data() + frame.calls_offset, frame.calls_size);
+
+        // Arguments are read into locals first, in the order they were written
+        while (!reader.is_done()) {
+            switch (reader.read<recorded_call>()) {
+            // ==> Settings:
+
+            case recorded_call::SET_COLOR: mgr.set_color(reader.read<math::vec3>()); break;
+            case recorded_call::SET_ALPHA: mgr.set_alpha(reader.read<float>()); break;
+            case recorded_call::SET_WIDTH: mgr.set_width(reader.read<float>()); break;
+            case recorded_call::SET_AXES:  mgr.set_axes(reader.read<axes>()); break;
+
+            case recorded_call::SET_VIEWPORT_SIZE: {
+                const size_t width = reader.read<size_t>(), height = reader.read<size_t>();
+                mgr.set_viewport_size(width, height);
+                break;
+            }
+
+            case recorded_call::SET_ANTIALIASING: mgr.set_antialiasing(reader.read<antialiasing_mode>()); break;
+            case recorded_call::SET_CULLING:      mgr.set_culling(reader.read<culling_mode>()); break;
+
+            // ==> Draw state:
+
+            case recorded_call::SET_LAYER:     mgr.set_layer(reader.read<uint8_t>()); break;
+            case recorded_call::SET_SHADER:    mgr.set_shader(reader.read<uint8_t>()); break;
+            case recorded_call::SET_BLEND:     mgr.set_blend(reader.read<blend_mode>()); break;
+            case recorded_call::SET_TEXTURE:   mgr.set_texture(reader.read<uint16_t>()); break;
+            case recorded_call::RESERVE_DEPTH: mgr.reserve_depth(reader.read<uint32_t>()); break;
+
+            // ==> Shapes:
+
+            case recorded_call::DRAW_INTERPOLATED_TRIANGLE: {
+                const colored_vertex p0 = reader.read<colored_vertex>();
+                const colored_vertex p1 = reader.read<colored_vertex>();
+                const colored_vertex p2 = reader.read<colored_vertex>();
+
+                mgr.draw_interpolated_triangle(p0, p1, p2);
+                break;
+            }
+
+            case recorded_call::DRAW_TRIANGLE: {
+                const vec2 p0 = reader.read<vec2>(), p1 = reader.read<vec2>(), p2 = reader.read<vec2>();
+                mgr.draw_triangle(p0, p1, p2);
+                break;
+            }
+
+            case recorded_call::DRAW_LINE: {
+                const vec2 from = reader.read<vec2>(), to = reader.read<vec2>();
+                mgr.draw_line(from, to);
+                break;
+            }
+
+            case recorded_call::DRAW_ANTIALIASED_LINE: {
+                const vec2 from = reader.read<vec2>(), to = reader.read<vec2>();
+                mgr.draw_antialiased_line(from, to, reader.read<float>());
+                break;
+            }
+
+            case recorded_call::DRAW_VECTOR: {
+                const vec2 from = reader.read<vec2>(), to = reader.read<vec2>();
+                mgr.draw_vector(from, to);
+                break;
+            }
+
+            case recorded_call::DRAW_CIRCLE: {
+                const vec2 center = reader.read<vec2>();
+                mgr.draw_circle(center, reader.read<float>());
+                break;
+            }
+
+            case recorded_call::DRAW_RING: {
+                const vec2 center = reader.read<vec2>();
+                const float radius = reader.read<float>(), thickness = reader.read<float>();
+
+                mgr.draw_ring(center, radius, thickness);
+                break;
+            }
+
+            case recorded_call::DRAW_ROUNDED_RECT: {
+                const vec2 x0 = reader.read<vec2>(), x1 = reader.read<vec2>();
+                mgr.draw_rounded_rect(x0, x1, reader.read<float>());
+                break;
+            }
+
+            // ==> Batches, plots and text:
+
+            case recorded_call::DRAW_TRIANGLES:
+                reader.read_span(m_from);
+                mgr.draw_triangles(m_from);
+                break;
+
+            case recorded_call::DRAW_LINES:
+                reader.read_span(m_from), reader.read_span(m_to);
+                mgr.draw_lines(m_from, m_to);
+                break;
+
+            case recorded_call::DRAW_PLOT:
+                reader.read_span(m_xs), reader.read_span(m_ys);
+                mgr.draw_plot(m_xs, m_ys);
+                break;
+
+            case recorded_call::DRAW_TEXT: {
+                const vec2 position = reader.read<vec2>();
+                reader.read_text(m_text);
+
+                const float size = reader.read<float>();
+                const vec2 anchor = reader.read<vec2>();
+
+                if (mgr.get_text_batch() != nullptr)
+                    mgr.draw_text(position, m_text, size, anchor);
+
+                break;
+            }
+
+            case recorded_call::DRAW_TICKS: {
+                const size_t target_count = reader.read<size_t>();
+                mgr.draw_ticks(target_count, reader.read<float>());
+                break;
+            }
+
+            // ==> Raw vertices:
+
+            case recorded_call::ALLOCATE: {
+                reader.read_span(m_vertices);
+                std::ranges::copy(m_vertices, mgr.allocate(m_vertices.size()).begin());
+                break;
+            }
+
+            default:
+                throw std::runtime_error("Recording has an unknown call!");
+            }
+        }
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "drawing-manager.h"
+#include "mapped-file.h"
+#include "opengl-setup.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gl {
+
+    struct recorded_frame final {
+        size_t viewport_width, viewport_height;
+        double time; // When frame was drawn (in glfwGetTime's seconds)
+
+        std::vector<window_event> events; // Received before the frame
+
+        size_t call_count;
+        size_t calls_offset, calls_size; // Range of calls in the file
+    };
+
+    // Reads frames written by command_recorder and makes the same calls
+    // again, frame by frame, on any drawing_manager. Drawing doesn't depend
+    // on anything else, so replay of a recording is deterministic.
+    class command_replay final {
+    public:
+        // Maps the file and indexes its frames, throws if it's malformed
+        explicit command_replay(const std::string& path);
+
+        size_t get_frame_count() const;
+        const recorded_frame& get_frame(size_t index) const;
+
+        // Makes the calls of frame /index/ on /mgr/. Text is skipped when
+        // /mgr/ has no text batch (e.g. with offscreen_canvas).
+        void replay(size_t index, drawing_manager& mgr);
+
+    private:
+        mapped_file m_file;
+        std::vector<recorded_frame> m_frames;
+
+        // Arguments that are spans are copied here, mapping isn't aligned
+        std::vector<math::vec2> m_from, m_to;
+        std::vector<float> m_xs, m_ys;
+        std::vector<colored_vertex> m_vertices;
+        std::string m_text;
+    };
+
+}
@@ -14,7 +14,7 @@ public:
     axes(math::vec2 x0, math::vec2 x1):
         axes(rectangle { x0, x1 }) {}
 
-    axes(): axes({ -1.0f, -1.0f }, { 1.0f, 1.0f }) {}
+    axes(): axes(math::vec2 { -1.0f, -1.0f }, math::vec2 { 1.0f, 1.0f }) {}
 
     math::vec2 get_view_coordinates(math::vec2 source) const {
         using math::vec;
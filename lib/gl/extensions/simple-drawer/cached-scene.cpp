@@ -0,0 +1,42 @@
+#include "cached-scene.h"
+#include "geometry-cache.h"
+
+namespace gl {
+
+    void cached_scene::save(const std::string& path,
+                            const vertex_vector_array<colored_vertex>& vertices,
+                            command_list& commands) {
+
+        const command_list::prepared_frame frame = commands.prepare(vertices);
+
+        std::vector<geometry_cache::range> ranges;
+        ranges.reserve(frame.commands.size());
+
+        for (const command_list::command& current: frame.commands)
+            ranges.push_back({ current.state, current.first, current.count, current.is_opaque });
+
+        geometry_cache::write(path, vertices.get_vertex_array().get_layout(),
+                              { frame.vertices.data(), frame.vertices.size_bytes() }, ranges);
+    }
+
+    cached_scene::cached_scene(const std::string& path, vertex_layout layout)
+        : m_vertices(layout) {
+
+        const geometry_cache cache(path);
+        cache.validate(layout, sizeof(colored_vertex));
+
+        cache.upload(m_vertices);
+
+        m_commands.reserve(cache.get_ranges().size());
+        for (const geometry_cache::range& current: cache.get_ranges())
+            m_commands.push_back({ 0, current.state, current.first, current.count,
+                                   current.is_opaque != 0, false });
+    }
+
+    void cached_scene::draw(command_list& commands) const {
+        commands.draw(m_vertices, m_commands);
+    }
+
+    size_t cached_scene::get_vertex_count() const { return m_vertices.get_element_count(); }
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "command-list.h"
+#include "vertex-array.h"
+#include "vertex-layout.h"
+#include "vertex-vector-array.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gl {
+
+    // Static scene that's tessellated once (by drawing_manager, with marks in
+    // a command list) and saved into a geometry cache, so that later runs only
+    // map the file and upload it. Ranges are saved already sorted, so neither
+    // loading nor drawing touches vertices on CPU.
+    class cached_scene final {
+    public:
+        // Saves frame recorded into /vertices/ along with the marks of
+        // /commands/ (they're consumed, as by submit) and vertices' layout
+        static void save(const std::string& path,
+                         const vertex_vector_array<colored_vertex>& vertices,
+                         command_list& commands);
+
+        // Maps the file and uploads it as is, should be created on GL thread.
+        // Throws if it was saved with a different /layout/ or vertex type.
+        cached_scene(const std::string& path, vertex_layout layout);
+
+        // Uses shaders and textures registered in /commands/, they should be
+        // registered in the same order as when scene was recorded
+        void draw(command_list& commands) const;
+
+        size_t get_vertex_count() const;
+
+    private:
+        vertex_array m_vertices;
+        std::vector<command_list::command> m_commands;
+    };
+
+}
@@ -0,0 +1,396 @@
+#include "command-list.h"
+#include "opengl-wrapper.h"
+#include "vec-layout.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    // ---------------------------------- SORT KEYS ----------------------------------
+
+    static constexpr size_t max_textures = 1 << 12; // Texture field is 12 bits wide
+
+    // Translucent plain ranges shorter than that are drawn along with
+    // shaped ones around them, instead of taking a draw call of their own
+    static constexpr uint32_t min_plain_count = 96;
+
+    uint32_t draw_state::get_bits() const {
+        return (uint32_t) layer << 24 | (uint32_t) shader << 16 |
+               ((uint32_t) blend & 0xf) << 12 | ((uint32_t) texture & 0xfff);
+    }
+
+    draw_state draw_state::from_bits(uint32_t bits) {
+        draw_state state;
+
+        state.layer   = (uint8_t) (bits >> 24);
+        state.shader  = (uint8_t) (bits >> 16);
+        state.blend   = (blend_mode) ((bits >> 12) & 0xf);
+        state.texture = (uint16_t) (bits & 0xfff);
+
+        return state;
+    }
+
+    uint64_t command_list::get_key(const command& current, uint32_t order) {
+        const uint64_t layer = current.state >> 24;
+
+        // Later ranges are in front, drawing them first lets depth test reject
+        // everything they cover. Translucent ones are blended, so their order
+        // can't change at all.
+        if (current.is_opaque)
+            return layer << 56 | (uint64_t) (current.state & 0xffffff) << 31 | (~order & 0x7fffffff);
+
+        return layer << 56 | (uint64_t) 1 << 55 | order;
+    }
+
+    // -------------------------------- REGISTRATION ---------------------------------
+
+    command_list::command_list(vertex_layout layout, const shaders::shader_program& default_shader)
+        : m_vertices(layout),
+          m_plain_vertices(math::vector_layout<float, 2>() +
+                           math::vector_layout<float, 4>() +
+                           math::vector_layout<float, 1>()),
+          m_shaders { &default_shader }, m_textures { nullptr } {}
+
+    uint8_t command_list::register_shader(const shaders::shader_program& shader) {
+        if (m_shaders.size() > UINT8_MAX)
+            throw std::length_error("Too many shaders are registered in command list!");
+
+        m_shaders.push_back(&shader);
+        return (uint8_t) (m_shaders.size() - 1);
+    }
+
+    uint16_t command_list::register_texture(const texture& new_texture) {
+        if (m_textures.size() >= max_textures)
+            throw std::length_error("Too many textures are registered in command list!");
+
+        m_textures.push_back(&new_texture);
+        return (uint16_t) (m_textures.size() - 1);
+    }
+
+    // ---------------------------------- RECORDING ----------------------------------
+
+    void command_list::mark(draw_state state, bool is_opaque, bool is_plain, size_t first) {
+        // Opaque ranges are never blended, so blend mode doesn't split them
+        if (is_opaque)
+            state.blend = blend_mode::NONE;
+
+        const uint32_t bits = state.get_bits();
+
+        if (!m_commands.empty()) {
+            command& last = m_commands.back();
+            if (last.state == bits && last.is_opaque == is_opaque && last.is_plain == is_plain)
+                return;
+
+            // Nothing was drawn with the previous state, just replace it
+            if (last.first == first) {
+                last.state = bits, last.is_opaque = is_opaque, last.is_plain = is_plain;
+
+                if (m_commands.size() > 1) {
+                    const command& before = m_commands[m_commands.size() - 2];
+                    if (before.state == bits && before.is_opaque == is_opaque &&
+                        before.is_plain == is_plain)
+                        m_commands.pop_back();
+                }
+
+                return;
+            }
+        }
+
+        m_commands.push_back({ 0, bits, (uint32_t) first, 0, is_opaque, is_plain });
+    }
+
+    std::span<const command_list::command> command_list::get_commands() const {
+        return m_commands;
+    }
+
+    void command_list::take_marks(command_list& recorded) {
+        // Swapped, so both lists keep their capacity between frames
+        m_commands.swap(recorded.m_commands);
+        recorded.m_commands.clear();
+    }
+
+    void command_list::clear() { m_commands.clear(); }
+
+    void command_list::set_override_shader(const shaders::shader_program* shader) {
+        m_override_shader = shader;
+    }
+
+    const command_list::submit_stats& command_list::get_stats() const { return m_stats; }
+
+    // ------------------------------------ SORTING ----------------------------------
+
+    void command_list::sort_commands() {
+        m_scratch.resize(m_commands.size());
+
+        for (size_t shift = 0; shift < 64; shift += 8) {
+            size_t offsets[256] = {};
+            for (const command& current: m_commands)
+                ++ offsets[(current.key >> shift) & 0xff];
+
+            // All keys have the same byte here, pass wouldn't move anything
+            if (offsets[(m_commands.front().key >> shift) & 0xff] == m_commands.size())
+                continue;
+
+            size_t total = 0;
+            for (size_t& offset: offsets)
+                total += std::exchange(offset, total);
+
+            for (const command& current: m_commands)
+                m_scratch[offsets[(current.key >> shift) & 0xff] ++] = current;
+
+            m_commands.swap(m_scratch);
+        }
+    }
+
+    // ---------------------------------- SUBMISSION ---------------------------------
+
+    void command_list::begin_layer(bool has_opaque) {
+        ++ m_stats.state_changes;
+
+        // Layer without opaque ranges has nothing to be tested against
+        if (!has_opaque) {
+            gl::raw::disable(GL_DEPTH_TEST);
+            return;
+        }
+
+        // Every layer is on top of previous ones, whatever their depth was
+        gl::raw::depth_mask(GL_TRUE);
+        gl::raw::clear(GL_DEPTH_BUFFER_BIT);
+
+        gl::raw::enable(GL_DEPTH_TEST);
+        gl::raw::depth_func(GL_LEQUAL);
+    }
+
+    void command_list::apply_state(draw_state state, bool is_opaque,
+                                   draw_state previous, bool was_opaque, bool is_first) {
+
+        if (is_first || state.shader != previous.shader)
+            ++ m_stats.state_changes; // Shader itself is bound by gl::draw
+
+        if (is_first || is_opaque != was_opaque) {
+            ++ m_stats.state_changes;
+            gl::raw::depth_mask(is_opaque ? GL_TRUE : GL_FALSE);
+        }
+
+        if (m_override_shader != nullptr) {
+            // Every fragment is counted, opaque ones too
+            if (is_first) {
+                gl::raw::enable(GL_BLEND);
+                gl::raw::blend_func(GL_ONE, GL_ONE);
+            }
+        } else if (is_first || state.blend != previous.blend) {
+            ++ m_stats.state_changes;
+
+            if (state.blend == blend_mode::NONE)
+                gl::raw::disable(GL_BLEND);
+            else
+                gl::raw::enable(GL_BLEND);
+
+            switch (state.blend) {
+                case blend_mode::ALPHA:    gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+                case blend_mode::ADDITIVE: gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE);                 break;
+                case blend_mode::MULTIPLY: gl::raw::blend_func(GL_DST_COLOR, GL_ZERO);                break;
+                case blend_mode::NONE:     break; // Blending is disabled above
+
+                // Marks decoded from malformed vertices blend as usual
+                default: gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+            }
+        }
+
+        if (state.texture != 0 && (is_first || state.texture != previous.texture)) {
+            ++ m_stats.state_changes;
+            m_textures[state.texture]->bind(0);
+        }
+    }
+
+    void command_list::submit(std::span<const colored_vertex> vertices) {
+        const prepared_frame frame = prepare(vertices);
+
+        // ==> Split ranges by layout, plain ones take about half the upload:
+
+        m_split.assign(frame.commands.begin(), frame.commands.end());
+        m_shaped.clear(), m_plain.clear();
+
+        bool has_plain = false;
+        for (command& current: m_split) {
+            if (!current.is_opaque && current.count < min_plain_count)
+                current.is_plain = false;
+
+            has_plain |= current.is_plain;
+        }
+
+        if (!has_plain) {
+            if (!frame.commands.empty())
+                m_vertices.assign({ frame.vertices.data(), frame.vertices.size_bytes() });
+
+            draw_ranges(m_vertices, nullptr, frame.commands);
+            return;
+        }
+
+        for (command& current: m_split) {
+            const colored_vertex* first = frame.vertices.data() + current.first;
+
+            if (current.is_plain) {
+                current.first = (uint32_t) m_plain.size();
+
+                for (const colored_vertex& vertex: std::span(first, current.count))
+                    m_plain.push_back({ vertex.point, vertex.color, vertex.depth });
+            } else {
+                current.first = (uint32_t) m_shaped.size();
+                m_shaped.insert(m_shaped.end(), first, first + current.count);
+            }
+        }
+
+        m_plain_vertices.assign({ m_plain.data(), m_plain.size() * sizeof(plain_vertex) });
+
+        if (!m_shaped.empty())
+            m_vertices.assign({ m_shaped.data(), m_shaped.size() * sizeof(colored_vertex) });
+
+        draw_ranges(m_vertices, &m_plain_vertices, m_split);
+    }
+
+    command_list::prepared_frame command_list::prepare(std::span<const colored_vertex> vertices) {
+        m_prepared.clear();
+
+        // Vertices before the first mark use default state
+        if (m_commands.empty() || m_commands.front().first != 0)
+            m_commands.insert(m_commands.begin(), { 0, draw_state {}.get_bits(), 0, 0, false, false });
+
+        // ==> Turn marks into ranges, dropping empty ones:
+
+        size_t kept = 0;
+        for (size_t i = 0; i < m_commands.size(); ++ i) {
+            const size_t end = i + 1 < m_commands.size() ? m_commands[i + 1].first : vertices.size();
+
+            command current = m_commands[i];
+            current.count = (uint32_t) (end - current.first);
+
+            if (current.count == 0)
+                continue;
+
+            const draw_state state = draw_state::from_bits(current.state);
+            if (state.shader >= m_shaders.size() || state.texture >= m_textures.size()) {
+                m_commands.clear();
+                throw std::out_of_range("Draw command uses unregistered shader or texture!");
+            }
+
+            current.key = get_key(current, (uint32_t) kept);
+            m_commands[kept ++] = current;
+        }
+
+        m_commands.resize(kept);
+        if (m_commands.empty())
+            return { vertices, {} };
+
+        // ==> Sort, and gather vertices in sorted order if it changed anything:
+
+        bool is_sorted = true;
+        for (size_t i = 1; i < m_commands.size() && is_sorted; ++ i)
+            is_sorted = m_commands[i - 1].key <= m_commands[i].key;
+
+        if (!is_sorted) {
+            sort_commands();
+
+            m_gathered.clear();
+            m_gathered.reserve(vertices.size());
+
+            for (command& current: m_commands) {
+                const colored_vertex* first = vertices.data() + current.first;
+                current.first = (uint32_t) m_gathered.size();
+
+                m_gathered.insert(m_gathered.end(), first, first + current.count);
+            }
+
+            vertices = m_gathered;
+        }
+
+        // Marks are consumed, list is ready for the next frame
+        m_prepared.swap(m_commands);
+        m_commands.clear();
+
+        return { vertices, m_prepared };
+    }
+
+    void command_list::draw(const vertex_array& vertices, std::span<const command> commands) {
+        draw_ranges(vertices, nullptr, commands);
+    }
+
+    void command_list::draw_ranges(const vertex_array& vertices, const vertex_array* plain_vertices,
+                                   std::span<const command> commands) {
+
+        m_stats.commands = m_stats.draws = m_stats.opaque_draws = m_stats.state_changes = 0;
+        m_stats.triangles_per_layer.clear();
+
+        if (commands.empty())
+            return;
+
+        // Commands can come from elsewhere (e.g. a geometry cache)
+        for (const command& current: commands) {
+            const draw_state state = draw_state::from_bits(current.state);
+            if (state.shader >= m_shaders.size() || state.texture >= m_textures.size())
+                throw std::out_of_range("Draw command uses unregistered shader or texture!");
+        }
+
+        // ==> Draw neighbouring ranges with the same state at once:
+
+        draw_state previous;
+        bool was_opaque = false;
+
+        for (size_t i = 0; i < commands.size(); ) {
+            const command& batch_start = commands[i];
+
+            size_t count = batch_start.count;
+            for (++ i; i < commands.size(); ++ i) {
+                const command& current = commands[i];
+                if (current.state != batch_start.state || current.is_opaque != batch_start.is_opaque)
+                    break;
+
+                // Ranges of different layouts are in different arrays
+                if (plain_vertices != nullptr && current.is_plain != batch_start.is_plain)
+                    break;
+
+                count += current.count;
+            }
+
+            const draw_state state = draw_state::from_bits(batch_start.state);
+            const bool is_first = m_stats.draws == 0;
+
+            // Opaque ranges are sorted first, so that's what layer starts with
+            if (is_first || state.layer != previous.layer)
+                begin_layer(batch_start.is_opaque);
+
+            apply_state(state, batch_start.is_opaque, previous, was_opaque, is_first);
+
+            const shaders::shader_program& shader = m_override_shader != nullptr ?
+                *m_override_shader : *m_shaders[state.shader];
+
+            const bool is_plain = plain_vertices != nullptr && batch_start.is_plain;
+            gl::draw(drawing_type::TRIANGLES, is_plain ? *plain_vertices : vertices,
+                     shader, batch_start.first, count);
+
+            if (m_stats.triangles_per_layer.size() <= state.layer)
+                m_stats.triangles_per_layer.resize(state.layer + 1, 0);
+
+            m_stats.triangles_per_layer[state.layer] += count / 3;
+
+            previous = state, was_opaque = batch_start.is_opaque;
+
+            ++ m_stats.draws;
+            if (batch_start.is_opaque)
+                ++ m_stats.opaque_draws;
+        }
+
+        // Leave window's defaults for whatever is drawn next
+        gl::raw::disable(GL_DEPTH_TEST);
+        gl::raw::depth_mask(GL_TRUE);
+
+        if (previous.blend != blend_mode::ALPHA || m_override_shader != nullptr) {
+            gl::raw::enable(GL_BLEND);
+            gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        m_stats.commands = commands.size();
+    }
+
+}
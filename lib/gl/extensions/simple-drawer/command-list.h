@@ -0,0 +1,165 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "opengl-setup.h"
+#include "texture.h"
+#include "vertex-array.h"
+#include "vertex-layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    enum class blend_mode : uint8_t {
+        ALPHA    = 0, // Regular transparency (window's default)
+        ADDITIVE = 1, // Adds color, e.g. for glow and heat maps
+        MULTIPLY = 2, // Darkens, e.g. for shadows
+        NONE     = 3  // Opaque, blending is disabled
+    };
+
+    // Everything that needs a GL state change between two draws. Primitives
+    // with equal states (and neighbouring sort keys) end up in one draw call.
+    struct draw_state final {
+        uint8_t layer = 0;   // Lower layers are drawn first
+        uint8_t shader = 0;  // Index of command_list's registered shader
+        blend_mode blend = blend_mode::ALPHA;
+        uint16_t texture = 0; // Index of registered texture, zero means none
+
+        // Packed as layer (8 bits), shader (8), blend (4), texture (12)
+        uint32_t get_bits() const;
+        static draw_state from_bits(uint32_t bits);
+    };
+
+    // Records which draw state each range of a frame's vertices should be
+    // drawn with (state changes are just marks, nothing is copied), then
+    // sorts ranges by 64-bit keys and draws them with the fewest state changes.
+    //
+    // Every layer is drawn in two passes. Opaque ranges go first, grouped by
+    // state and front-to-back, with depth test and writes on and blending off,
+    // so hidden pixels are rejected before shading. Translucent ranges follow
+    // in submission order with blending, depth-tested against opaque ones.
+    // Vertices carry their drawing order as depth (see colored_vertex).
+    //
+    // Ranges of plain triangles (no edges or shapes, which is most of them)
+    // are uploaded as plain_vertex, about half the size, SDF lines and
+    // shapes keep the whole colored_vertex in an array of their own.
+    //
+    // Must be created and submitted on GL thread, marks have no GL calls.
+    class command_list {
+    public:
+        struct command final {
+            uint64_t key;   // Computed at submission
+            uint32_t state; // draw_state bits
+            uint32_t first, count; // Range of recorded vertices
+            bool is_opaque;
+            bool is_plain; // Can be drawn without edges and shapes
+        };
+
+        struct submit_stats final {
+            size_t commands = 0;      // Ranges after merging equal neighbours
+            size_t draws = 0;         // Draw calls issued
+            size_t opaque_draws = 0;  // Of them, drawn in opaque passes
+            size_t state_changes = 0; // Shader, blend, depth or texture switches
+
+            std::vector<size_t> triangles_per_layer; // Indexed by layer
+        };
+
+        // /default_shader/ gets index zero, all shaders registered
+        // later must accept vertices of the same /layout/
+        command_list(vertex_layout layout, const shaders::shader_program& default_shader);
+
+        // This class shouldn't be copied or moved
+        command_list(const command_list&) = delete;
+        command_list& operator=(const command_list&) = delete;
+
+        // ==> Registered objects (should outlive the list):
+
+        uint8_t  register_shader(const shaders::shader_program& shader);
+        uint16_t register_texture(const texture& new_texture);
+
+        // ==> Recording:
+
+        // Vertices starting from /first/ (until the next mark) use /state/,
+        // opaque ones should be fully covered by their triangles with alpha 1,
+        // plain ones shouldn't have edges or shapes (see colored_vertex)
+        void mark(draw_state state, bool is_opaque, bool is_plain, size_t first);
+
+        std::span<const command> get_commands() const;
+
+        // Replaces marks with ones recorded into /recorded/ (e.g. by another
+        // thread, into a list that's only used for recording), which is left
+        // without marks. Registered objects of /recorded/ aren't taken.
+        void take_marks(command_list& recorded);
+
+        // ==> Submission:
+
+        // Ranges in the order they're drawn in, with vertices gathered in that
+        // order (just recorded ones, if sorting didn't move anything)
+        struct prepared_frame final {
+            std::span<const colored_vertex> vertices;
+            std::span<const command> commands;
+        };
+
+        // Draws recorded /vertices/ as triangles sorted by key, then clears
+        // marks, so the list is ready for the next frame
+        void submit(std::span<const colored_vertex> vertices);
+
+        // First half of submit: sorts ranges and clears marks without drawing,
+        // result is valid until the next call (e.g. to be saved and drawn later)
+        prepared_frame prepare(std::span<const colored_vertex> vertices);
+
+        // Second half of submit: draws prepared ranges of already uploaded
+        // /vertices/ (e.g. loaded from a geometry cache), all of them in
+        // colored_vertex's layout
+        void draw(const vertex_array& vertices, std::span<const command> commands);
+
+        // Drops marks without drawing
+        void clear();
+
+        // Diagnostics: draws everything with /shader/ and additive (one, one)
+        // blending instead, depth test is kept, so only fragments that would
+        // be shaded are drawn (e.g. to count them). Null restores normal drawing.
+        void set_override_shader(const shaders::shader_program* shader);
+
+        const submit_stats& get_stats() const;
+
+    private:
+        vertex_array m_vertices, m_plain_vertices;
+
+        std::vector<const shaders::shader_program*> m_shaders;
+        std::vector<const texture*> m_textures; // First one is null (no texture)
+
+        std::vector<command> m_commands, m_scratch;
+        std::vector<command> m_prepared; // Last prepare's result
+        std::vector<colored_vertex> m_gathered; // Vertices in sorted order
+
+        // Submitted ranges split by vertex layout, reused between frames
+        std::vector<command> m_split;
+        std::vector<colored_vertex> m_shaped;
+        std::vector<plain_vertex> m_plain;
+
+        submit_stats m_stats;
+
+        const shaders::shader_program* m_override_shader = nullptr;
+
+        // Stable LSD radix sort of m_commands by key (byte at a time)
+        void sort_commands();
+
+        // Sort keys (from the most significant bits): layer (8 bits), pass
+        // (1, opaque first), then for opaque ranges state (24) and reversed
+        // order (31), for translucent ones just order, so they stay in place
+        static uint64_t get_key(const command& current, uint32_t order);
+
+        // Plain ranges are drawn from /plain_vertices/ if it's not null
+        void draw_ranges(const vertex_array& vertices, const vertex_array* plain_vertices,
+                         std::span<const command> commands);
+
+        void begin_layer(bool has_opaque);
+        void apply_state(draw_state state, bool is_opaque,
+                         draw_state previous, bool was_opaque, bool is_first);
+    };
+
+}
@@ -0,0 +1,154 @@
+#include "culling.h"
+
+#include <algorithm>
+
+#if defined(__AVX__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace gl::culling {
+
+    // ------------------------------ SEGMENT CLIPPING ------------------------------
+
+    bool clip_segment(float& x0, float& y0, float& x1, float& y1, bounds rect) {
+        const float dx = x1 - x0, dy = y1 - y0;
+
+        // Segment is parametrized as p(t) = p0 + t * d, where t is in [0, 1],
+        // each edge of the rectangle limits t either from below or from above
+        const float p[4] = { -dx, dx, -dy, dy };
+        const float q[4] = { x0 - rect.min_x, rect.max_x - x0,
+                             y0 - rect.min_y, rect.max_y - y0 };
+
+        float t0 = 0.0f, t1 = 1.0f;
+        for (int i = 0; i < 4; ++ i) {
+            if (p[i] < 0.0f)
+                t0 = std::max(t0, q[i] / p[i]); // Entering
+            else if (p[i] > 0.0f)
+                t1 = std::min(t1, q[i] / p[i]); // Leaving
+            else if (q[i] < 0.0f)
+                return false; // Parallel to this edge and completely outside of it
+        }
+
+        if (t0 > t1)
+            return false;
+
+        x1 = x0 + t1 * dx, y1 = y0 + t1 * dy;
+        x0 = x0 + t0 * dx, y0 = y0 + t0 * dy;
+
+        return true;
+    }
+
+    size_t clip_segments(float* x0, float* y0, float* x1, float* y1,
+                         uint8_t* visible, size_t count, bounds rect) {
+        size_t visible_count = 0, i = 0;
+
+    #ifdef __AVX__
+        const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+        const __m256 min_x = _mm256_set1_ps(rect.min_x), max_x = _mm256_set1_ps(rect.max_x);
+        const __m256 min_y = _mm256_set1_ps(rect.min_y), max_y = _mm256_set1_ps(rect.max_y);
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256 sx = _mm256_loadu_ps(x0 + i), sy = _mm256_loadu_ps(y0 + i);
+            const __m256 ex = _mm256_loadu_ps(x1 + i), ey = _mm256_loadu_ps(y1 + i);
+
+            const __m256 dx = _mm256_sub_ps(ex, sx), dy = _mm256_sub_ps(ey, sy);
+
+            const __m256 p[4] = { _mm256_sub_ps(zero, dx), dx, _mm256_sub_ps(zero, dy), dy };
+            const __m256 q[4] = { _mm256_sub_ps(sx, min_x), _mm256_sub_ps(max_x, sx),
+                                  _mm256_sub_ps(sy, min_y), _mm256_sub_ps(max_y, sy) };
+
+            __m256 t0 = zero, t1 = one, rejected = zero;
+            for (int k = 0; k < 4; ++ k) {
+                const __m256 entering = _mm256_cmp_ps(p[k], zero, _CMP_LT_OQ);
+                const __m256  leaving = _mm256_cmp_ps(p[k], zero, _CMP_GT_OQ);
+                const __m256 parallel = _mm256_cmp_ps(p[k], zero, _CMP_EQ_OQ);
+
+                const __m256  outside = _mm256_cmp_ps(q[k], zero, _CMP_LT_OQ);
+                rejected = _mm256_or_ps(rejected, _mm256_and_ps(parallel, outside));
+
+                // Lanes where p = 0 get garbage here, but blends skip them
+                const __m256 t = _mm256_div_ps(q[k], p[k]);
+
+                t0 = _mm256_blendv_ps(t0, _mm256_max_ps(t0, t), entering);
+                t1 = _mm256_blendv_ps(t1, _mm256_min_ps(t1, t),  leaving);
+            }
+
+            rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(t0, t1, _CMP_GT_OQ));
+
+            _mm256_storeu_ps(x0 + i, _mm256_add_ps(sx, _mm256_mul_ps(t0, dx)));
+            _mm256_storeu_ps(y0 + i, _mm256_add_ps(sy, _mm256_mul_ps(t0, dy)));
+            _mm256_storeu_ps(x1 + i, _mm256_add_ps(sx, _mm256_mul_ps(t1, dx)));
+            _mm256_storeu_ps(y1 + i, _mm256_add_ps(sy, _mm256_mul_ps(t1, dy)));
+
+            const int rejected_mask = _mm256_movemask_ps(rejected);
+            for (int k = 0; k < 8; ++ k) {
+                visible[i + (size_t) k] = !(rejected_mask & (1 << k));
+                visible_count += visible[i + (size_t) k];
+            }
+        }
+    #endif
+
+        for (; i < count; ++ i) {
+            visible[i] = clip_segment(x0[i], y0[i], x1[i], y1[i], rect);
+            visible_count += visible[i];
+        }
+
+        return visible_count;
+    }
+
+    // ------------------------------ TRIANGLE CULLING ------------------------------
+
+    bool is_triangle_visible(const float xs[3], const float ys[3], bounds rect) {
+        const auto [min_x, max_x] = std::minmax({ xs[0], xs[1], xs[2] });
+        const auto [min_y, max_y] = std::minmax({ ys[0], ys[1], ys[2] });
+
+        return !(max_x < rect.min_x || min_x > rect.max_x ||
+                 max_y < rect.min_y || min_y > rect.max_y);
+    }
+
+    size_t cull_triangles(const float* xs, const float* ys,
+                          uint8_t* visible, size_t count, bounds rect) {
+        size_t visible_count = 0, i = 0;
+
+    #ifdef __AVX2__
+        const __m256 min_x = _mm256_set1_ps(rect.min_x), max_x = _mm256_set1_ps(rect.max_x);
+        const __m256 min_y = _mm256_set1_ps(rect.min_y), max_y = _mm256_set1_ps(rect.max_y);
+
+        // Gathers i-th vertex of 8 consecutive triangles
+        const __m256i indices = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256 lo_x = _mm256_i32gather_ps(xs + 3 * i, indices, 4), hi_x = lo_x;
+            __m256 lo_y = _mm256_i32gather_ps(ys + 3 * i, indices, 4), hi_y = lo_y;
+
+            for (int k = 1; k < 3; ++ k) {
+                const __m256 x = _mm256_i32gather_ps(xs + 3 * i + k, indices, 4);
+                const __m256 y = _mm256_i32gather_ps(ys + 3 * i + k, indices, 4);
+
+                lo_x = _mm256_min_ps(lo_x, x), hi_x = _mm256_max_ps(hi_x, x);
+                lo_y = _mm256_min_ps(lo_y, y), hi_y = _mm256_max_ps(hi_y, y);
+            }
+
+            __m256 rejected = _mm256_cmp_ps(hi_x, min_x, _CMP_LT_OQ);
+            rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(lo_x, max_x, _CMP_GT_OQ));
+            rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(hi_y, min_y, _CMP_LT_OQ));
+            rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(lo_y, max_y, _CMP_GT_OQ));
+
+            const int rejected_mask = _mm256_movemask_ps(rejected);
+            for (int k = 0; k < 8; ++ k) {
+                visible[i + (size_t) k] = !(rejected_mask & (1 << k));
+                visible_count += visible[i + (size_t) k];
+            }
+        }
+    #endif
+
+        for (; i < count; ++ i) {
+            visible[i] = is_triangle_visible(xs + 3 * i, ys + 3 * i, rect);
+            visible_count += visible[i];
+        }
+
+        return visible_count;
+    }
+
+}
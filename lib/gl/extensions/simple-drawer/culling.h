@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Batch kernels for rejecting and clipping primitives against an axis-aligned
+// rectangle. Inputs are in SoA form, so they can be processed 8 at a time.
+namespace gl::culling {
+
+    struct bounds final {
+        float min_x, min_y;
+        float max_x, max_y;
+    };
+
+    // Liang-Barsky clipping of segments (x0, y0) -> (x1, y1), done in place.
+    // Writes 1 to /visible/ for segments that intersect bounds, 0 otherwise,
+    // returns number of visible segments.
+    size_t clip_segments(float* x0, float* y0, float* x1, float* y1,
+                         uint8_t* visible, size_t count, bounds rect);
+
+    // Same as above, but for a single segment (returns whether it's visible)
+    bool clip_segment(float& x0, float& y0, float& x1, float& y1, bounds rect);
+
+    // Trivial reject: triangle is invisible if all of its vertices lie on the
+    // outer side of the same bounds' edge. That's conservative, some big
+    // triangles that miss bounds will still be reported visible.
+    size_t cull_triangles(const float* xs, const float* ys, // 3 per triangle
+                          uint8_t* visible, size_t count, bounds rect);
+
+    bool is_triangle_visible(const float xs[3], const float ys[3], bounds rect);
+
+}
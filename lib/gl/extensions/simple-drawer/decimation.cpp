@@ -0,0 +1,88 @@
+#include "decimation.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace gl::decimation {
+
+    void min_max(const float* values, size_t count, float& min, float& max) {
+        float current_min = +std::numeric_limits<float>::infinity();
+        float current_max = -std::numeric_limits<float>::infinity();
+
+        size_t i = 0;
+
+    #ifdef __AVX__
+        if (count >= 8) {
+            __m256 lanes_min = _mm256_set1_ps(current_min);
+            __m256 lanes_max = _mm256_set1_ps(current_max);
+
+            // If either operand is NaN, second one is returned, so keeping
+            // accumulator second makes NaN samples disappear
+            for (; i + 8 <= count; i += 8) {
+                const __m256 current = _mm256_loadu_ps(values + i);
+
+                lanes_min = _mm256_min_ps(current, lanes_min);
+                lanes_max = _mm256_max_ps(current, lanes_max);
+            }
+
+            alignas(32) float mins[8], maxs[8];
+            _mm256_store_ps(mins, lanes_min);
+            _mm256_store_ps(maxs, lanes_max);
+
+            for (int k = 0; k < 8; ++ k) {
+                current_min = std::min(current_min, mins[k]);
+                current_max = std::max(current_max, maxs[k]);
+            }
+        }
+    #endif
+
+        for (; i < count; ++ i) {
+            if (values[i] < current_min) current_min = values[i];
+            if (values[i] > current_max) current_max = values[i];
+        }
+
+        min = current_min, max = current_max;
+    }
+
+    void decimate(const float* xs, const float* ys, size_t count,
+                  float x0, float column_width,
+                  column_envelope* columns, size_t column_count,
+                  thread_pool& pool) {
+
+        // Each column is only a couple of binary searches and a short scan,
+        // hand them out in chunks, so that scheduling doesn't dominate
+        constexpr size_t chunk_size = 64;
+        const size_t chunk_count = (column_count + chunk_size - 1) / chunk_size;
+
+        pool.parallel_for(chunk_count, [&](size_t chunk) {
+            const size_t first_column = chunk * chunk_size;
+            const size_t  last_column = std::min(column_count, first_column + chunk_size);
+
+            const float* end = xs + count;
+            const float* begin = std::lower_bound(xs, end, x0 + (float) first_column * column_width);
+
+            for (size_t i = first_column; i < last_column; ++ i) {
+                const float* column_end = std::lower_bound(begin, end, x0 + (float) (i + 1) * column_width);
+                column_envelope& current = columns[i];
+
+                if (begin == column_end) {
+                    current = { 1, 0, 0.0f, 0.0f };
+                    continue;
+                }
+
+                current.first = (size_t) (begin - xs);
+                current.last  = (size_t) (column_end - xs) - 1;
+
+                min_max(ys + current.first, current.last - current.first + 1,
+                        current.min_y, current.max_y);
+
+                begin = column_end;
+            }
+        });
+    }
+
+}
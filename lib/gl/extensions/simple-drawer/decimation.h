@@ -0,0 +1,27 @@
+#pragma once
+
+#include "thread-pool.h"
+
+#include <cstddef>
+
+// Reduction of densely sampled series (x sorted ascending) to what can
+// actually be seen: for each pixel column only the first and the last
+// samples and the vertical range between them matter.
+namespace gl::decimation {
+
+    struct column_envelope final {
+        size_t first, last; // Indices of samples, first > last if empty
+        float min_y, max_y; // NaN samples are skipped
+    };
+
+    // Finds minimum and maximum of /count/ values, 8 at a time when possible
+    void min_max(const float* values, size_t count, float& min, float& max);
+
+    // Splits [x0, x0 + column_count * column_width) into columns and computes
+    // envelope of samples falling into each of them, in parallel on /pool/
+    void decimate(const float* xs, const float* ys, size_t count,
+                  float x0, float column_width,
+                  column_envelope* columns, size_t column_count,
+                  thread_pool& pool = thread_pool::global());
+
+}
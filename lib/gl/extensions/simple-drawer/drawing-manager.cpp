@@ -1,40 +1,291 @@
 #include "colored-vertex.h"
+#include "command-recorder.h"
+#include "culling.h"
 #include "math.h"
 #include "drawing-manager.h"
+#include "text-batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
 
 namespace gl {
 
     void drawing_manager::set_color(math::vec3 color) {
+        const call_scope scope = record(recorded_call::SET_COLOR, color);
+
         m_current_color = { color.r(), color.g(), color.b(), 1.0f };
     }
 
     void drawing_manager::set_alpha(float alpha) {
+        const call_scope scope = record(recorded_call::SET_ALPHA, alpha);
+
         m_current_color.a() = alpha;
     }
 
-    void drawing_manager::set_axes(axes axes) { m_axes = axes; }
+    void drawing_manager::set_axes(axes axes) {
+        const call_scope scope = record(recorded_call::SET_AXES, axes);
+
+        m_axes = axes;
+        update_cull_bounds();
+    }
+
+    const axes& drawing_manager::get_axes() const { return m_axes; }
 
     void drawing_manager::set_width(float width) {
+        const call_scope scope = record(recorded_call::SET_WIDTH, width);
+
         m_width = width;
     }
 
+    float drawing_manager::get_width() const { return m_width; }
+
+    void drawing_manager::set_antialiasing(antialiasing_mode mode) {
+        const call_scope scope = record(recorded_call::SET_ANTIALIASING, mode);
+
+        m_antialiasing_mode = mode;
+    }
+
+    void drawing_manager::set_viewport_size(size_t width, size_t height) {
+        const call_scope scope = record(recorded_call::SET_VIEWPORT_SIZE, width, height);
+
+        m_viewport_width = width, m_viewport_height = height;
+    }
+
+    size_t drawing_manager::get_viewport_width()  const { return m_viewport_width;  }
+    size_t drawing_manager::get_viewport_height() const { return m_viewport_height; }
+
+    math::vec2 drawing_manager::get_pixel_size() const {
+        if (m_viewport_width == 0 || m_viewport_height == 0)
+            return { 0.0f, 0.0f };
+
+        const rectangle& world = m_axes.m_world, &view = m_axes.m_view;
+
+        // View is in clip space, which is 2 units across the whole viewport
+        const float world_width  = std::abs(world.x1.x() - world.x0.x());
+        const float world_height = std::abs(world.x1.y() - world.x0.y());
+
+        const float view_width  = std::abs(view.x1.x() - view.x0.x()) / 2.0f * (float) m_viewport_width;
+        const float view_height = std::abs(view.x1.y() - view.x0.y()) / 2.0f * (float) m_viewport_height;
+
+        return { world_width / view_width, world_height / view_height };
+    }
+
+    // ---------------------------------- DRAW STATE ---------------------------------
+
+    void drawing_manager::set_command_list(command_list* commands) {
+        m_command_list = commands;
+        mark_state();
+    }
+
+    command_list* drawing_manager::get_command_list() const { return m_command_list; }
+
+    void drawing_manager::set_layer(uint8_t layer) {
+        const call_scope scope = record(recorded_call::SET_LAYER, layer);
+
+        m_state.layer = layer;
+        mark_state();
+    }
+
+    void drawing_manager::set_shader(uint8_t shader) {
+        const call_scope scope = record(recorded_call::SET_SHADER, shader);
+
+        m_state.shader = shader;
+        mark_state();
+    }
+
+    void drawing_manager::set_blend(blend_mode blend) {
+        const call_scope scope = record(recorded_call::SET_BLEND, blend);
+
+        m_state.blend = blend;
+        mark_state();
+    }
+
+    void drawing_manager::set_texture(uint16_t texture) {
+        const call_scope scope = record(recorded_call::SET_TEXTURE, texture);
+
+        m_state.texture = texture;
+        mark_state();
+    }
+
+    const draw_state& drawing_manager::get_state() const { return m_state; }
+
+    void drawing_manager::mark_state() {
+        if (m_command_list != nullptr)
+            m_command_list->mark(m_state, m_is_opaque, m_is_plain, m_vertices.size());
+    }
+
+    static bool is_opaque_vertex(const colored_vertex& vertex) {
+        // Edges and shapes have partially covered pixels on their boundary
+        return vertex.color.a() >= 1.0f && vertex.is_plain();
+    }
+
+    void drawing_manager::mark_opacity(const colored_vertex& p0, const colored_vertex& p1,
+                                       const colored_vertex& p2) {
+        if (m_command_list == nullptr)
+            return;
+
+        // Custom shaders and textures can have transparent pixels anywhere
+        const bool is_opaque = m_state.shader == 0 && m_state.texture == 0 &&
+            (m_state.blend == blend_mode::ALPHA || m_state.blend == blend_mode::NONE) &&
+            is_opaque_vertex(p0) && is_opaque_vertex(p1) && is_opaque_vertex(p2);
+
+        // Custom shaders may read edges and shapes in their own way
+        const bool is_plain = m_state.shader == 0 &&
+            p0.is_plain() && p1.is_plain() && p2.is_plain();
+
+        if (is_opaque != m_is_opaque || is_plain != m_is_plain) {
+            m_is_opaque = is_opaque, m_is_plain = is_plain;
+            mark_state();
+        }
+    }
+
+    // ------------------------------------- DEPTH -----------------------------------
+
+    uint32_t drawing_manager::get_depth() const { return m_depth; }
+
+    uint32_t drawing_manager::reserve_depth(uint32_t count) {
+        const call_scope scope = record(recorded_call::RESERVE_DEPTH, count);
+
+        const uint32_t first = m_depth;
+        m_depth = std::min(max_depth, m_depth + std::min(count, max_depth));
+
+        return first;
+    }
+
+    // ----------------------------------- CULLING ----------------------------------
+
+    void drawing_manager::set_culling(culling_mode mode) {
+        const call_scope scope = record(recorded_call::SET_CULLING, mode);
+
+        m_culling_mode = mode;
+        update_cull_bounds();
+    }
+
+    const culling_stats& drawing_manager::get_culling_stats() const {
+        return m_culling_stats;
+    }
+
+    void drawing_manager::reset_culling_stats() {
+        m_culling_stats = {};
+    }
+
+    culling::bounds drawing_manager::get_visible_bounds() const {
+        return m_cull_bounds;
+    }
+
+    void drawing_manager::update_cull_bounds() {
+        // Visible region in view (clip space) coordinates:
+        float min_x = -1.0f, min_y = -1.0f, max_x = 1.0f, max_y = 1.0f;
+
+        if (m_culling_mode == culling_mode::VIEW_RECT) {
+            const rectangle& view = m_axes.m_view;
+
+            min_x = std::max(min_x, std::min(view.x0.x(), view.x1.x()));
+            max_x = std::min(max_x, std::max(view.x0.x(), view.x1.x()));
+            min_y = std::max(min_y, std::min(view.x0.y(), view.x1.y()));
+            max_y = std::min(max_y, std::max(view.x0.y(), view.x1.y()));
+        }
+
+        // Primitives are culled before they're transformed, so go back to
+        // world coordinates (axes only scale and shift, which keeps it a rect)
+        const math::vec2 first  = m_axes.get_world_coordinates({ min_x, min_y });
+        const math::vec2 second = m_axes.get_world_coordinates({ max_x, max_y });
+
+        m_cull_bounds = {
+            std::min(first.x(), second.x()), std::min(first.y(), second.y()),
+            std::max(first.x(), second.x()), std::max(first.y(), second.y())
+        };
+    }
+
+    // Clipping only moves endpoints inwards, any difference means it happened
+    static bool is_clipped(float x0, float y0, float x1, float y1, math::vec2 from, math::vec2 to) {
+        return std::abs(x0 - from.x()) + std::abs(y0 - from.y()) +
+               std::abs(x1 - to.x())   + std::abs(y1 - to.y()) > 0.0f;
+    }
+
+    bool drawing_manager::clip_line(math::vec2& from, math::vec2& to) {
+        if (m_culling_mode == culling_mode::NONE) {
+            ++ m_culling_stats.emitted;
+            return true;
+        }
+
+        // Caps and antialiasing go beyond the line itself, keep them intact
+        culling::bounds bounds = m_cull_bounds;
+        bounds.min_x -= m_width, bounds.min_y -= m_width;
+        bounds.max_x += m_width, bounds.max_y += m_width;
+
+        float x0 = from.x(), y0 = from.y(), x1 = to.x(), y1 = to.y();
+        if (!culling::clip_segment(x0, y0, x1, y1, bounds)) {
+            ++ m_culling_stats.culled;
+            return false;
+        }
+
+        if (is_clipped(x0, y0, x1, y1, from, to)) {
+            from = { x0, y0 }, to = { x1, y1 };
+            ++ m_culling_stats.clipped;
+        }
+
+        ++ m_culling_stats.emitted;
+        return true;
+    }
+
+    // ---------------------------------- PRIMITIVES ---------------------------------
 
     void drawing_manager::draw_interpolated_triangle(colored_vertex p0, colored_vertex p1, colored_vertex p2) {
-        m_vertices.insert(m_vertices.end(), {
-            { m_axes.get_view_coordinates(p0.point), p0.color },
-            { m_axes.get_view_coordinates(p1.point), p1.color },
-            { m_axes.get_view_coordinates(p2.point), p2.color }
-        });
+        const call_scope scope = record(recorded_call::DRAW_INTERPOLATED_TRIANGLE, p0, p1, p2);
+
+        if (m_culling_mode != culling_mode::NONE) {
+            const float xs[3] = { p0.point.x(), p1.point.x(), p2.point.x() };
+            const float ys[3] = { p0.point.y(), p1.point.y(), p2.point.y() };
+
+            if (!culling::is_triangle_visible(xs, ys, m_cull_bounds)) {
+                ++ m_culling_stats.culled;
+                return;
+            }
+        }
+
+        ++ m_culling_stats.emitted;
+        emit_interpolated_triangle(p0, p1, p2);
+    }
+
+    void drawing_manager::emit_interpolated_triangle(colored_vertex p0, colored_vertex p1, colored_vertex p2) {
+        mark_opacity(p0, p1, p2);
+
+        if (m_depth < max_depth)
+            ++ m_depth;
+
+        p0.point = m_axes.get_view_coordinates(p0.point), p0.depth = (float) m_depth;
+        p1.point = m_axes.get_view_coordinates(p1.point), p1.depth = (float) m_depth;
+        p2.point = m_axes.get_view_coordinates(p2.point), p2.depth = (float) m_depth;
+
+        m_vertices.insert(m_vertices.end(), { p0, p1, p2 });
     }
 
     void drawing_manager::draw_triangle(math::vec2 p0, math::vec2 p1, math::vec2 p2) {
+        const call_scope scope = record(recorded_call::DRAW_TRIANGLE, p0, p1, p2);
+
         draw_interpolated_triangle({ p0, m_current_color },
                                    { p1, m_current_color },
                                    { p2, m_current_color });
     }
 
+    void drawing_manager::emit_triangle(math::vec2 p0, math::vec2 p1, math::vec2 p2) {
+        emit_interpolated_triangle({ p0, m_current_color },
+                                   { p1, m_current_color },
+                                   { p2, m_current_color });
+    }
+
     void drawing_manager::draw_line(math::vec2 from, math::vec2 to) {
+        const call_scope scope = record(recorded_call::DRAW_LINE, from, to);
+
+        if (clip_line(from, to))
+            emit_line(from, to);
+    }
+
+    void drawing_manager::emit_line(math::vec2 from, math::vec2 to) {
         math::vec direction = from - to;
         math::vec shift = direction
             .perpendicular().normalized();
@@ -57,11 +308,63 @@ namespace gl {
         p1 -= shift, p3 -= shift;
         p0 += shift, p2 += shift;
 
-        draw_triangle(p0, p1, p2), draw_triangle(p3, p1, p2);
+        emit_triangle(p0, p1, p2), emit_triangle(p3, p1, p2);
     }
 
     void drawing_manager::draw_antialiased_line(math::vec2 from, math::vec2 to,
                                                 float antialiasing_level) {
+        const call_scope scope = record(recorded_call::DRAW_ANTIALIASED_LINE, from, to, antialiasing_level);
+
+        if (!clip_line(from, to))
+            return;
+
+        switch (m_antialiasing_mode) {
+        case antialiasing_mode::FEATHER:  emit_antialiased_line(from, to, antialiasing_level); break;
+        case antialiasing_mode::ANALYTIC: emit_analytic_line(from, to); break;
+        case antialiasing_mode::NONE:     emit_line(from, to); break;
+
+        default: break;
+        }
+    }
+
+    void drawing_manager::emit_analytic_line(math::vec2 from, math::vec2 to) {
+        const float half_width = m_width / 2.0f;
+        if (half_width <= 0.0f)
+            return;
+
+        math::vec2 along = to - from;
+        const float length = along.len();
+
+        // Same rectangular caps as other lines have (so a point is a square)
+        const float half_length = length / 2.0f + half_width;
+        along = length > 0.0f ? along * (1.0f / length) : math::vec2 { 1.0f, 0.0f };
+
+        const math::vec2 across = along.perpendicular();
+        const math::vec2 center = (from + to) * 0.5f;
+
+        // Pixels on the boundary are only partially covered, so quad is
+        // extended by a pixel to give shader room for the falloff
+        const math::vec2 pixel = get_pixel_size();
+        const float padding = std::max(pixel.x(), pixel.y());
+
+        const float outer_width = half_width + padding, outer_length = half_length + padding;
+
+        // Edge distances at quad's corners, interpolated linearly in between
+        const float edge_across = outer_width / half_width, edge_along = outer_length / half_length;
+
+        const math::vec2 side = across * outer_width, end = along * outer_length;
+
+        const colored_vertex p0 { center - end - side, m_current_color, { -edge_across, -edge_along } };
+        const colored_vertex p1 { center - end + side, m_current_color, { +edge_across, -edge_along } };
+        const colored_vertex p2 { center + end - side, m_current_color, { -edge_across, +edge_along } };
+        const colored_vertex p3 { center + end + side, m_current_color, { +edge_across, +edge_along } };
+
+        emit_interpolated_triangle(p0, p1, p2);
+        emit_interpolated_triangle(p3, p2, p1);
+    }
+
+    void drawing_manager::emit_antialiased_line(math::vec2 from, math::vec2 to,
+                                                float antialiasing_level) {
         math::vec direction = from - to;
         math::vec shift = direction
             .perpendicular().normalized();
@@ -84,7 +387,7 @@ namespace gl {
         p1 -= shift, p3 -= shift;
         p0 += shift, p2 += shift;
 
-        draw_triangle(p0, p1, p2), draw_triangle(p3, p1, p2);
+        emit_triangle(p0, p1, p2), emit_triangle(p3, p1, p2);
 
 
         // Draw left half:
@@ -97,11 +400,11 @@ namespace gl {
         p0 += shift * 1.0f; p2 += shift * 1.0f; 
         p1 += shift * 2.0f; p3 += shift * 2.0f;
 
-        draw_interpolated_triangle({ p0,   m_current_color },
+        emit_interpolated_triangle({ p0,   m_current_color },
                                    { p2,   m_current_color },
                                    { p1, desaturated_color });
 
-        draw_interpolated_triangle({ p2,   m_current_color },
+        emit_interpolated_triangle({ p2,   m_current_color },
                                    { p1, desaturated_color },
                                    { p3, desaturated_color });
 
@@ -112,28 +415,447 @@ namespace gl {
         p1 -= shift * 1.0f; p3 -= shift * 1.0f;
         p0 -= shift * 2.0f, p2 -= shift * 2.0f;
         
-        draw_interpolated_triangle({ p1,   m_current_color },
+        emit_interpolated_triangle({ p1,   m_current_color },
                                    { p3,   m_current_color },
                                    { p0, desaturated_color });
 
-        draw_interpolated_triangle({ p3,   m_current_color },
+        emit_interpolated_triangle({ p3,   m_current_color },
                                    { p2, desaturated_color },
                                    { p0, desaturated_color });
         std::swap(m_current_color, desaturated_color);
     }
 
-    static math::vec2 rot(math::vec2 current, float angle) {
-        return { (float) cos(angle) * current.x() - (float) sin(angle) * current.y(),
-                 (float) sin(angle) * current.x() + (float) cos(angle) * current.y() };
+    // ------------------------------ BATCHED PRIMITIVES -----------------------------
+
+    void drawing_manager::draw_triangles(std::span<const math::vec2> vertices) {
+        const call_scope scope = record(recorded_call::DRAW_TRIANGLES, vertices);
+
+        const size_t count = vertices.size() / 3;
+
+        if (m_culling_mode == culling_mode::NONE) {
+            for (size_t i = 0; i < count; ++ i)
+                emit_triangle(vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]);
+
+            m_culling_stats.emitted += count;
+            return;
+        }
+
+        m_batch_x0.resize(3 * count), m_batch_y0.resize(3 * count);
+        for (size_t i = 0; i < 3 * count; ++ i)
+            m_batch_x0[i] = vertices[i].x(), m_batch_y0[i] = vertices[i].y();
+
+        m_batch_visible.resize(count);
+        const size_t visible_count = culling::cull_triangles(m_batch_x0.data(), m_batch_y0.data(),
+                                                             m_batch_visible.data(), count,
+                                                             m_cull_bounds);
+
+        for (size_t i = 0; i < count; ++ i)
+            if (m_batch_visible[i])
+                emit_triangle(vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]);
+
+        m_culling_stats.emitted += visible_count;
+        m_culling_stats.culled  += count - visible_count;
+    }
+
+    void drawing_manager::draw_lines(std::span<const math::vec2> from,
+                                     std::span<const math::vec2> to) {
+        const call_scope scope = record(recorded_call::DRAW_LINES, from, to);
+
+        const size_t count = std::min(from.size(), to.size());
+
+        if (m_culling_mode == culling_mode::NONE) {
+            for (size_t i = 0; i < count; ++ i)
+                emit_line(from[i], to[i]);
+
+            m_culling_stats.emitted += count;
+            return;
+        }
+
+        m_batch_x0.resize(count), m_batch_y0.resize(count);
+        m_batch_x1.resize(count), m_batch_y1.resize(count);
+
+        for (size_t i = 0; i < count; ++ i) {
+            m_batch_x0[i] = from[i].x(), m_batch_y0[i] = from[i].y();
+            m_batch_x1[i] =   to[i].x(), m_batch_y1[i] =   to[i].y();
+        }
+
+        // Same as in clip_line, keep caps intact
+        culling::bounds bounds = m_cull_bounds;
+        bounds.min_x -= m_width, bounds.min_y -= m_width;
+        bounds.max_x += m_width, bounds.max_y += m_width;
+
+        m_batch_visible.resize(count);
+        const size_t visible_count = culling::clip_segments(m_batch_x0.data(), m_batch_y0.data(),
+                                                            m_batch_x1.data(), m_batch_y1.data(),
+                                                            m_batch_visible.data(), count, bounds);
+
+        for (size_t i = 0; i < count; ++ i) {
+            if (!m_batch_visible[i])
+                continue;
+
+            math::vec2 clipped_from { m_batch_x0[i], m_batch_y0[i] };
+            math::vec2 clipped_to   { m_batch_x1[i], m_batch_y1[i] };
+
+            if (is_clipped(m_batch_x0[i], m_batch_y0[i], m_batch_x1[i], m_batch_y1[i], from[i], to[i]))
+                ++ m_culling_stats.clipped;
+
+            emit_line(clipped_from, clipped_to);
+        }
+
+        m_culling_stats.emitted += visible_count;
+        m_culling_stats.culled  += count - visible_count;
+    }
+
+    // ------------------------------------ PLOTS ------------------------------------
+
+    void drawing_manager::draw_plot(std::span<const float> xs, std::span<const float> ys) {
+        const call_scope scope = record(recorded_call::DRAW_PLOT, xs, ys);
+
+        const size_t count = std::min(xs.size(), ys.size());
+        if (count < 2)
+            return;
+
+        m_plot_from.clear(), m_plot_to.clear();
+
+        // Culling is off, so every segment is emitted as it is
+        if (m_culling_mode == culling_mode::NONE) {
+            for (size_t i = 0; i + 1 < count; ++ i) {
+                m_plot_from.push_back({ xs[i],     ys[i]     });
+                m_plot_to  .push_back({ xs[i + 1], ys[i + 1] });
+            }
+
+            draw_lines(m_plot_from, m_plot_to);
+            return;
+        }
+
+        // Only samples inside of visible region (plus one on each side,
+        // so lines leaving it are still drawn) need to be looked at:
+        const float* begin = xs.data(), *end = xs.data() + count;
+
+        const size_t start = (size_t) (std::lower_bound(begin, end, m_cull_bounds.min_x) - begin);
+        const size_t  stop = (size_t) (std::upper_bound(begin, end, m_cull_bounds.max_x) - begin);
+
+        const size_t first = start == 0 ? 0 : start - 1;
+        const size_t  last = std::min(stop, count - 1);
+
+        // Width of one pixel column in world coordinates
+        const float column_width = get_pixel_size().x();
+
+        // Columns are aligned to world's origin, so panning doesn't change them
+        const float x0 = std::floor(m_cull_bounds.min_x / column_width) * column_width;
+        const size_t column_count = !std::isnormal(column_width) ? 0 :
+            (size_t) std::ceil((m_cull_bounds.max_x - x0) / column_width) + 1;
+
+        // Every column emits at most 2 segments, there's nothing to gain,
+        // if there are fewer samples than that, draw them as they are
+        if (column_count == 0 || last - first <= 2 * column_count) {
+
+            for (size_t i = first; i < last; ++ i) {
+                m_plot_from.push_back({ xs[i],     ys[i]     });
+                m_plot_to  .push_back({ xs[i + 1], ys[i + 1] });
+            }
+
+            draw_lines(m_plot_from, m_plot_to);
+            return;
+        }
+
+        m_plot_columns.resize(column_count);
+        decimation::decimate(xs.data(), ys.data(), count, x0, column_width,
+                             m_plot_columns.data(), column_count);
+
+        // ==> Connect envelopes, starting from the sample before the first column:
+
+        const size_t before = (size_t) (std::lower_bound(begin, end, x0) - begin);
+
+        bool has_previous = before != 0;
+        math::vec2 previous { xs[before == 0 ? 0 : before - 1], ys[before == 0 ? 0 : before - 1] };
+
+        for (const decimation::column_envelope& column: m_plot_columns) {
+            if (column.first > column.last)
+                continue;
+
+            const math::vec2 column_first { xs[column.first], ys[column.first] };
+            if (has_previous) {
+                m_plot_from.push_back(previous);
+                m_plot_to  .push_back(column_first);
+            }
+
+            // Every sample in this column lies on this vertical segment,
+            // within a single pixel, it's indistinguishable from them
+            if (column.min_y < column.max_y) {
+                const float x = (xs[column.first] + xs[column.last]) / 2.0f;
+
+                m_plot_from.push_back({ x, column.min_y });
+                m_plot_to  .push_back({ x, column.max_y });
+            }
+
+            previous = { xs[column.last], ys[column.last] };
+            has_previous = true;
+        }
+
+        // Samples after the last column weren't decimated, connect to the next one
+        const size_t after = (size_t) (std::lower_bound(begin, end, x0 + (float) column_count * column_width) - begin);
+        if (has_previous && after < count) {
+            m_plot_from.push_back(previous);
+            m_plot_to  .push_back({ xs[after], ys[after] });
+        }
+
+        draw_lines(m_plot_from, m_plot_to);
+    }
+
+    // ------------------------------------- TEXT ------------------------------------
+
+    void drawing_manager::set_text_batch(text_batch* batch) {
+        m_text_batch = batch;
+    }
+
+    text_batch* drawing_manager::get_text_batch() const { return m_text_batch; }
+
+    void drawing_manager::draw_text(math::vec2 position, std::string_view text, float size,
+                                    math::vec2 anchor) {
+        const call_scope scope = record(recorded_call::DRAW_TEXT, position, text, size, anchor);
+
+        if (m_text_batch == nullptr)
+            throw std::runtime_error("Text batch isn't set!");
+
+        m_text_batch->add(m_axes.get_view_coordinates(position), text, size,
+                          m_current_color, anchor, m_viewport_width, m_viewport_height);
+    }
+
+    // Round step (1, 2 or 5 times a power of ten) that splits /range/ in about /count/ parts
+    static float get_tick_step(float range, size_t count) {
+        const float raw_step = range / (float) count;
+        const float magnitude = std::pow(10.0f, std::floor(std::log10(raw_step)));
+
+        const float normalized = raw_step / magnitude;
+
+        if (normalized < 1.5f) return magnitude;
+        if (normalized < 3.5f) return magnitude * 2.0f;
+        if (normalized < 7.5f) return magnitude * 5.0f;
+
+        return magnitude * 10.0f;
+    }
+
+    void drawing_manager::draw_ticks(size_t target_count, float label_size) {
+        const call_scope scope = record(recorded_call::DRAW_TICKS, target_count, label_size);
+
+        const math::vec2 pixel = get_pixel_size();
+        if (pixel.x() <= 0.0f || pixel.y() <= 0.0f || target_count == 0)
+            return;
+
+        const rectangle& world = m_axes.m_world;
+
+        const float x0 = std::min(world.x0.x(), world.x1.x()), x1 = std::max(world.x0.x(), world.x1.x());
+        const float y0 = std::min(world.x0.y(), world.x1.y()), y1 = std::max(world.x0.y(), world.x1.y());
+
+        constexpr float tick_length = 6.0f, label_gap = 3.0f; // In pixels
+
+        const float saved_width = m_width;
+        char label[32];
+
+        // Calls /draw_tick/ for each round value in [from, to]
+        const auto for_each_tick = [&](float from, float to, auto draw_tick) {
+            const float step = get_tick_step(to - from, target_count);
+            if (!std::isnormal(step))
+                return;
+
+            const float first = std::ceil(from / step), last = std::floor(to / step);
+            if (last < first)
+                return;
+
+            // Counted as an integer, a float index stops growing past 2^24
+            const size_t count = (size_t) (last - first) + 1;
+
+            // Value is computed from its index, so errors don't accumulate
+            for (size_t i = 0; i < count; ++ i) {
+                float value = (float) (((double) first + (double) i) * step);
+                if (std::abs(value) < step * 1e-3f)
+                    value = 0.0f; // Avoid "-0" and "1e-09" at the origin
+
+                std::snprintf(label, sizeof(label), "%g", value);
+                draw_tick(value);
+            }
+        };
+
+        // ==> Bottom edge: ticks go up, labels are centered below them
+
+        set_width(pixel.x());
+        for_each_tick(x0, x1, [&](float x) {
+            draw_line({ x, y0 }, { x, y0 + pixel.y() * tick_length });
+
+            if (m_text_batch != nullptr)
+                draw_text({ x, y0 - pixel.y() * label_gap }, label, label_size, { 0.5f, 0.0f });
+        });
+
+        // ==> Left edge: ticks go right, labels are to the left of them
+
+        set_width(pixel.y());
+        for_each_tick(y0, y1, [&](float y) {
+            draw_line({ x0, y }, { x0 + pixel.x() * tick_length, y });
+
+            if (m_text_batch != nullptr)
+                draw_text({ x0 - pixel.x() * label_gap, y }, label, label_size, { 1.0f, 0.5f });
+        });
+
+        set_width(saved_width);
+    }
+
+    // ---------------------------------- RAW ACCESS ---------------------------------
+
+    std::span<colored_vertex> drawing_manager::allocate(size_t count) {
+        if (m_is_opaque || m_is_plain) {
+            m_is_opaque = m_is_plain = false;
+            mark_state();
+        }
+
+        const size_t first = m_vertices.size();
+        m_vertices.resize(first + count);
+
+        if (m_recorder != nullptr && m_call_depth == 0)
+            m_recorder->record_allocation(m_vertices, first, count);
+
+        return { m_vertices.data() + first, count };
+    }
+
+    size_t drawing_manager::get_vertex_count() const {
+        return m_vertices.size();
+    }
+
+    // ---------------------------------- RECORDING ----------------------------------
+
+    void drawing_manager::set_recorder(command_recorder* recorder) {
+        m_recorder = recorder;
+    }
+
+    template <typename... argument_types>
+    drawing_manager::call_scope drawing_manager::record(recorded_call call,
+                                                        const argument_types&... arguments) {
+        if (m_recorder != nullptr && m_call_depth == 0)
+            m_recorder->record(call, arguments...);
+
+        return call_scope(*this);
     }
 
     void drawing_manager::draw_vector(math::vec2 from, math::vec2 to) {
-        math::vec l = rot(from - to, -0.5f).normalized() * 0.1f;
-        math::vec r = rot(from - to, +0.5f).normalized() * 0.1f;
+        const call_scope scope = record(recorded_call::DRAW_VECTOR, from, to);
 
         draw_antialiased_line(from, to - (to - from).normalized() * 0.04f);
-        draw_triangle(to, to + l, to + r);
 
+        // Same head as before: sides of 0.1 at 0.5 radians from the shaft
+        const float side = 0.1f, angle = 0.5f;
+        emit_arrowhead(to, to - from, side * std::cos(angle), side * std::sin(angle));
+    }
+
+    // ---------------------------------- SDF SHAPES ---------------------------------
+
+    bool drawing_manager::is_shape_visible(culling::bounds box) {
+        if (m_culling_mode != culling_mode::NONE &&
+            (box.max_x < m_cull_bounds.min_x || box.min_x > m_cull_bounds.max_x ||
+             box.max_y < m_cull_bounds.min_y || box.min_y > m_cull_bounds.max_y)) {
+
+            ++ m_culling_stats.culled;
+            return false;
+        }
+
+        ++ m_culling_stats.emitted;
+        return true;
+    }
+
+    void drawing_manager::emit_shape(sdf_shape kind, math::vec3 parameters,
+                                     math::vec2 center, math::vec2 half_x, math::vec2 half_y,
+                                     float local_x, float local_y) {
+
+        const float length_x = half_x.len(), length_y = half_y.len();
+        if (length_x <= 0.0f || length_y <= 0.0f)
+            return;
+
+        // Boundary pixels are only partially covered, give shader room for falloff
+        const math::vec2 pixel = get_pixel_size();
+        const float padding = std::max(pixel.x(), pixel.y());
+
+        const float scale_x = (length_x + padding) / length_x;
+        const float scale_y = (length_y + padding) / length_y;
+
+        half_x *= scale_x, half_y *= scale_y;
+        local_x *= scale_x, local_y *= scale_y;
+
+        const math::vec4 shape { (float) kind, parameters.x(), parameters.y(), parameters.z() };
+
+        const colored_vertex p0 { center - half_x - half_y, m_current_color, { -local_x, -local_y }, shape };
+        const colored_vertex p1 { center + half_x - half_y, m_current_color, { +local_x, -local_y }, shape };
+        const colored_vertex p2 { center - half_x + half_y, m_current_color, { -local_x, +local_y }, shape };
+        const colored_vertex p3 { center + half_x + half_y, m_current_color, { +local_x, +local_y }, shape };
+
+        emit_interpolated_triangle(p0, p1, p2);
+        emit_interpolated_triangle(p3, p2, p1);
+    }
+
+    void drawing_manager::draw_circle(math::vec2 center, float radius) {
+        const call_scope scope = record(recorded_call::DRAW_CIRCLE, center, radius);
+
+        if (!is_shape_visible({ center.x() - radius, center.y() - radius,
+                                center.x() + radius, center.y() + radius }))
+            return;
+
+        emit_shape(sdf_shape::CIRCLE, { radius, 0.0f, 0.0f },
+                   center, { radius, 0.0f }, { 0.0f, radius }, radius, radius);
+    }
+
+    void drawing_manager::draw_ring(math::vec2 center, float radius, float thickness) {
+        const call_scope scope = record(recorded_call::DRAW_RING, center, radius, thickness);
+
+        const float outer = radius + thickness / 2.0f;
+        if (!is_shape_visible({ center.x() - outer, center.y() - outer,
+                                center.x() + outer, center.y() + outer }))
+            return;
+
+        emit_shape(sdf_shape::RING, { radius, thickness / 2.0f, 0.0f },
+                   center, { outer, 0.0f }, { 0.0f, outer }, outer, outer);
+    }
+
+    void drawing_manager::draw_rounded_rect(const math::vec2 x0, const math::vec2 x1, float corner_radius) {
+        const call_scope scope = record(recorded_call::DRAW_ROUNDED_RECT, x0, x1, corner_radius);
+
+        const float min_x = std::min(x0.x(), x1.x()), max_x = std::max(x0.x(), x1.x());
+        const float min_y = std::min(x0.y(), x1.y()), max_y = std::max(x0.y(), x1.y());
+
+        if (!is_shape_visible({ min_x, min_y, max_x, max_y }))
+            return;
+
+        const float half_width = (max_x - min_x) / 2.0f, half_height = (max_y - min_y) / 2.0f;
+        corner_radius = std::clamp(corner_radius, 0.0f, std::min(half_width, half_height));
+
+        emit_shape(sdf_shape::ROUNDED_RECT, { half_width, half_height, corner_radius },
+                   { (min_x + max_x) / 2.0f, (min_y + max_y) / 2.0f },
+                   { half_width, 0.0f }, { 0.0f, half_height }, half_width, half_height);
+    }
+
+    void drawing_manager::emit_arrowhead(math::vec2 tip, math::vec2 direction,
+                                         float length, float half_width) {
+        const float direction_length = direction.len();
+        if (direction_length <= 0.0f)
+            return;
+
+        // Shape's own coordinates: x goes across, y goes from tip to base
+        const math::vec2 back   = direction * (-1.0f / direction_length);
+        const math::vec2 across = back.perpendicular();
+
+        const math::vec2 base = tip + back * length;
+        const math::vec2 left = base + across * half_width, right = base - across * half_width;
+
+        const float xs[3] = { tip.x(), left.x(), right.x() };
+        const float ys[3] = { tip.y(), left.y(), right.y() };
+
+        if (!is_shape_visible({ *std::min_element(xs, xs + 3), *std::min_element(ys, ys + 3),
+                                *std::max_element(xs, xs + 3), *std::max_element(ys, ys + 3) }))
+            return;
+
+        // Quad is centered in the middle of the head, so local y is shifted
+        const math::vec2 center = tip + back * (length / 2.0f);
+
+        emit_shape(sdf_shape::ISOSCELES_TRIANGLE, { half_width, length, 0.0f },
+                   center, across * half_width, back * (length / 2.0f),
+                   half_width, length / 2.0f);
     }
 
 }
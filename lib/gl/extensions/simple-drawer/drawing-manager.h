@@ -2,17 +2,71 @@
 
 #include "axes.h"
 #include "colored-vertex.h"
+#include "command-list.h"
+#include "culling.h"
+#include "decimation.h"
 #include "opengl-setup.h"
 #include "vertex-vector-array.h"
 #include "vec.h"
 
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
 namespace gl {
 
+    class text_batch;
+    class command_recorder;
+
+    enum class recorded_call: uint8_t;
+
+    enum class culling_mode {
+        // Emit everything, as is
+        NONE,
+
+        // Skip (or clip) primitives that are completely off screen, that
+        // doesn't change what's visible and is enabled by default
+        CLIP_SPACE,
+
+        // Also skip primitives entirely outside of current axes' view, lines
+        // are clipped to it (widened by their width). Triangles that cross
+        // its border are kept whole, so they can still be drawn beyond it.
+        VIEW_RECT
+    };
+
+    enum class antialiasing_mode {
+        // Feather triangles with fading alpha around lines (6 triangles per line)
+        FEATHER,
+
+        // Single quad per line, shader computes pixel coverage from distance
+        // to line's edges, which doesn't depend on width or zoom
+        ANALYTIC,
+
+        // Plain quads, e.g. when window is multisampled anyway
+        NONE
+    };
+
+    struct culling_stats final {
+        size_t culled  = 0; // Primitives that weren't emitted at all
+        size_t clipped = 0; // Lines that were shortened to the visible part
+        size_t emitted = 0; // Primitives that were emitted (including clipped)
+    };
+
     class drawing_manager {
     public:
-        // Uses black color by default
-        drawing_manager(gl::vertex_vector_array<colored_vertex>& vertices)
-            : m_vertices(vertices), m_current_color(0.0f, 0.0f, 0.0f, 1.0f) {}
+        // Uses black color by default, any std::vector works as a target
+        // (including gl::vertex_vector_array), so it can be used off GL thread.
+        // Temporaries of batches and plots come from /scratch/ (e.g. a frame
+        // arena, so that drawing a frame doesn't touch the heap).
+        drawing_manager(std::vector<colored_vertex>& vertices,
+                        std::pmr::memory_resource* scratch = std::pmr::get_default_resource())
+            : m_vertices(vertices), m_current_color(0.0f, 0.0f, 0.0f, 1.0f),
+              m_batch_x0(scratch), m_batch_y0(scratch), m_batch_x1(scratch), m_batch_y1(scratch),
+              m_batch_visible(scratch),
+              m_plot_columns(scratch), m_plot_from(scratch), m_plot_to(scratch) {
+            update_cull_bounds();
+        }
 
         // ==> Control current settings:
 
@@ -22,6 +76,61 @@ namespace gl {
         void set_width(float width);
         void set_axes(axes axes);
 
+        float get_width() const;
+        const axes& get_axes() const;
+
+        // Size of the target in pixels, lets plots drop invisible detail,
+        // zero (default) means unknown and nothing is dropped
+        void set_viewport_size(size_t width, size_t height);
+
+        size_t get_viewport_width()  const;
+        size_t get_viewport_height() const;
+
+        // Size of a single pixel in world coordinates of current axes,
+        // zero if viewport size is unknown
+        math::vec2 get_pixel_size() const;
+
+        // Affects only draw_antialiased_line (and shapes drawn with it)
+        void set_antialiasing(antialiasing_mode mode);
+
+        // ==> Draw state (has effect only with a command list):
+
+        // Everything drawn after this is recorded into /commands/ along with
+        // the current draw state, so it can be sorted and drawn in as few
+        // draw calls as there are distinct states (can be null)
+        void set_command_list(command_list* commands);
+        command_list* get_command_list() const;
+
+        void set_layer(uint8_t layer);
+        void set_shader(uint8_t shader); // Index registered in the command list
+        void set_blend(blend_mode blend);
+        void set_texture(uint16_t texture); // Same, zero means no texture
+
+        const draw_state& get_state() const;
+
+        // ==> Drawing order (depth):
+
+        // Every triangle gets the next depth, so later ones are in front even
+        // when opaque ones are reordered. Depth saturates after this many.
+        static constexpr uint32_t max_depth = (1u << 23) - 1;
+
+        // Depth of the last emitted triangle (zero if nothing was emitted)
+        uint32_t get_depth() const;
+
+        // Skips /count/ depths for vertices recorded elsewhere (see allocate),
+        // returns the depth before them, so theirs should be shifted by it
+        uint32_t reserve_depth(uint32_t count);
+
+        // ==> Culling:
+
+        void set_culling(culling_mode mode);
+
+        const culling_stats& get_culling_stats() const;
+        void reset_culling_stats();
+
+        // Region (in world coordinates of current axes) that's not culled
+        culling::bounds get_visible_bounds() const;
+
         // ==> Draw shapes:
 
         void draw_interpolated_triangle(colored_vertex p0, colored_vertex p1, colored_vertex p2);
@@ -34,14 +143,169 @@ namespace gl {
 
         void draw_vector(math::vec2 from, math::vec2 to);
 
+        // ==> Draw SDF shapes (single antialiased quad each, regardless of size):
+
+        void draw_circle(math::vec2 center, float radius);
+
+        // Band of /thickness/ around circle of /radius/
+        void draw_ring(math::vec2 center, float radius, float thickness);
+
+        void draw_rounded_rect(math::vec2 x0, math::vec2 x1, float corner_radius);
+
+        // ==> Draw shapes in batches (culled 8 at a time, when possible):
+
+        // Each consecutive three vertices form a triangle
+        void draw_triangles(std::span<const math::vec2> vertices);
+
+        // Draws lines from[i] -> to[i], spans should be the same size
+        void draw_lines(std::span<const math::vec2> from,
+                        std::span<const math::vec2> to);
+
+        // ==> Draw plots:
+
+        // Polyline through (xs[i], ys[i]), xs should be sorted ascending.
+        // If viewport size is known, samples are reduced to a min/max envelope
+        // per pixel column first, so output is proportional to width in pixels.
+        // With culling_mode::NONE every sample is drawn, without reduction.
+        void draw_plot(std::span<const float> xs, std::span<const float> ys);
+
+        // ==> Draw text (needs a text batch, which is drawn after the geometry):
+
+        // Text isn't recorded into vertices, it goes to /batch/ (can be null)
+        void set_text_batch(text_batch* batch);
+        text_batch* get_text_batch() const;
+
+        // Draws /text/ of /size/ pixels in current color, /anchor/ is the point of
+        // text's box at /position/: (0, 0) is its top left, (1, 1) is bottom right
+        void draw_text(math::vec2 position, std::string_view text, float size,
+                       math::vec2 anchor = { 0.0f, 0.0f });
+
+        // Ticks on the bottom and left edges of current axes with about
+        // /target_count/ round-valued (1, 2 or 5 times a power of ten) steps,
+        // labeled if text batch is set. Needs viewport size.
+        void draw_ticks(size_t target_count = 8, float label_size = 12.0f);
+
+        // ==> Raw access to recorded geometry:
+
+        // Appends /count/ uninitialized vertices and returns them, they are
+        // expected to be already in view coordinates (e.g. recorded elsewhere).
+        // They are always drawn as translucent (in order, with blending).
+        std::span<colored_vertex> allocate(size_t count);
+
+        size_t get_vertex_count() const;
+
+        // ==> Recording (for replay, see command_recorder):
+
+        // Setters and draw calls made after this are written to /recorder/
+        // (can be null), the ones made by other calls (e.g. lines of
+        // draw_ticks) aren't, they'll be made again on replay
+        void set_recorder(command_recorder* recorder);
+
     private:
-        gl::vertex_vector_array<colored_vertex>& m_vertices;
+        std::vector<colored_vertex>& m_vertices;
 
         // ==> Current settings:
         axes m_axes;
 
         math::vec<float, 4> m_current_color;
-        float m_width;
+        float m_width = 0.0f;
+
+        antialiasing_mode m_antialiasing_mode = antialiasing_mode::FEATHER;
+
+        size_t m_viewport_width = 0, m_viewport_height = 0;
+
+        text_batch* m_text_batch = nullptr;
+
+        command_list* m_command_list = nullptr;
+        draw_state m_state;
+
+        uint32_t m_depth = 0;
+        bool m_is_opaque = false; // Whether current range is opaque
+        bool m_is_plain = false;  // Whether it has no edges and shapes
+
+        // Tells command list that following vertices use current state
+        void mark_state();
+
+        // Starts a new range if triangle's opacity (or whether it's plain)
+        // differs from current one
+        void mark_opacity(const colored_vertex& p0, const colored_vertex& p1,
+                          const colored_vertex& p2);
+
+        // ==> Culling state:
+
+        culling_mode m_culling_mode = culling_mode::CLIP_SPACE;
+
+        // Visible region in world coordinates of current axes
+        culling::bounds m_cull_bounds;
+
+        culling_stats m_culling_stats;
+
+        // SoA copies of batched primitives, reused between batches
+        std::pmr::vector<float> m_batch_x0, m_batch_y0, m_batch_x1, m_batch_y1;
+        std::pmr::vector<uint8_t> m_batch_visible;
+
+        // Plot scratch, reused between plots
+        std::pmr::vector<decimation::column_envelope> m_plot_columns;
+        std::pmr::vector<math::vec2> m_plot_from, m_plot_to;
+
+        void update_cull_bounds();
+
+        // ==> Recording state:
+
+        command_recorder* m_recorder = nullptr;
+        size_t m_call_depth = 0; // Public calls that are in progress
+
+        // Marks a public call as in progress while it lives
+        class call_scope final {
+        public:
+            explicit call_scope(drawing_manager& owner): m_owner(owner) { ++ m_owner.m_call_depth; }
+            ~call_scope() { -- m_owner.m_call_depth; }
+
+            call_scope(const call_scope&) = delete;
+            call_scope& operator=(const call_scope&) = delete;
+
+        private:
+            drawing_manager& m_owner;
+        };
+
+        // Records the call if it's the outermost one
+        template <typename... argument_types>
+        call_scope record(recorded_call call, const argument_types&... arguments);
+
+        // Clips line (extended by its width) to visible region, returns
+        // false if nothing is left of it, updates culling statistics
+        bool clip_line(math::vec2& from, math::vec2& to);
+
+        // ==> Tessellation (without culling):
+
+        void emit_interpolated_triangle(colored_vertex p0, colored_vertex p1, colored_vertex p2);
+        void emit_triangle(math::vec2 p0, math::vec2 p1, math::vec2 p2);
+
+        void emit_line(math::vec2 from, math::vec2 to);
+        void emit_antialiased_line(math::vec2 from, math::vec2 to,
+                                   float antialiasing_level);
+
+        void emit_analytic_line(math::vec2 from, math::vec2 to);
+
+        // ==> SDF shapes:
+
+        enum class sdf_shape {
+            // Values are shared with fragment shader
+            NONE = 0, CIRCLE = 1, RING = 2, ROUNDED_RECT = 3, ISOSCELES_TRIANGLE = 4
+        };
+
+        // Culls shape by its bounding box, updates culling statistics
+        bool is_shape_visible(culling::bounds box);
+
+        // Emits quad center +- half_x +- half_y (world vectors), where shape's own
+        // coordinates are (+-local_x, +-local_y), padded by a pixel for falloff
+        void emit_shape(sdf_shape kind, math::vec3 parameters,
+                        math::vec2 center, math::vec2 half_x, math::vec2 half_y,
+                        float local_x, float local_y);
+
+        // Tip at /tip/, base is /length/ back along /direction/ and 2 * half_width wide
+        void emit_arrowhead(math::vec2 tip, math::vec2 direction,
+                            float length, float half_width);
     };
 
 }
@@ -0,0 +1,122 @@
+#include "frame-pipeline.h"
+
+#include <stdexcept>
+
+namespace gl {
+
+    frame_pipeline::frame_pipeline(size_t frames_in_flight, producer_function produce)
+        : m_frames_in_flight(frames_in_flight), m_produce(std::move(produce)),
+          m_slots(frames_in_flight) {
+
+        if (frames_in_flight < 2)
+            throw std::invalid_argument("Pipelining needs at least 2 frames in flight!");
+
+        for (size_t i = 0; i < frames_in_flight; ++ i)
+            m_free_slots.push_back(i);
+    }
+
+    size_t frame_pipeline::get_frames_in_flight() const {
+        return m_frames_in_flight;
+    }
+
+    void frame_pipeline::start() {
+        if (m_producer.joinable())
+            return;
+
+        m_stopping = false;
+        m_producer = std::thread(&frame_pipeline::produce_loop, this);
+    }
+
+    void frame_pipeline::stop() {
+        if (!m_producer.joinable())
+            return;
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_slots_changed.notify_all();
+        m_producer.join();
+    }
+
+    void frame_pipeline::set_inputs(const frame_inputs& inputs) {
+        std::lock_guard lock(m_mutex);
+        m_inputs = inputs;
+    }
+
+    void frame_pipeline::produce_loop() {
+        while (true) {
+            size_t slot = 0;
+            frame_inputs inputs;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_slots_changed.wait(lock, [&] {
+                    return m_stopping || !m_free_slots.empty();
+                });
+
+                if (m_stopping)
+                    return;
+
+                slot = m_free_slots.front();
+                m_free_slots.pop_front();
+
+                inputs = m_inputs;
+            }
+
+            try {
+                m_slots[slot].clear();
+                m_produce(slot, m_slots[slot], inputs);
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+                m_exception = std::current_exception();
+                m_stopping = true;
+
+                m_slots_changed.notify_all();
+                return;
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_ready_slots.push_back(slot);
+            }
+
+            m_slots_changed.notify_all();
+        }
+    }
+
+    size_t frame_pipeline::acquire_frame() {
+        std::unique_lock lock(m_mutex);
+        m_slots_changed.wait(lock, [&] {
+            return m_exception || !m_ready_slots.empty();
+        });
+
+        if (m_exception)
+            std::rethrow_exception(m_exception);
+
+        const size_t slot = m_ready_slots.front();
+        m_ready_slots.pop_front();
+
+        return slot;
+    }
+
+    std::span<const colored_vertex> frame_pipeline::get_vertices(size_t slot) const {
+        // Acquired slot belongs to GL thread until it's released
+        return m_slots[slot];
+    }
+
+    void frame_pipeline::release_frame(size_t slot) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_free_slots.push_back(slot);
+        }
+
+        m_slots_changed.notify_all();
+    }
+
+    frame_pipeline::~frame_pipeline() {
+        stop();
+    }
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "colored-vertex.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace gl {
+
+    // Overlaps CPU tessellation with GPU execution: worker thread produces
+    // geometry for upcoming frames, while GL thread submits already produced
+    // ones. Up to /frames_in_flight/ frames can be in the pipeline, which is
+    // also the added latency (in frames) of everything on the screen.
+    //
+    // Frames are kept in slots, and producer is told which one it fills,
+    // so per-frame data of its own (e.g. command marks) can go along.
+    class frame_pipeline {
+    public:
+        // Everything producer needs from GL thread, copied when producer
+        // starts a frame, so it never reads state that GL thread changes
+        struct frame_inputs final {
+            size_t viewport_width = 0, viewport_height = 0;
+        };
+
+        using producer_function = std::function<void(size_t slot, std::vector<colored_vertex>&,
+                                                     const frame_inputs& inputs)>;
+
+        frame_pipeline(size_t frames_in_flight, producer_function produce);
+
+        // This class shouldn't be copied or moved
+        frame_pipeline(const frame_pipeline&) = delete;
+        frame_pipeline& operator=(const frame_pipeline&) = delete;
+
+        void start();
+        void stop();
+
+        // Called on GL thread (e.g. before every acquire_frame), frames
+        // that producer starts from now on are made with /inputs/
+        void set_inputs(const frame_inputs& inputs);
+
+        size_t get_frames_in_flight() const;
+
+        // ==> Called on GL thread, in pairs:
+
+        // Waits for next produced frame, returns its slot
+        size_t acquire_frame();
+
+        // Vertices of an acquired frame
+        std::span<const colored_vertex> get_vertices(size_t slot) const;
+
+        // Gives slot back to producer, should be called right after frame
+        // is submitted (once its vertices are copied to GL)
+        void release_frame(size_t slot);
+
+        ~frame_pipeline();
+
+    private:
+        const size_t m_frames_in_flight;
+        producer_function m_produce;
+
+        // ==> CPU side (shared with producer):
+
+        std::vector<std::vector<colored_vertex>> m_slots;
+        std::deque<size_t> m_free_slots, m_ready_slots;
+
+        std::mutex m_mutex;
+        std::condition_variable m_slots_changed;
+
+        frame_inputs m_inputs;
+
+        bool m_stopping = false;
+        std::exception_ptr m_exception;
+
+        std::thread m_producer;
+
+        void produce_loop();
+    };
+
+}
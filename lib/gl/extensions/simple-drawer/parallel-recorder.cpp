@@ -0,0 +1,95 @@
+#include "parallel-recorder.h"
+
+#include <algorithm>
+
+namespace gl {
+
+    void parallel_recorder::add_panel(axes panel_axes, panel_function draw) {
+        m_panels.push_back({ panel_axes, std::move(draw), {}, {} });
+    }
+
+    void parallel_recorder::clear_panels() {
+        m_panels.clear();
+        m_ranges.clear();
+    }
+
+    size_t parallel_recorder::get_panel_count() const {
+        return m_panels.size();
+    }
+
+    void parallel_recorder::record(drawing_manager& mgr) {
+        // ==> Tessellate every panel independently:
+
+        m_pool.parallel_for(m_panels.size(), [this, &mgr](size_t i) {
+            panel& current = m_panels[i];
+            current.arena.clear();
+
+            drawing_manager panel_mgr { current.arena };
+            panel_mgr.set_axes(current.panel_axes);
+            panel_mgr.set_viewport_size(mgr.get_viewport_width(),
+                                        mgr.get_viewport_height());
+
+            current.draw(panel_mgr);
+            current.stats = panel_mgr.get_culling_stats();
+            current.depth_count = panel_mgr.get_depth();
+        });
+
+        // ==> Lay out arenas in panel order:
+
+        m_ranges.clear();
+
+        // Ranges are relative to the whole target, not just the appended part
+        const size_t base = mgr.get_vertex_count();
+
+        size_t total_count = 0;
+        for (const panel& current: m_panels) {
+            m_ranges.push_back({ base + total_count, current.arena.size() });
+            total_count += current.arena.size();
+        }
+
+        std::span<colored_vertex> target = mgr.allocate(total_count);
+
+        // Panels are drawn after everything that's already in the target,
+        // and each one after the previous ones
+        uint32_t total_depth = 0;
+        for (const panel& current: m_panels)
+            total_depth += current.depth_count;
+
+        uint32_t depth_shift = mgr.reserve_depth(total_depth);
+        for (panel& current: m_panels) {
+            current.depth_shift = depth_shift;
+            depth_shift += current.depth_count;
+        }
+
+        // ==> Concatenate (copying is parallel too, it's memory bound):
+
+        m_pool.parallel_for(m_panels.size(), [&](size_t i) {
+            const std::vector<colored_vertex>& arena = m_panels[i].arena;
+            const float depth_shift = (float) m_panels[i].depth_shift;
+
+            std::transform(arena.begin(), arena.end(),
+                           target.begin() + (long) (m_ranges[i].first - base),
+                           [depth_shift](colored_vertex vertex) {
+                               vertex.depth = std::min(vertex.depth + depth_shift,
+                                                       (float) drawing_manager::max_depth);
+                               return vertex;
+                           });
+        });
+    }
+
+    std::span<const parallel_recorder::panel_range> parallel_recorder::get_ranges() const {
+        return m_ranges;
+    }
+
+    culling_stats parallel_recorder::get_culling_stats() const {
+        culling_stats total;
+        for (const panel& current: m_panels) {
+            total.culled  += current.stats.culled;
+            total.clipped += current.stats.clipped;
+            total.emitted += current.stats.emitted;
+        }
+
+        return total;
+    }
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "axes.h"
+#include "colored-vertex.h"
+#include "drawing-manager.h"
+#include "thread-pool.h"
+
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    // Records independent panels concurrently: every panel is tessellated by
+    // its own drawing_manager into its own vertex arena, arenas are then
+    // concatenated in the order panels were added, so result doesn't depend
+    // on scheduling and is identical to sequential recording.
+    class parallel_recorder {
+    public:
+        using panel_function = std::function<void(drawing_manager&)>;
+
+        struct panel_range final {
+            size_t first, count;
+        };
+
+        parallel_recorder(thread_pool& pool = thread_pool::global())
+            : m_pool(pool) {}
+
+        // Panel functions are called from worker threads, they must not touch
+        // GL and should only read state that isn't modified during recording.
+        // Text can't be drawn from them (panel managers have no text batch).
+        void add_panel(axes panel_axes, panel_function draw);
+        void clear_panels();
+
+        size_t get_panel_count() const;
+
+        // ==> Recording:
+
+        // Tessellates all panels and appends their geometry to /mgr/
+        void record(drawing_manager& mgr);
+
+        // Where each panel ended up in the last recorded target, can be used
+        // to upload or draw panels as separate sub-ranges
+        std::span<const panel_range> get_ranges() const;
+
+        // Culling statistics of all panels from the last recording
+        culling_stats get_culling_stats() const;
+
+    private:
+        struct panel final {
+            axes panel_axes;
+            panel_function draw;
+
+            // Kept between frames to reuse allocated capacity
+            std::vector<colored_vertex> arena;
+
+            culling_stats stats;
+
+            uint32_t depth_count = 0; // Depths used by panel's own manager
+            uint32_t depth_shift = 0; // Where they start in the target
+        };
+
+        thread_pool& m_pool;
+
+        std::vector<panel> m_panels;
+        std::vector<panel_range> m_ranges;
+    };
+
+}
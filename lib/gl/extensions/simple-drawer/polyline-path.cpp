@@ -0,0 +1,278 @@
+#include "polyline-path.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace gl {
+
+    polyline_path::polyline_path(std::span<const math::vec2> points) {
+        if (points.size() > std::numeric_limits<uint32_t>::max())
+            throw std::invalid_argument("polyline_path: too many points");
+
+        m_xs.reserve(points.size()), m_ys.reserve(points.size());
+        for (const math::vec2& point: points)
+            m_xs.push_back(point.x()), m_ys.push_back(point.y());
+
+        std::vector<float> importance;
+        compute_importance(importance);
+
+        build_levels(importance);
+        build_blocks();
+    }
+
+    // ---------------------------------- HIERARCHY ----------------------------------
+
+    void polyline_path::compute_importance(std::vector<float>& importance) const {
+        const uint32_t count = (uint32_t) m_xs.size();
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+
+        // Endpoints are never dropped
+        importance.assign(count, infinity);
+        if (count < 3)
+            return;
+
+        // Points that are still there form a doubly linked list
+        std::vector<uint32_t> previous(count), next(count);
+        for (uint32_t i = 0; i < count; ++ i)
+            previous[i] = i - 1, next[i] = i + 1;
+
+        auto triangle_area = [&](uint32_t i) {
+            const uint32_t a = previous[i], b = next[i];
+
+            return std::abs((m_xs[a] - m_xs[i]) * (m_ys[b] - m_ys[i]) -
+                            (m_xs[b] - m_xs[i]) * (m_ys[a] - m_ys[i])) / 2.0f;
+        };
+
+        std::vector<float> area(count, infinity);
+        for (uint32_t i = 1; i + 1 < count; ++ i)
+            area[i] = triangle_area(i);
+
+        // Binary min-heap of interior points by area, that knows where each
+        // point is, so that neighbours can be updated in place
+        std::vector<uint32_t> heap, position(count);
+        for (uint32_t i = 1; i + 1 < count; ++ i)
+            position[i] = (uint32_t) heap.size(), heap.push_back(i);
+
+        auto place = [&](size_t at, uint32_t point) {
+            heap[at] = point, position[point] = (uint32_t) at;
+        };
+
+        auto sift_up = [&](size_t at) {
+            const uint32_t point = heap[at];
+            for (; at > 0 && area[heap[(at - 1) / 2]] > area[point]; at = (at - 1) / 2)
+                place(at, heap[(at - 1) / 2]);
+
+            place(at, point);
+        };
+
+        auto sift_down = [&](size_t at) {
+            const uint32_t point = heap[at];
+            for (size_t child; (child = 2 * at + 1) < heap.size(); at = child) {
+                if (child + 1 < heap.size() && area[heap[child + 1]] < area[heap[child]])
+                    ++ child;
+
+                if (area[heap[child]] >= area[point])
+                    break;
+
+                place(at, heap[child]);
+            }
+
+            place(at, point);
+        };
+
+        for (size_t i = heap.size() / 2; i -- > 0; )
+            sift_down(i);
+
+        auto update = [&](uint32_t point) {
+            area[point] = triangle_area(point);
+            sift_up(position[point]), sift_down(position[point]);
+        };
+
+        // Removing a point can make its neighbours' triangles smaller than
+        // ones already removed, clamp them, so that importance is monotonic
+        // and dropping everything below a threshold is a valid simplification
+        float largest_removed = 0.0f;
+
+        while (!heap.empty()) {
+            const uint32_t i = heap.front();
+
+            place(0, heap.back()), heap.pop_back();
+            if (!heap.empty())
+                sift_down(0);
+
+            largest_removed = std::max(largest_removed, area[i]);
+            importance[i] = largest_removed;
+
+            const uint32_t a = previous[i], b = next[i];
+            next[a] = b, previous[b] = a;
+
+            if (a != 0)         update(a);
+            if (b != count - 1) update(b);
+        }
+    }
+
+    void polyline_path::build_levels(const std::vector<float>& importance) {
+        const size_t count = importance.size();
+
+        // Level zero is the original polyline
+        m_level_offsets = { 0, count };
+        m_level_thresholds = { 0.0f };
+
+        m_indices.resize(count);
+        for (size_t i = 0; i < count; ++ i)
+            m_indices[i] = (uint32_t) i;
+
+        std::vector<float> sorted = importance;
+        std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+
+        // Each next level keeps (about) half of points, so all of them
+        // together take at most twice as much space as the original
+        for (size_t target = count / 2; target > 2; target /= 2) {
+            const float threshold = sorted[target - 1];
+
+            const size_t previous_size = m_level_offsets.back() - m_level_offsets[m_level_offsets.size() - 2];
+            const size_t kept = (size_t) std::count_if(importance.begin(), importance.end(),
+                                                       [&](float value) { return value >= threshold; });
+
+            if (kept >= previous_size)
+                continue; // Equal importances, nothing to gain
+
+            for (size_t i = 0; i < count; ++ i)
+                if (importance[i] >= threshold)
+                    m_indices.push_back((uint32_t) i);
+
+            m_level_offsets.push_back(m_indices.size());
+            m_level_thresholds.push_back(threshold);
+        }
+    }
+
+    void polyline_path::build_blocks() {
+        m_block_tree.assign(1, {});
+
+        for (size_t first = 0; first < m_indices.size(); first += block_size) {
+            // Block includes the point its last segment ends at
+            const size_t last = std::min(first + block_size, m_indices.size() - 1);
+
+            culling::bounds box = {
+                m_xs[m_indices[first]], m_ys[m_indices[first]],
+                m_xs[m_indices[first]], m_ys[m_indices[first]]
+            };
+
+            for (size_t i = first + 1; i <= last; ++ i) {
+                const float x = m_xs[m_indices[i]], y = m_ys[m_indices[i]];
+
+                box.min_x = std::min(box.min_x, x), box.max_x = std::max(box.max_x, x);
+                box.min_y = std::min(box.min_y, y), box.max_y = std::max(box.max_y, y);
+            }
+
+            m_block_tree[0].push_back(box);
+        }
+
+        while (m_block_tree.back().size() > 1) {
+            const std::vector<culling::bounds>& below = m_block_tree.back();
+
+            std::vector<culling::bounds> above;
+            for (size_t i = 0; i < below.size(); i += 2) {
+                culling::bounds box = below[i];
+
+                if (i + 1 < below.size()) {
+                    const culling::bounds& right = below[i + 1];
+
+                    box.min_x = std::min(box.min_x, right.min_x), box.max_x = std::max(box.max_x, right.max_x);
+                    box.min_y = std::min(box.min_y, right.min_y), box.max_y = std::max(box.max_y, right.max_y);
+                }
+
+                above.push_back(box);
+            }
+
+            m_block_tree.push_back(std::move(above));
+        }
+    }
+
+    // ------------------------------------ DRAWING ----------------------------------
+
+    size_t polyline_path::select_level(const drawing_manager& mgr, float tolerance) const {
+        const math::vec2 pixel = mgr.get_pixel_size();
+
+        // Importance is an area in world coordinates
+        const float threshold = tolerance * pixel.x() * pixel.y();
+
+        size_t level = 0;
+        while (level + 1 < m_level_thresholds.size() && m_level_thresholds[level + 1] <= threshold)
+            ++ level;
+
+        return level;
+    }
+
+    size_t polyline_path::draw(drawing_manager& mgr, float tolerance) {
+        if (m_xs.size() < 2)
+            return 0;
+
+        const size_t level = select_level(mgr, tolerance);
+        const size_t begin = m_level_offsets[level], end = m_level_offsets[level + 1];
+
+        // Caps go beyond segments, same as in drawing_manager
+        culling::bounds visible = mgr.get_visible_bounds();
+        visible.min_x -= mgr.get_width(), visible.min_y -= mgr.get_width();
+        visible.max_x += mgr.get_width(), visible.max_y += mgr.get_width();
+
+        m_from.clear(), m_to.clear();
+
+        // Only nodes that are visible and overlap the level are visited, so
+        // cost follows the output, not the size of the level
+        const size_t root = m_block_tree.size() - 1;
+        for (size_t node = 0; node < m_block_tree[root].size(); ++ node)
+            collect_visible(root, node, begin, end, visible);
+
+        mgr.draw_lines(m_from, m_to);
+        return m_from.size();
+    }
+
+    void polyline_path::collect_visible(size_t depth, size_t node, size_t begin, size_t end,
+                                        const culling::bounds& visible) {
+
+        // Node covers blocks [node << depth, (node + 1) << depth), block i has
+        // segments starting at [i * block_size, (i + 1) * block_size)
+        const size_t first_segment = (node << depth) * block_size;
+        const size_t  last_segment = ((node + 1) << depth) * block_size;
+
+        if (last_segment <= begin || first_segment >= end - 1)
+            return;
+
+        const culling::bounds& box = m_block_tree[depth][node];
+        if (box.max_x < visible.min_x || box.min_x > visible.max_x ||
+            box.max_y < visible.min_y || box.min_y > visible.max_y)
+            return;
+
+        if (depth != 0) {
+            const size_t children_end = std::min(2 * node + 2, m_block_tree[depth - 1].size());
+            for (size_t child = 2 * node; child < children_end; ++ child)
+                collect_visible(depth - 1, child, begin, end, visible);
+
+            return;
+        }
+
+        // Blocks don't follow levels, so first and last ones are partial
+        const size_t first = std::max(begin, first_segment);
+        const size_t  last = std::min(end - 1, last_segment);
+
+        for (size_t i = first; i < last; ++ i) {
+            const uint32_t from = m_indices[i], to = m_indices[i + 1];
+
+            m_from.push_back({ m_xs[from], m_ys[from] });
+            m_to  .push_back({ m_xs[to],   m_ys[to]   });
+        }
+    }
+
+    size_t polyline_path::size() const { return m_xs.size(); }
+
+    size_t polyline_path::get_level_count() const { return m_level_thresholds.size(); }
+
+    size_t polyline_path::get_level_size(size_t level) const {
+        return m_level_offsets[level + 1] - m_level_offsets[level];
+    }
+
+}
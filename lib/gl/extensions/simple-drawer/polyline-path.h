@@ -0,0 +1,70 @@
+#pragma once
+
+#include "culling.h"
+#include "drawing-manager.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    // Long polyline (tracks, contours) with a precomputed simplification
+    // hierarchy. Every point gets its Visvalingam-Whyatt importance (area of
+    // the triangle it formed when removed), then levels keep roughly half of
+    // points of the previous one each. Drawing picks the coarsest level whose
+    // dropped points are all smaller than a pixel, so output follows the
+    // number of pixels on screen, not the number of input points.
+    class polyline_path {
+    public:
+        explicit polyline_path(std::span<const math::vec2> points);
+
+        // Draws with mgr's current color and width, /tolerance/ is the largest
+        // area (in square pixels) of detail that can be dropped. Only parts
+        // intersecting visible region are submitted, returns segment count.
+        size_t draw(drawing_manager& mgr, float tolerance = 0.5f);
+
+        // Finest level (zero) keeps every point, it is used if mgr's viewport
+        // size is unknown
+        size_t select_level(const drawing_manager& mgr, float tolerance = 0.5f) const;
+
+        size_t size() const;
+
+        size_t get_level_count() const;
+        size_t get_level_size(size_t level) const;
+
+    private:
+        // Segments of a level are culled in blocks of that many
+        static constexpr size_t block_size = 64;
+
+        std::vector<float> m_xs, m_ys;
+
+        // All levels back to back: level k is [m_level_offsets[k], m_level_offsets[k + 1])
+        std::vector<uint32_t> m_indices;
+        std::vector<size_t> m_level_offsets;
+
+        // Smallest importance of a point that is kept by the level
+        std::vector<float> m_level_thresholds;
+
+        // Level zero has bounds of points at [i * block_size, (i + 1) * block_size]
+        // in m_indices, each next one bounds of pairs of nodes below, up to the
+        // root, so drawing skips whole invisible runs of blocks at once
+        std::vector<std::vector<culling::bounds>> m_block_tree;
+
+        // Submitted segments, reused between calls
+        std::vector<math::vec2> m_from, m_to;
+
+        void compute_importance(std::vector<float>& importance) const;
+
+        void build_levels(const std::vector<float>& importance);
+        void build_blocks();
+
+        // Submits segments of [begin, end) in m_indices that are in visible
+        // blocks under /node/ of tree's level /depth/
+        void collect_visible(size_t depth, size_t node, size_t begin, size_t end,
+                             const culling::bounds& visible);
+    };
+
+}
@@ -0,0 +1,337 @@
+#include "retained-scene.h"
+#include "opengl-wrapper.h"
+#include "vec-layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gl {
+
+    // Vertices of small scenes fit in one block, so order is kept
+    static constexpr size_t pool_block_capacity = 1 << 14;
+
+    // Holes left by removed primitives are packed once they're
+    // most of the free space (so new primitives may not fit them)
+    static constexpr double max_fragmentation = 0.5;
+
+    retained_scene::retained_scene(culling::bounds world): m_index(world) {}
+
+    // ---------------------------------- MODIFICATION ---------------------------------
+
+    retained_scene::primitive_id retained_scene::add(primitive new_primitive) {
+        new_primitive.order = m_next_order ++;
+
+        primitive_id id = (primitive_id) m_primitives.size();
+        if (!m_free_ids.empty()) {
+            id = m_free_ids.back();
+            m_free_ids.pop_back();
+
+            m_primitives[id] = new_primitive;
+        } else
+            m_primitives.push_back(new_primitive);
+
+        m_index.insert(id, get_bounds(new_primitive));
+        return id;
+    }
+
+    retained_scene::primitive_id retained_scene::add_triangle(math::vec2 p0, math::vec2 p1,
+                                                              math::vec2 p2, math::vec4 color) {
+        return add({
+            primitive_kind::TRIANGLE,
+            { p0.x(), p1.x(), p2.x() }, { p0.y(), p1.y(), p2.y() },
+            { color.r(), color.g(), color.b(), color.a() }, 0.0f, true, 0
+        });
+    }
+
+    retained_scene::primitive_id retained_scene::add_line(math::vec2 from, math::vec2 to,
+                                                          math::vec4 color, float width) {
+        return add({
+            primitive_kind::LINE,
+            { from.x(), to.x(), 0.0f }, { from.y(), to.y(), 0.0f },
+            { color.r(), color.g(), color.b(), color.a() }, width, true, 0
+        });
+    }
+
+    retained_scene::primitive_id retained_scene::add_vector(math::vec2 from, math::vec2 to,
+                                                            math::vec4 color, float width) {
+        primitive_id id = add_line(from, to, color, width);
+        m_primitives[id].kind = primitive_kind::VECTOR;
+
+        // Arrow head is wider than the line itself
+        m_index.update(id, get_bounds(m_primitives[id]));
+        return id;
+    }
+
+    void retained_scene::move_triangle(primitive_id id, math::vec2 p0, math::vec2 p1, math::vec2 p2) {
+        primitive& shape = m_primitives.at(id);
+        if (shape.kind != primitive_kind::TRIANGLE)
+            throw std::invalid_argument("Primitive is not a triangle!");
+
+        shape.xs[0] = p0.x(), shape.xs[1] = p1.x(), shape.xs[2] = p2.x();
+        shape.ys[0] = p0.y(), shape.ys[1] = p1.y(), shape.ys[2] = p2.y();
+
+        m_index.update(id, get_bounds(shape));
+        shape.is_tessellated = false;
+    }
+
+    void retained_scene::move_line(primitive_id id, math::vec2 from, math::vec2 to) {
+        primitive& shape = m_primitives.at(id);
+        if (shape.kind == primitive_kind::TRIANGLE)
+            throw std::invalid_argument("Primitive is not a line!");
+
+        shape.xs[0] = from.x(), shape.xs[1] = to.x();
+        shape.ys[0] = from.y(), shape.ys[1] = to.y();
+
+        m_index.update(id, get_bounds(shape));
+        shape.is_tessellated = false;
+    }
+
+    void retained_scene::remove(primitive_id id) {
+        primitive& shape = m_primitives.at(id);
+        if (!shape.is_alive)
+            throw std::invalid_argument("Primitive was already removed!");
+
+        m_index.remove(id);
+        free_vertices(shape);
+
+        shape.is_alive = false;
+        m_free_ids.push_back(id);
+    }
+
+    void retained_scene::clear() {
+        for (primitive& shape: m_primitives)
+            free_vertices(shape);
+
+        m_primitives.clear();
+        m_free_ids.clear();
+        m_next_order = 0;
+
+        m_index.clear();
+    }
+
+    size_t retained_scene::size() const {
+        return m_index.size();
+    }
+
+    culling::bounds retained_scene::get_bounds(const primitive& shape) {
+        const size_t points = shape.kind == primitive_kind::TRIANGLE? 3 : 2;
+
+        culling::bounds box = { shape.xs[0], shape.ys[0], shape.xs[0], shape.ys[0] };
+        for (size_t i = 1; i < points; ++ i) {
+            box.min_x = std::min(box.min_x, shape.xs[i]), box.max_x = std::max(box.max_x, shape.xs[i]);
+            box.min_y = std::min(box.min_y, shape.ys[i]), box.max_y = std::max(box.max_y, shape.ys[i]);
+        }
+
+        // Width of the line, its caps and (for vectors) the arrow head,
+        // which is drawn 0.1 units long, see drawing_manager::draw_vector
+        float margin = shape.width;
+        if (shape.kind == primitive_kind::VECTOR)
+            margin = std::max(margin, 0.1f);
+
+        box.min_x -= margin, box.min_y -= margin;
+        box.max_x += margin, box.max_y += margin;
+
+        return box;
+    }
+
+    // -------------------------------- DRAWING & PICKING -------------------------------
+
+    size_t retained_scene::draw(drawing_manager& mgr) {
+        m_found.clear();
+        m_index.query(mgr.get_visible_bounds(), m_found);
+
+        // Keep painter's order the same as insertion order (ids are reused)
+        std::ranges::sort(m_found, {}, [this](primitive_id id) { return m_primitives[id].order; });
+
+        for (primitive_id id: m_found)
+            emit(mgr, m_primitives[id]);
+
+        return m_found.size();
+    }
+
+    void retained_scene::emit(drawing_manager& mgr, const primitive& shape) {
+        mgr.set_color({ shape.color[0], shape.color[1], shape.color[2] });
+        mgr.set_alpha(shape.color[3]);
+
+        const math::vec2 p0 { shape.xs[0], shape.ys[0] }, p1 { shape.xs[1], shape.ys[1] };
+
+        switch (shape.kind) {
+        case primitive_kind::TRIANGLE:
+            mgr.draw_triangle(p0, p1, { shape.xs[2], shape.ys[2] });
+            break;
+
+        case primitive_kind::LINE:
+            mgr.set_width(shape.width);
+            mgr.draw_line(p0, p1);
+            break;
+
+        case primitive_kind::VECTOR:
+            mgr.set_width(shape.width);
+            mgr.draw_vector(p0, p1);
+            break;
+
+        default: break;
+        }
+    }
+
+    // ------------------------------------ GPU DRAWING ----------------------------------
+
+    static gl::vertex_layout get_vertex_layout() {
+        return math::vector_layout<float, 2>() +
+               math::vector_layout<float, 4>() +
+               math::vector_layout<float, 1>() +
+               math::vector_layout<float, 2>() +
+               math::vector_layout<float, 4>();
+    }
+
+    void retained_scene::free_vertices(primitive& shape) {
+        if (!shape.has_vertices)
+            return;
+
+        m_pool->free(shape.vertices);
+
+        shape.has_vertices = false;
+        m_has_freed = true;
+    }
+
+    void retained_scene::tessellate(primitive& shape) {
+        m_tessellated.clear();
+
+        // Default axes keep world coordinates as they are, and nothing is
+        // culled, view can change without tessellating primitives again
+        drawing_manager mgr { m_tessellated };
+        mgr.set_culling(culling_mode::NONE);
+
+        emit(mgr, shape);
+        shape.is_tessellated = true;
+
+        // Moved lines and triangles keep their vertex count, so they're
+        // usually overwritten in place
+        if (shape.has_vertices && m_pool->get_range(shape.vertices).count == m_tessellated.size()) {
+            m_pool->update(shape.vertices, { m_tessellated.data(), m_tessellated.size() * sizeof(colored_vertex) });
+            return;
+        }
+
+        free_vertices(shape);
+
+        if (!m_tessellated.empty()) {
+            shape.vertices = m_pool->add(std::span<const colored_vertex>(m_tessellated));
+            shape.has_vertices = true;
+        }
+    }
+
+    size_t retained_scene::draw_gpu(const axes& target) {
+        if (m_pool == nullptr) {
+            m_pool = std::make_unique<buffer_pool>(get_vertex_layout(), pool_block_capacity);
+            m_shader = std::make_unique<shaders::shader_program>("res/gradient.glsl");
+        }
+
+        if (m_has_freed && m_pool->get_fragmentation() > max_fragmentation)
+            m_pool->defragment();
+
+        m_has_freed = false;
+
+        // View (all of clip space) in world coordinates
+        const math::vec2 first  = target.get_world_coordinates({ -1.0f, -1.0f });
+        const math::vec2 second = target.get_world_coordinates({ +1.0f, +1.0f });
+
+        m_found.clear();
+        m_index.query({
+            std::min(first.x(), second.x()), std::min(first.y(), second.y()),
+            std::max(first.x(), second.x()), std::max(first.y(), second.y())
+        }, m_found);
+
+        std::ranges::sort(m_found, {}, [this](primitive_id id) { return m_primitives[id].order; });
+
+        m_visible_vertices.clear();
+        for (primitive_id id: m_found) {
+            primitive& shape = m_primitives[id];
+            if (!shape.is_tessellated)
+                tessellate(shape);
+
+            if (shape.has_vertices)
+                m_visible_vertices.push_back(shape.vertices);
+        }
+
+        if (m_visible_vertices.empty())
+            return 0;
+
+        // Axes only scale and shift, shader applies them to world coordinates
+        const math::vec2 origin = target.get_view_coordinates({ 0.0f, 0.0f });
+
+        m_shader->uniform("scale", target.get_view_coordinates({ 1.0f, 1.0f }) - origin);
+        m_shader->uniform("shift", origin);
+
+        // Blended in order, same as translucent ranges of a command list
+        gl::raw::disable(GL_DEPTH_TEST);
+        gl::raw::enable(GL_BLEND);
+        gl::raw::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        m_pool->draw(drawing_type::TRIANGLES, *m_shader, m_visible_vertices);
+        return m_visible_vertices.size();
+    }
+
+    static float distance_to_segment(float x, float y, float x0, float y0, float x1, float y1) {
+        const float dx = x1 - x0, dy = y1 - y0;
+        const float length_squared = dx * dx + dy * dy;
+
+        float t = 0.0f;
+        if (length_squared > 0.0f)
+            t = std::clamp(((x - x0) * dx + (y - y0) * dy) / length_squared, 0.0f, 1.0f);
+
+        return std::hypot(x - (x0 + t * dx), y - (y0 + t * dy));
+    }
+
+    float retained_scene::distance_to(const primitive& shape, float x, float y) {
+        if (shape.kind != primitive_kind::TRIANGLE) {
+            const float distance = distance_to_segment(x, y, shape.xs[0], shape.ys[0],
+                                                       shape.xs[1], shape.ys[1]);
+
+            return std::max(distance - shape.width / 2.0f, 0.0f);
+        }
+
+        // Inside if point is on the same side of all (consistently oriented) edges
+        bool has_negative = false, has_positive = false;
+        float distance = std::numeric_limits<float>::max();
+
+        for (size_t i = 0; i < 3; ++ i) {
+            const size_t j = (i + 1) % 3;
+
+            const float cross = (shape.xs[j] - shape.xs[i]) * (y - shape.ys[i]) -
+                                (shape.ys[j] - shape.ys[i]) * (x - shape.xs[i]);
+
+            has_negative |= cross < 0.0f, has_positive |= cross > 0.0f;
+            distance = std::min(distance, distance_to_segment(x, y, shape.xs[i], shape.ys[i],
+                                                              shape.xs[j], shape.ys[j]));
+        }
+
+        return has_negative && has_positive? distance : 0.0f;
+    }
+
+    std::optional<retained_scene::primitive_id> retained_scene::pick(math::vec2 point,
+                                                                     float radius) const {
+        m_found.clear();
+        m_index.query(point.x(), point.y(), radius, m_found);
+
+        std::optional<primitive_id> closest;
+        float closest_distance = radius;
+
+        for (primitive_id id: m_found) {
+            const float distance = distance_to(m_primitives[id], point.x(), point.y());
+            if (distance > radius)
+                continue;
+
+            // On ties prefer primitives that were drawn later (they're on top)
+            const bool is_tie = !(distance < closest_distance) && !(closest_distance < distance);
+
+            if (!closest || distance < closest_distance ||
+                (is_tie && m_primitives[id].order > m_primitives[*closest].order))
+                closest = id, closest_distance = distance;
+        }
+
+        return closest;
+    }
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "axes.h"
+#include "buffer-pool.h"
+#include "colored-vertex.h"
+#include "drawing-manager.h"
+#include "opengl-setup.h"
+#include "spatial-index.h"
+#include "vec.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace gl {
+
+    // Primitives that outlive a frame, kept in a spatial index, so that
+    // drawing submits only visible ones and picking doesn't scan everything.
+    // Coordinates are world coordinates of axes the scene is drawn with.
+    class retained_scene {
+    public:
+        using primitive_id = spatial_index::item_id;
+
+        // Primitives can go beyond /world/, but are indexed better inside it
+        explicit retained_scene(culling::bounds world = { -1.0f, -1.0f, 1.0f, 1.0f });
+
+        // ==> Modification:
+
+        primitive_id add_triangle(math::vec2 p0, math::vec2 p1, math::vec2 p2,
+                                  math::vec4 color);
+
+        primitive_id add_line(math::vec2 from, math::vec2 to,
+                              math::vec4 color, float width);
+
+        primitive_id add_vector(math::vec2 from, math::vec2 to,
+                                math::vec4 color, float width);
+
+        // Moves primitive's points (number of points depends on its kind)
+        void move_triangle(primitive_id id, math::vec2 p0, math::vec2 p1, math::vec2 p2);
+        void move_line(primitive_id id, math::vec2 from, math::vec2 to);
+
+        // Id of removed primitive can be given to the next added one
+        void remove(primitive_id id);
+        void clear();
+
+        size_t size() const;
+
+        // ==> Drawing and picking:
+
+        // Draws primitives that intersect mgr's visible region (respects
+        // its culling mode) in order they were added, returns their count
+        size_t draw(drawing_manager& mgr);
+
+        // Draws primitives that intersect /target/'s view right away, on GL
+        // thread (e.g. in window_draw). Each one is tessellated once (and
+        // again when it's moved) in world coordinates into a buffer pool,
+        // so frames upload nothing for primitives that didn't change, and
+        // visible ones take a single multi-draw per pool block (order of
+        // primitives is kept only within a block). Returns their count.
+        size_t draw_gpu(const axes& target);
+
+        // Closest primitive within /radius/ from /point/ (distance is measured
+        // to triangle's area or to line's edge), if there's any
+        std::optional<primitive_id> pick(math::vec2 point, float radius) const;
+
+    private:
+        enum class primitive_kind { TRIANGLE, LINE, VECTOR };
+
+        struct primitive final {
+            primitive_kind kind;
+
+            float xs[3], ys[3]; // Lines and vectors use only two points
+            float color[4];
+            float width;
+
+            bool is_alive;
+            uint64_t order; // Primitives are drawn in order they were added
+
+            // Tessellated vertices in the pool (see draw_gpu), moving
+            // a primitive makes them stale
+            buffer_pool::handle vertices = 0;
+            bool has_vertices = false, is_tessellated = false;
+        };
+
+        std::vector<primitive> m_primitives; // Indexed by id
+        std::vector<primitive_id> m_free_ids;
+        uint64_t m_next_order = 0;
+
+        spatial_index m_index;
+
+        // Query results, reused between calls
+        mutable std::vector<primitive_id> m_found;
+
+        // ==> GPU side, created by the first draw_gpu:
+
+        std::unique_ptr<buffer_pool> m_pool;
+        std::unique_ptr<shaders::shader_program> m_shader;
+
+        bool m_has_freed = false; // Pool may need defragmenting
+
+        // Reused between draws
+        std::vector<colored_vertex> m_tessellated;
+        std::vector<buffer_pool::handle> m_visible_vertices;
+
+        void tessellate(primitive& shape);
+        void free_vertices(primitive& shape);
+
+        primitive_id add(primitive new_primitive);
+        static culling::bounds get_bounds(const primitive& shape);
+
+        static void emit(drawing_manager& mgr, const primitive& shape);
+
+        static float distance_to(const primitive& shape, float x, float y);
+    };
+
+}
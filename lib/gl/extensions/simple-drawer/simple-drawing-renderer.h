@@ -1,10 +1,23 @@
 #pragma once
 
+#include "command-list.h"
+#include "command-recorder.h"
 #include "drawing-manager.h"
+#include "frame-arena.h"
+#include "frame-pipeline.h"
 #include "opengl-setup.h"
+#include "opengl-wrapper.h"
 #include "renderer.h"
+#include "software-view.h"
+#include "text-batch.h"
 #include "vec-layout.h"
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
 namespace gl {
 
     template <typename rendering_function>
@@ -13,27 +26,251 @@ namespace gl {
         simple_drawing_renderer(rendering_function draw)
             : m_draw(draw) {}
 
+        // Pipelined mode: rendering function is called from a worker thread
+        // and produces frame N+1 while frame N is drawn. Zero or one frames in
+        // flight means no pipelining. Should be set before renderer's setup.
+        // Every frame records its draw states and text on its own, they're
+        // submitted along with it. Frames can't be recorded in this mode.
+        void set_frames_in_flight(size_t frames_in_flight) {
+            m_frames_in_flight = frames_in_flight;
+        }
+
+        // Called right before rendering function of every frame, under state
+        // lock (see lock_state). In pipelined mode rendering function itself
+        // runs without the lock, so it should only read state that snapshot
+        // function copied for it, and snapshot should do nothing but copy.
+        void set_snapshot_function(std::function<void()> snapshot) {
+            m_snapshot = std::move(snapshot);
+        }
+
+        // Event handlers on GL thread should change state that snapshot
+        // function reads only with this lock held. Costs nothing in other modes.
+        std::unique_lock<std::mutex> lock_state() {
+            return std::unique_lock(m_state_mutex);
+        }
+
+        // SOFTWARE backend rasterizes frames on CPU cores (see software_rasterizer)
+        // and only shows the result with GL. Draw states, text and pipelining
+        // aren't available with it. Should be set before renderer's setup.
+        void set_backend(render_backend backend) {
+            m_backend = backend;
+        }
+
+        // Records every frame's drawing calls into /recorder/ (can be null),
+        // see command_recorder. Not available in pipelined mode.
+        void set_recorder(command_recorder* recorder) {
+            m_recorder = recorder;
+        }
+
         void setup() override final {
-            m_gradient_shader.from_file("res/mandelbrot.glsl");
-            m_verticies.set_layout(math::vector_layout<float, 2>() +
-                                   math::vector_layout<float, 4>());
+            m_gradient_shader.from_file("res/gradient.glsl");
+            m_verticies.set_layout(get_layout());
+
+            const bool is_pipelined = m_frames_in_flight >= 2;
+
+            if (m_backend == render_backend::SOFTWARE) {
+                if (is_pipelined)
+                    throw std::runtime_error("Software backend can't be pipelined!");
+
+                m_software = std::make_unique<software_view>();
+                return;
+            }
+
+            m_commands = std::make_unique<command_list>(get_layout(), m_gradient_shader);
+
+            if (!is_pipelined) {
+                m_text = std::make_unique<text_batch>();
+                return;
+            }
+
+            // Worker's calls would interleave with events added from GL thread
+            if (m_recorder != nullptr)
+                throw std::runtime_error("Frames can't be recorded in pipelined mode!");
+
+            // Worker fills one frame while GL thread submits another,
+            // so each of them gets marks and text of its own
+            for (size_t i = 0; i < m_frames_in_flight; ++ i) {
+                pipelined_frame& added = m_frames.emplace_back();
+
+                added.commands = std::make_unique<command_list>(get_layout(), m_gradient_shader);
+                added.text = std::make_unique<text_batch>();
+            }
+
+            m_pipeline = std::make_unique<frame_pipeline>(m_frames_in_flight,
+                [this](size_t slot, std::vector<colored_vertex>& vertices,
+                       const frame_pipeline::frame_inputs& inputs) {
+
+                    // Only the worker calls this, so it gets an arena of its own
+                    m_worker_arena.reset();
+
+                    // Viewport comes from GL thread's snapshot, renderer's
+                    // own size may be changing right now
+                    drawing_manager draw_mgr { vertices, &m_worker_arena };
+                    draw_mgr.set_viewport_size(inputs.viewport_width, inputs.viewport_height);
+                    draw_mgr.set_text_batch(m_frames[slot].text.get());
+                    draw_mgr.set_command_list(m_frames[slot].commands.get());
+
+                    take_snapshot();
+                    m_draw(draw_mgr);
+                });
+
+            m_pipeline->set_inputs({ get_width(), get_height() });
+            m_pipeline->start();
         }
 
         void draw()  override final {
-            m_verticies.clear();
+            if (m_software != nullptr) {
+                draw_software();
+                return;
+            }
 
-            drawing_manager draw_mgr { m_verticies };
-            m_draw(draw_mgr);
+            if (m_pipeline != nullptr) {
+                // Frames that worker starts next are made for current size
+                m_pipeline->set_inputs({ get_width(), get_height() });
+
+                const size_t slot = m_pipeline->acquire_frame();
+                pipelined_frame& frame = m_frames[slot];
+
+                m_commands->take_marks(*frame.commands);
+                m_commands->submit(m_pipeline->get_vertices(slot));
+
+                draw_text(*frame.text);
+
+                // Vertices are copied to GL by now
+                m_pipeline->release_frame(slot);
+                return;
+            }
+
+            m_verticies.clear_frame();
+            m_arena.reset();
+
+            drawing_manager draw_mgr { m_verticies, &m_arena };
+            draw_mgr.set_viewport_size(get_width(), get_height());
+            draw_mgr.set_text_batch(m_text.get());
+            draw_mgr.set_command_list(m_commands.get());
+
+            draw_recorded(draw_mgr);
+
+            // Sorted by draw state, one draw call per distinct state
+            m_commands->submit(m_verticies);
+
+            draw_text(*m_text);
+        }
+
+        void set_override_shader(const shaders::shader_program* shader) override {
+            m_override_shader = shader;
 
-            m_verticies.update();
-            gl::draw(gl::drawing_type::TRIANGLES, m_verticies, m_gradient_shader);
+            if (m_commands != nullptr)
+                m_commands->set_override_shader(shader);
+        }
+
+        std::vector<size_t> get_triangles_per_layer() const override {
+            if (m_commands == nullptr)
+                return {};
+
+            return m_commands->get_stats().triangles_per_layer;
+        }
+
+        // Lets rendering function use its own shaders and textures (registered
+        // indices are then passed to drawing_manager), available after setup
+        command_list& get_command_list() {
+            if (m_commands == nullptr)
+                throw std::runtime_error("Command list isn't available (before setup or with software backend)!");
+
+            return *m_commands;
+        }
+
+        void teardown() override final {
+            // Worker calls rendering function, it must be stopped while
+            // everything that function uses is still alive
+            if (m_pipeline != nullptr)
+                m_pipeline->stop();
         }
 
     private:
+        // Per-frame recording targets of pipelined mode
+        struct pipelined_frame final {
+            std::unique_ptr<command_list> commands; // Only marks are used
+            std::unique_ptr<text_batch> text;
+        };
+
+        void take_snapshot() {
+            if (m_snapshot == nullptr)
+                return;
+
+            std::lock_guard lock(m_state_mutex);
+            m_snapshot();
+        }
+
+        void draw_text(text_batch& text) {
+            // All text of the frame goes on top of geometry in a single draw call,
+            // (it has its own vertices, so there's nothing to override it with)
+            if (m_override_shader == nullptr)
+                text.draw();
+            else
+                text.clear();
+        }
+
+        void draw_software() {
+            m_verticies.clear_frame();
+            m_arena.reset();
+
+            drawing_manager draw_mgr { m_verticies, &m_arena };
+            draw_mgr.set_viewport_size(get_width(), get_height());
+
+            draw_recorded(draw_mgr);
+
+            m_software->draw(m_verticies, get_framebuffer_width(), get_framebuffer_height());
+        }
+
+        void draw_recorded(drawing_manager& draw_mgr) {
+            take_snapshot();
+
+            if (m_recorder == nullptr) {
+                m_draw(draw_mgr);
+                return;
+            }
+
+            m_recorder->begin_frame(get_width(), get_height(), glfwGetTime());
+            draw_mgr.set_recorder(m_recorder);
+
+            m_draw(draw_mgr);
+
+            m_recorder->end_frame();
+        }
+
+        static gl::vertex_layout get_layout() {
+            return math::vector_layout<float, 2>() +
+                   math::vector_layout<float, 4>() +
+                   math::vector_layout<float, 1>() +
+                   math::vector_layout<float, 2>() +
+                   math::vector_layout<float, 4>();
+        }
+
         gl::shaders::shader_program m_gradient_shader;
         gl::vertex_vector_array<colored_vertex> m_verticies;
 
+        // Frame's temporaries (see drawing_manager), reset every frame
+        frame_arena m_arena, m_worker_arena;
+
         rendering_function m_draw;
+
+        std::function<void()> m_snapshot;
+        std::mutex m_state_mutex; // See lock_state
+
+        size_t m_frames_in_flight = 0;
+        std::unique_ptr<frame_pipeline> m_pipeline;
+        std::vector<pipelined_frame> m_frames; // Indexed by pipeline's slots
+
+        std::unique_ptr<command_list> m_commands;
+        std::unique_ptr<text_batch> m_text;
+
+        render_backend m_backend = render_backend::OPENGL;
+        std::unique_ptr<software_view> m_software;
+
+        const shaders::shader_program* m_override_shader = nullptr;
+
+        command_recorder* m_recorder = nullptr;
     };
 
 }
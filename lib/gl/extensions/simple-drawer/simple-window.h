@@ -4,6 +4,7 @@
 #include "renderer-handler-window.h"
 #include "simple-drawing-renderer.h"
 #include <memory>
+#include <span>
 
 
 namespace gl {
@@ -28,18 +29,64 @@ namespace gl {
 
     class simple_drawing_window: public gl::renderer_handler_window {
     public:
-        simple_drawing_window(int width, int height, const char* name)
-            : gl::renderer_handler_window(width, height, name) {
+        simple_drawing_window(int width, int height, const char* name,
+                              int msaa_samples = 0)
+            : gl::renderer_handler_window(width, height, name, msaa_samples) {
 
             set_renderer(&m_renderer);
+            m_renderer.set_snapshot_function([this] { loop_snapshot(); });
         }
 
         virtual void loop_draw(drawing_manager &mgr) = 0;
 
+        // Called before every loop_draw, serialized with event handlers.
+        // With pipelining loop_draw runs concurrently with them, so it should
+        // only read copies of handlers' state, made here.
+        virtual void loop_snapshot() {}
+
+        // Makes loop_draw run on a separate thread, one frame ahead of GPU
+        // (see simple_drawing_renderer::set_frames_in_flight for details)
+        void enable_pipelining(size_t frames_in_flight = 2) {
+            m_renderer.set_frames_in_flight(frames_in_flight);
+        }
+
+        // Rasterizes loop_draw's frames on CPU cores instead of GPU
+        // (see simple_drawing_renderer::set_backend for details)
+        void use_software_rendering() {
+            m_renderer.set_backend(render_backend::SOFTWARE);
+            m_is_software = true;
+        }
+
+        bool is_software_rendering() const { return m_is_software; }
+
+        // Records loop_draw's calls and input events of every frame into
+        // /recorder/ (can be null), so they can be replayed without the window
+        // (see command_replay). Not available with pipelining.
+        void set_recorder(command_recorder* recorder) {
+            m_recorder = recorder;
+            m_renderer.set_recorder(recorder);
+        }
+
+        command_recorder* get_recorder() const { return m_recorder; }
+
+        // Handlers change state that loop_snapshot copies, with pipelining
+        // it runs on the worker, so they're serialized with it
+        void on_events(std::span<const window_event> batch) override {
+            const std::unique_lock lock = m_renderer.lock_state();
+
+            if (m_recorder != nullptr)
+                m_recorder->add_events(batch);
+
+            gl::renderer_handler_window::on_events(batch);
+        }
+
     private:
         simple_drawing_renderer<details::simple_drawing_adapter> m_renderer =
             { details::simple_drawing_adapter(*this) };
 
+        command_recorder* m_recorder = nullptr;
+        bool m_is_software = false;
+
     };
 
     namespace details {
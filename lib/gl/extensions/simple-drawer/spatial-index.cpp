@@ -0,0 +1,179 @@
+#include "spatial-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gl {
+
+    static bool intersects(const culling::bounds& first, const culling::bounds& second) {
+        return first.min_x <= second.max_x && second.min_x <= first.max_x &&
+               first.min_y <= second.max_y && second.min_y <= first.max_y;
+    }
+
+    spatial_index::spatial_index(culling::bounds world, size_t max_depth)
+        : m_world(world), m_max_depth(max_depth) {
+        clear();
+    }
+
+    void spatial_index::clear() {
+        m_nodes.clear();
+        m_locations.clear();
+        m_size = 0;
+
+        const float size = std::max(m_world.max_x - m_world.min_x, m_world.max_y - m_world.min_y);
+        create_node((m_world.min_x + m_world.max_x) / 2.0f,
+                    (m_world.min_y + m_world.max_y) / 2.0f, size / 2.0f, no_node);
+    }
+
+    uint32_t spatial_index::create_node(float center_x, float center_y, float half_size,
+                                        uint32_t parent) {
+        node new_node;
+        new_node.center_x = center_x, new_node.center_y = center_y;
+        new_node.half_size = half_size;
+
+        // Loose bounds extend node by half of its size in every direction
+        const float loose = 2.0f * half_size;
+        new_node.loose_bounds = { center_x - loose, center_y - loose,
+                                  center_x + loose, center_y + loose };
+
+        new_node.parent = parent;
+
+        m_nodes.push_back(std::move(new_node));
+        return (uint32_t) (m_nodes.size() - 1);
+    }
+
+    uint32_t spatial_index::find_target_node(culling::bounds box) {
+        const float center_x = (box.min_x + box.max_x) / 2.0f;
+        const float center_y = (box.min_y + box.max_y) / 2.0f;
+        const float item_size = std::max(box.max_x - box.min_x, box.max_y - box.min_y);
+
+        // Items centered outside of the world live in the root, anything
+        // deeper is guaranteed to fit in the loose bounds of its node
+        const node& root = m_nodes[0];
+        if (std::abs(center_x - root.center_x) > root.half_size ||
+            std::abs(center_y - root.center_y) > root.half_size)
+            return 0;
+
+        uint32_t current = 0;
+        for (size_t depth = 0; depth < m_max_depth; ++ depth) {
+            // Item should fit in child's loose bounds, which are child's size
+            // away from its center, and child's size is half of current's
+            const float child_half_size = m_nodes[current].half_size / 2.0f;
+            if (item_size > 2.0f * child_half_size)
+                break;
+
+            const bool right = center_x >= m_nodes[current].center_x;
+            const bool upper = center_y >= m_nodes[current].center_y;
+            const size_t quadrant = (size_t) right + 2 * (size_t) upper;
+
+            if (m_nodes[current].children[quadrant] == no_node) {
+                const float child_x = m_nodes[current].center_x + (right? +1.0f : -1.0f) * child_half_size;
+                const float child_y = m_nodes[current].center_y + (upper? +1.0f : -1.0f) * child_half_size;
+
+                // Careful, creation invalidates references to nodes
+                const uint32_t child = create_node(child_x, child_y, child_half_size, current);
+                m_nodes[current].children[quadrant] = child;
+            }
+
+            current = m_nodes[current].children[quadrant];
+        }
+
+        return current;
+    }
+
+    void spatial_index::insert(item_id id, culling::bounds box) {
+        if (contains(id))
+            throw std::invalid_argument("Item is already in spatial index!");
+
+        if (id >= m_locations.size())
+            m_locations.resize((size_t) id + 1);
+
+        const uint32_t target = find_target_node(box);
+        node& target_node = m_nodes[target];
+
+        m_locations[id] = { target, (uint32_t) target_node.items.size(), box, true };
+        target_node.items.push_back(id);
+
+        for (uint32_t current = target; ; current = m_nodes[current].parent) {
+            ++ m_nodes[current].subtree_items;
+
+            if (current == 0)
+                break;
+        }
+
+        ++ m_size;
+    }
+
+    void spatial_index::remove(item_id id) {
+        if (!contains(id))
+            throw std::invalid_argument("Item is not in spatial index!");
+
+        item_location& location = m_locations[id];
+        node& owner = m_nodes[location.node];
+
+        // Swap with the last one, and fix location of the moved item
+        const item_id moved = owner.items.back();
+        owner.items[location.index] = moved;
+        m_locations[moved].index = location.index;
+        owner.items.pop_back();
+
+        for (uint32_t current = location.node; ; current = m_nodes[current].parent) {
+            -- m_nodes[current].subtree_items;
+
+            if (current == 0)
+                break;
+        }
+
+        location.is_present = false;
+        -- m_size;
+    }
+
+    void spatial_index::update(item_id id, culling::bounds box) {
+        if (!contains(id))
+            throw std::invalid_argument("Item is not in spatial index!");
+
+        // Most updates are small moves that keep item in the same node
+        if (find_target_node(box) == m_locations[id].node) {
+            m_locations[id].box = box;
+            return;
+        }
+
+        remove(id);
+        insert(id, box);
+    }
+
+    bool spatial_index::contains(item_id id) const {
+        return id < m_locations.size() && m_locations[id].is_present;
+    }
+
+    size_t spatial_index::size() const {
+        return m_size;
+    }
+
+    void spatial_index::query_node(uint32_t index, culling::bounds region,
+                                   std::vector<item_id>& result) const {
+        const node& current = m_nodes[index];
+
+        // Root also holds items that are outside of its (loose) bounds
+        if (current.subtree_items == 0 || (index != 0 && !intersects(current.loose_bounds, region)))
+            return;
+
+        for (item_id id: current.items)
+            if (intersects(m_locations[id].box, region))
+                result.push_back(id);
+
+        for (uint32_t child: current.children)
+            if (child != no_node)
+                query_node(child, region, result);
+    }
+
+    void spatial_index::query(culling::bounds region, std::vector<item_id>& result) const {
+        query_node(0, region, result);
+    }
+
+    void spatial_index::query(float x, float y, float radius, std::vector<item_id>& result) const {
+        query({ x - radius, y - radius, x + radius, y + radius }, result);
+    }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "culling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+    // Loose quadtree over axis-aligned boxes. Each item lives in exactly one
+    // node: the deepest one that is at least as big as the item, chosen by
+    // item's center. Node's "loose" bounds are twice its size, so every item
+    // fits in them, and moving an item is just remove + insert without any
+    // rebalancing. Empty subtrees are skipped, but never freed.
+    class spatial_index {
+    public:
+        using item_id = uint32_t;
+
+        // Items outside /world/ are supported, but all end up in the root
+        explicit spatial_index(culling::bounds world, size_t max_depth = 16);
+
+        // ==> Modification (all are O(depth)):
+
+        // Ids are chosen by the caller and should be unique
+        void insert(item_id id, culling::bounds box);
+        void update(item_id id, culling::bounds box);
+        void remove(item_id id);
+
+        bool contains(item_id id) const;
+        size_t size() const;
+
+        void clear();
+
+        // ==> Queries (append ids of items with intersecting boxes):
+
+        void query(culling::bounds region, std::vector<item_id>& result) const;
+        void query(float x, float y, float radius, std::vector<item_id>& result) const;
+
+    private:
+        static constexpr uint32_t no_node = 0; // Root is never anyone's child
+
+        struct node final {
+            culling::bounds loose_bounds;
+            float center_x, center_y, half_size;
+
+            uint32_t children[4] = { no_node, no_node, no_node, no_node };
+
+            std::vector<item_id> items;
+            size_t subtree_items = 0;
+
+            uint32_t parent;
+        };
+
+        struct item_location final {
+            uint32_t node = no_node;
+            uint32_t index; // In node's items
+            culling::bounds box;
+            bool is_present = false;
+        };
+
+        culling::bounds m_world;
+        size_t m_max_depth;
+
+        std::vector<node> m_nodes;
+        std::vector<item_location> m_locations; // Indexed by id
+
+        size_t m_size = 0;
+
+        uint32_t create_node(float center_x, float center_y, float half_size, uint32_t parent);
+        uint32_t find_target_node(culling::bounds box);
+
+        void query_node(uint32_t index, culling::bounds region, std::vector<item_id>& result) const;
+    };
+
+}
@@ -0,0 +1,151 @@
+#include "streaming-series.h"
+#include "vec-layout.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gl {
+
+    streaming_series::streaming_series(size_t capacity)
+        : m_capacity(capacity), m_samples(math::vector_layout<float, 2>()),
+          m_shader("res/streaming.glsl"), m_color(0.0f, 0.0f, 0.0f, 1.0f) {
+
+        if (capacity < 2)
+            throw std::invalid_argument("streaming series needs room for at least two samples");
+
+        m_samples.reserve((capacity + 1) * components * sizeof(float));
+    }
+
+    // ------------------------------------- DATA ------------------------------------
+
+    void streaming_series::append(double x, float y) {
+        m_latest_x = x;
+
+        m_pending_xs.push_back(x);
+        m_pending_ys.push_back(y);
+    }
+
+    void streaming_series::append(std::span<const double> xs, std::span<const float> ys) {
+        const size_t count = std::min(xs.size(), ys.size());
+        for (size_t i = 0; i < count; ++ i)
+            append(xs[i], ys[i]);
+    }
+
+    void streaming_series::clear() {
+        m_head = 0, m_size = 0;
+
+        m_pending_xs.clear();
+        m_pending_ys.clear();
+    }
+
+    size_t streaming_series::size() const {
+        return std::min(m_capacity, m_size + m_pending_xs.size());
+    }
+
+    size_t streaming_series::capacity() const { return m_capacity; }
+
+    double streaming_series::get_latest_x() const { return m_latest_x; }
+
+    // ------------------------------------ UPLOAD -----------------------------------
+
+    void streaming_series::upload(size_t first_slot, size_t first_pending, size_t count) {
+        constexpr size_t sample_size = components * sizeof(float);
+
+        // Writing slot zero starts a new lap, slots after this range
+        // (and mirror slot, which ends them) keep the previous origin
+        if (first_slot == 0) {
+            m_previous_origin_x = m_origin_x;
+            m_origin_x = m_pending_xs[first_pending];
+        }
+
+        m_staging.clear();
+        for (size_t i = first_pending; i < first_pending + count; ++ i)
+            m_staging.insert(m_staging.end(), { (float) (m_pending_xs[i] - m_origin_x), m_pending_ys[i] });
+
+        m_samples.update(first_slot * sample_size, { m_staging.data(), count * sample_size });
+
+        // Keep mirror slot the same sample as the first one
+        if (first_slot == 0) {
+            const float mirror[components] = {
+                (float) (m_pending_xs[first_pending] - m_previous_origin_x), m_pending_ys[first_pending]
+            };
+
+            m_samples.update(m_capacity * sample_size, { mirror, sample_size });
+        }
+    }
+
+    void streaming_series::flush() {
+        size_t count = m_pending_xs.size();
+        if (count == 0)
+            return;
+
+        size_t first = 0;
+
+        // Samples that would be overwritten in this same flush aren't uploaded,
+        // the rest replaces the whole ring, so it starts a lap from slot zero
+        if (count > m_capacity) {
+            first = count - m_capacity;
+
+            m_head = 0, m_size = 0;
+            count = m_capacity;
+        }
+
+        // ==> At most two ranges: till the end of the ring, then from its start
+
+        const size_t tail_count = std::min(count, m_capacity - m_head);
+        upload(m_head, first, tail_count);
+
+        if (count > tail_count)
+            upload(0, first + tail_count, count - tail_count);
+
+        m_head = (m_head + count) % m_capacity;
+        m_size = std::min(m_capacity, m_size + count);
+
+        m_pending_xs.clear();
+        m_pending_ys.clear();
+    }
+
+    // ------------------------------------ DRAWING ----------------------------------
+
+    void streaming_series::set_color(math::vec4 color) {
+        m_color = color;
+    }
+
+    void streaming_series::draw(const axes& target) {
+        flush();
+
+        if (m_size < 2)
+            return;
+
+        // Axes only scale and shift, get both from images of two points.
+        // Scale is taken near zero, where a unit step isn't lost to rounding
+        const math::vec2  zero = target.get_view_coordinates({ 0.0f, 0.0f });
+        const math::vec2 scale = target.get_view_coordinates({ 1.0f, 1.0f }) - zero;
+
+        // Where lap's origin lands, taken in double (origin can be huge)
+        const auto get_shift = [&](double origin_x) {
+            return math::vec2 { (float) (zero.x() + scale.x() * origin_x), zero.y() };
+        };
+
+        m_shader.uniform("scale", scale);
+        m_shader.uniform("series_color", m_color);
+
+        const size_t oldest = (m_head + m_capacity - m_size) % m_capacity;
+
+        // Not wrapped around: everything was written after slot zero
+        if (oldest + m_size <= m_capacity) {
+            m_shader.uniform("shift", get_shift(m_origin_x));
+            gl::draw(drawing_type::LINE_STRIP, m_samples, m_shader, oldest, m_size);
+            return;
+        }
+
+        // Wrapped around: first range is from the previous lap, it ends with
+        // the mirror slot, which is the same sample that starts the second one
+        m_shader.uniform("shift", get_shift(m_previous_origin_x));
+        gl::draw(drawing_type::LINE_STRIP, m_samples, m_shader, oldest, m_capacity - oldest + 1);
+
+        m_shader.uniform("shift", get_shift(m_origin_x));
+        gl::draw(drawing_type::LINE_STRIP, m_samples, m_shader, 0, m_head);
+    }
+
+}
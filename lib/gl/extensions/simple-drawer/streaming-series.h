@@ -0,0 +1,84 @@
+#pragma once
+
+#include "axes.h"
+#include "opengl-setup.h"
+#include "vec.h"
+#include "vertex-array.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    // Append-only series (e.g. live telemetry) that keeps last /capacity/
+    // samples in a fixed-size GPU ring buffer. Appending uploads only new
+    // samples, and scrolling is a uniform change, so per-frame cost doesn't
+    // depend on the window length. Drawn as a line strip in (at most) two
+    // contiguous ranges. Must be created and used on GL thread.
+    class streaming_series {
+    public:
+        explicit streaming_series(size_t capacity);
+
+        // This class shouldn't be copied or moved
+        streaming_series(const streaming_series&) = delete;
+        streaming_series& operator=(const streaming_series&) = delete;
+
+        // ==> Data (x is expected to grow, e.g. time of the sample):
+
+        void append(double x, float y);
+        void append(std::span<const double> xs, std::span<const float> ys);
+
+        void clear();
+
+        size_t size() const;
+        size_t capacity() const;
+
+        // Useful for scrolling: show [latest - window, latest]
+        double get_latest_x() const;
+
+        // ==> Drawing:
+
+        void set_color(math::vec4 color);
+
+        // Uploads samples appended since the last call (with up to three
+        // small buffer updates), called by draw automatically
+        void flush();
+
+        void draw(const axes& target);
+
+    private:
+        static constexpr size_t components = 2; // x and y
+
+        size_t m_capacity;
+
+        // Ring buffer has one extra (mirror) slot after the last one that
+        // duplicates the first slot, so the part that wraps around stays
+        // connected without drawing an extra range
+        vertex_array m_samples;
+        shaders::shader_program m_shader;
+
+        size_t m_head = 0; // Slot where the next sample goes
+        size_t m_size = 0;
+
+        // Samples are stored as floats relative to the origin of ring's lap
+        // they were written in (offset is taken in double). Lap starts when
+        // slot zero is written, so there are at most two of them in the ring
+        // and precision depends on how long a lap takes, not on how long the
+        // series runs or how big x is (e.g. seconds since epoch).
+        double m_origin_x = 0.0;          // Of slots before head
+        double m_previous_origin_x = 0.0; // Of slots from head on (and of mirror slot)
+        double m_latest_x = 0.0;
+
+        // Appended, but not uploaded yet
+        std::vector<double> m_pending_xs;
+        std::vector<float> m_pending_ys;
+
+        std::vector<float> m_staging; // Samples of one upload, reused
+
+        math::vec4 m_color;
+
+        void upload(size_t first_slot, size_t first_pending, size_t count);
+    };
+
+}
@@ -0,0 +1,117 @@
+#include "offscreen-canvas.h"
+#include "command-list.h"
+#include "framebuffer.h"
+#include "gpu-resources.h"
+#include "opengl-wrapper.h"
+#include "vec-layout.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gl {
+
+    struct offscreen_canvas::gl_target final {
+        framebuffer target;
+        shaders::shader_program gradient_shader { "res/gradient.glsl" };
+
+        command_list commands {
+            math::vector_layout<float, 2>() +
+            math::vector_layout<float, 4>() +
+            math::vector_layout<float, 1>() +
+            math::vector_layout<float, 2>() +
+            math::vector_layout<float, 4>(),
+            gradient_shader
+        };
+
+        std::vector<uint8_t> row; // Scratch for flipping rows
+    };
+
+    offscreen_canvas::offscreen_canvas(size_t width, size_t height,
+                                       render_backend backend, thread_pool& pool)
+        : m_backend(backend), m_width(width), m_height(height) {
+
+        if (width == 0 || height == 0)
+            throw std::invalid_argument("Offscreen canvas can't be empty!");
+
+        if (m_backend == render_backend::SOFTWARE) {
+            m_rasterizer = std::make_unique<software_rasterizer>(pool);
+            m_rasterizer->resize(width, height);
+            return;
+        }
+
+        m_gl = std::make_unique<gl_target>();
+        m_gl->target.resize(width, height, texture::format::RGBA);
+
+        m_image.resize(width, height);
+    }
+
+    void offscreen_canvas::set_clear_color(math::vec4 color) { m_clear_color = color; }
+
+    const rgba_image& offscreen_canvas::render(const drawing_function& draw) {
+        m_vertices.clear();
+        m_arena.reset();
+
+        drawing_manager draw_mgr { m_vertices, &m_arena };
+        draw_mgr.set_viewport_size(m_width, m_height);
+
+        draw(draw_mgr);
+
+        if (m_backend == render_backend::SOFTWARE) {
+            m_rasterizer->clear(m_clear_color);
+            m_rasterizer->draw(m_vertices);
+        } else
+            render_gl();
+
+        return get_image();
+    }
+
+    void offscreen_canvas::render_gl() {
+        // Whoever draws next expects their own viewport
+        GLint viewport[4];
+        gl::raw::get_integerv(GL_VIEWPORT, viewport);
+
+        m_gl->target.bind();
+        gl::raw::viewport(0, 0, (GLsizei) m_width, (GLsizei) m_height);
+
+        const math::vec4 clear_color = m_clear_color;
+        const GLfloat color[4] = { clear_color.x(), clear_color.y(), clear_color.z(), clear_color.w() };
+        gl::raw::clear_bufferfv(GL_COLOR, 0, color);
+
+        // Without marks everything is one translucent range, as in software
+        m_gl->commands.submit(m_vertices);
+
+        // ==> Read back, GL's rows go from bottom to top:
+
+        gl::raw::pixel_storei(GL_PACK_ALIGNMENT, 1);
+        gl::raw::read_pixels(0, 0, (GLsizei) m_width, (GLsizei) m_height,
+                             GL_RGBA, GL_UNSIGNED_BYTE, m_image.pixels.data());
+
+        const size_t row_size = m_width * 4;
+        m_gl->row.resize(row_size);
+
+        for (size_t y = 0; y < m_height / 2; ++ y) {
+            uint8_t* top = m_image.get_pixel(0, y);
+            uint8_t* bottom = m_image.get_pixel(0, m_height - 1 - y);
+
+            std::copy(top, top + row_size, m_gl->row.data());
+            std::copy(bottom, bottom + row_size, top);
+            std::copy(m_gl->row.begin(), m_gl->row.end(), bottom);
+        }
+
+        framebuffer::bind_default();
+        gl::raw::viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        // Canvas can be used without a window, that would collect otherwise
+        gpu_resources::collect();
+    }
+
+    const rgba_image& offscreen_canvas::get_image() const {
+        return m_rasterizer != nullptr ? m_rasterizer->get_image() : m_image;
+    }
+
+    render_backend offscreen_canvas::get_backend() const { return m_backend; }
+
+    // Defined here, where gl_target is complete
+    offscreen_canvas::~offscreen_canvas() = default;
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "drawing-manager.h"
+#include "frame-arena.h"
+#include "rgba-image.h"
+#include "software-rasterizer.h"
+#include "thread-pool.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gl {
+
+    // Renders drawing_manager frames into an image in memory instead of a
+    // window (e.g. for reports and tests). SOFTWARE backend doesn't need GL at
+    // all, OPENGL one draws into a framebuffer and needs a current context
+    // (e.g. of a hidden window) for the whole life of the canvas.
+    //
+    // Frames are drawn with the gradient shader and alpha blending only: draw
+    // states and text (which need a command list and a text batch) aren't
+    // available, so both backends draw the same thing.
+    class offscreen_canvas {
+    public:
+        using drawing_function = std::function<void(drawing_manager&)>;
+
+        offscreen_canvas(size_t width, size_t height,
+                         render_backend backend = render_backend::SOFTWARE,
+                         thread_pool& pool = thread_pool::global());
+
+        // This class shouldn't be copied or moved
+        offscreen_canvas(const offscreen_canvas&) = delete;
+        offscreen_canvas& operator=(const offscreen_canvas&) = delete;
+
+        void set_clear_color(math::vec4 color);
+
+        // Clears the image, draws /draw/'s frame and returns the result
+        const rgba_image& render(const drawing_function& draw);
+
+        const rgba_image& get_image() const;
+        render_backend get_backend() const;
+
+        ~offscreen_canvas();
+
+    private:
+        struct gl_target; // Everything that OPENGL backend owns
+
+        const render_backend m_backend;
+        const size_t m_width, m_height;
+
+        math::vec4 m_clear_color = { 0.0f, 0.0f, 0.0f, 0.0f };
+        std::vector<colored_vertex> m_vertices;
+        frame_arena m_arena; // Frame's temporaries
+
+        std::unique_ptr<software_rasterizer> m_rasterizer;
+        std::unique_ptr<gl_target> m_gl;
+
+        rgba_image m_image; // Read back by OPENGL backend
+
+        void render_gl();
+    };
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+    // 8-bit RGBA pixels in memory, rows go from top to bottom (as in image
+    // files, unlike GL framebuffers), every pixel is 4 bytes: R, G, B, A
+    struct rgba_image final {
+        size_t width = 0, height = 0;
+        std::vector<uint8_t> pixels;
+
+        void resize(size_t new_width, size_t new_height) {
+            width = new_width, height = new_height;
+            pixels.assign(width * height * 4, 0);
+        }
+
+        uint8_t* get_pixel(size_t x, size_t y) { return pixels.data() + (y * width + x) * 4; }
+        const uint8_t* get_pixel(size_t x, size_t y) const { return pixels.data() + (y * width + x) * 4; }
+    };
+
+}
@@ -0,0 +1,551 @@
+#include "software-rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace gl {
+
+    // ---------------------------------- FIXED POINT --------------------------------
+
+    static constexpr int subpixel_bits = 8;
+    static constexpr int64_t subpixel_one = 1 << subpixel_bits;
+    static constexpr int64_t subpixel_half = subpixel_one / 2; // Pixel's center
+
+    // About a million pixels off screen, keeps edge functions well inside int64
+    static constexpr float max_fixed = (float) (1 << 28);
+
+    static int64_t to_fixed(float pixels) {
+        return (int64_t) std::nearbyint(std::clamp(pixels * (float) subpixel_one, -max_fixed, max_fixed));
+    }
+
+    // Exact quotients of non-negative /value/ and positive /divisor/, done
+    // per row and per edge, where 64-bit division would dominate thin spans.
+    // Double's estimate is off by a little at most, then it's corrected.
+    static int64_t divide_down(int64_t value, int64_t divisor) {
+        int64_t quotient = (int64_t) ((double) value / (double) divisor);
+
+        while (quotient * divisor > value) -- quotient;
+        while ((quotient + 1) * divisor <= value) ++ quotient;
+
+        return quotient;
+    }
+
+    static int64_t divide_up(int64_t value, int64_t divisor) {
+        return divide_down(value + divisor - 1, divisor);
+    }
+
+    // ------------------------------------ SHADING ----------------------------------
+
+    // Everything below repeats res/gradient.glsl and blending set up by
+    // command_list, for a single pixel or (with AVX2) for eight of them
+
+    static constexpr float min_pixel = 1e-6f;
+
+    // Same as edge_coverage in the shader
+    static float edge_coverage(float distance, float pixel) {
+        return std::clamp(0.5f + (1.0f - std::abs(distance)) / std::max(pixel, min_pixel), 0.0f, 1.0f);
+    }
+
+    // Same as shape_distance in the shader
+    static float shape_distance(int kind, float px, float py, const float* parameters) {
+        switch (kind) {
+        case 1:
+            return std::sqrt(px * px + py * py) - parameters[0];
+
+        case 2:
+            return std::abs(std::sqrt(px * px + py * py) - parameters[0]) - parameters[1];
+
+        case 3: {
+            const float qx = std::abs(px) - parameters[0] + parameters[2];
+            const float qy = std::abs(py) - parameters[1] + parameters[2];
+
+            const float outside_x = std::max(qx, 0.0f), outside_y = std::max(qy, 0.0f);
+            return std::sqrt(outside_x * outside_x + outside_y * outside_y) +
+                   std::min(std::max(qx, qy), 0.0f) - parameters[2];
+        }
+
+        case 4: {
+            const float qx = parameters[0], qy = parameters[1];
+            px = std::abs(px), py = py + qy * 0.5f;
+
+            const float t = std::clamp((px * qx + py * qy) / (qx * qx + qy * qy), 0.0f, 1.0f);
+            const float ax = px - qx * t, ay = py - qy * t;
+            const float bx = px - qx * std::clamp(px / qx, 0.0f, 1.0f), by = py - qy;
+
+            const float k = qy > 0.0f ? 1.0f : qy < 0.0f ? -1.0f : 0.0f;
+            const float d = std::min(ax * ax + ay * ay, bx * bx + by * by);
+            const float s = std::max(k * (px * qy - py * qx), k * (py - qy));
+
+            return std::sqrt(d) * (s > 0.0f ? 1.0f : s < 0.0f ? -1.0f : 0.0f);
+        }
+
+        default:
+            return 0.0f;
+        }
+    }
+
+    // Channels are from 0 to 1, target's ones are rounded to 8 bits after every blend
+    static float blend_channel(float source, float alpha, float target, bool is_alpha, blend_mode blend) {
+        switch (blend) {
+            case blend_mode::ADDITIVE: return source * alpha + target;
+            case blend_mode::MULTIPLY: return (is_alpha ? alpha : source) * target;
+            case blend_mode::NONE:     return source;
+            case blend_mode::ALPHA:
+            default:                   return source * alpha + target * (1.0f - alpha);
+        }
+    }
+
+#ifdef __AVX2__
+    static __m256 clamp(__m256 value, float min, float max) {
+        return _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(min)), _mm256_set1_ps(max));
+    }
+
+    static __m256 abs(__m256 value) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+    }
+
+    static __m256 length(__m256 x, __m256 y) {
+        return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+    }
+
+    static __m256 edge_coverage(__m256 distance, float pixel) {
+        const __m256 inside = _mm256_sub_ps(_mm256_set1_ps(1.0f), abs(distance));
+        return clamp(_mm256_add_ps(_mm256_set1_ps(0.5f),
+                                   _mm256_div_ps(inside, _mm256_set1_ps(std::max(pixel, min_pixel)))), 0.0f, 1.0f);
+    }
+
+    static __m256 shape_distance(int kind, __m256 px, __m256 py, const float* parameters) {
+        const __m256 zero = _mm256_setzero_ps();
+
+        switch (kind) {
+        case 1:
+            return _mm256_sub_ps(length(px, py), _mm256_set1_ps(parameters[0]));
+
+        case 2:
+            return _mm256_sub_ps(abs(_mm256_sub_ps(length(px, py), _mm256_set1_ps(parameters[0]))),
+                                 _mm256_set1_ps(parameters[1]));
+
+        case 3: {
+            const __m256 radius = _mm256_set1_ps(parameters[2]);
+
+            const __m256 qx = _mm256_add_ps(_mm256_sub_ps(abs(px), _mm256_set1_ps(parameters[0])), radius);
+            const __m256 qy = _mm256_add_ps(_mm256_sub_ps(abs(py), _mm256_set1_ps(parameters[1])), radius);
+
+            return _mm256_sub_ps(_mm256_add_ps(length(_mm256_max_ps(qx, zero), _mm256_max_ps(qy, zero)),
+                                               _mm256_min_ps(_mm256_max_ps(qx, qy), zero)), radius);
+        }
+
+        case 4: {
+            const float qx = parameters[0], qy = parameters[1];
+            const __m256 lanes_qx = _mm256_set1_ps(qx), lanes_qy = _mm256_set1_ps(qy);
+
+            px = abs(px), py = _mm256_add_ps(py, _mm256_set1_ps(qy * 0.5f));
+
+            const __m256 t = clamp(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(px, lanes_qx), _mm256_mul_ps(py, lanes_qy)),
+                                                 _mm256_set1_ps(qx * qx + qy * qy)), 0.0f, 1.0f);
+
+            const __m256 ax = _mm256_sub_ps(px, _mm256_mul_ps(lanes_qx, t));
+            const __m256 ay = _mm256_sub_ps(py, _mm256_mul_ps(lanes_qy, t));
+
+            const __m256 bx = _mm256_sub_ps(px, _mm256_mul_ps(lanes_qx, clamp(_mm256_div_ps(px, lanes_qx), 0.0f, 1.0f)));
+            const __m256 by = _mm256_sub_ps(py, lanes_qy);
+
+            const __m256 k = _mm256_set1_ps(qy > 0.0f ? 1.0f : qy < 0.0f ? -1.0f : 0.0f);
+
+            const __m256 d = _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(ax, ax), _mm256_mul_ps(ay, ay)),
+                                           _mm256_add_ps(_mm256_mul_ps(bx, bx), _mm256_mul_ps(by, by)));
+
+            const __m256 s = _mm256_max_ps(
+                _mm256_mul_ps(k, _mm256_sub_ps(_mm256_mul_ps(px, lanes_qy), _mm256_mul_ps(py, lanes_qx))),
+                _mm256_mul_ps(k, _mm256_sub_ps(py, lanes_qy)));
+
+            const __m256 sign = _mm256_or_ps(
+                _mm256_and_ps(_mm256_cmp_ps(s, zero, _CMP_GT_OQ), _mm256_set1_ps(+1.0f)),
+                _mm256_and_ps(_mm256_cmp_ps(s, zero, _CMP_LT_OQ), _mm256_set1_ps(-1.0f)));
+
+            return _mm256_mul_ps(_mm256_sqrt_ps(d), sign);
+        }
+
+        default:
+            return zero;
+        }
+    }
+
+    static __m256 blend_channel(__m256 source, __m256 alpha, __m256 target, bool is_alpha, blend_mode blend) {
+        switch (blend) {
+            case blend_mode::ADDITIVE: return _mm256_add_ps(_mm256_mul_ps(source, alpha), target);
+            case blend_mode::MULTIPLY: return _mm256_mul_ps(is_alpha ? alpha : source, target);
+            case blend_mode::NONE:     return source;
+
+            case blend_mode::ALPHA:
+            default:
+                return _mm256_add_ps(_mm256_mul_ps(source, alpha),
+                                     _mm256_mul_ps(target, _mm256_sub_ps(_mm256_set1_ps(1.0f), alpha)));
+        }
+    }
+#endif
+
+    void software_rasterizer::shade_span(const setup_triangle& triangle, const float* start,
+                                         size_t count, uint8_t* pixels, blend_mode blend) {
+
+        const float* steps_x = triangle.steps_x;
+        const float* steps_y = triangle.steps_y;
+
+        // Edges change linearly, their fwidth is the same for every pixel
+        const float edge_width_x = std::abs(steps_x[4]) + std::abs(steps_y[4]);
+        const float edge_width_y = std::abs(steps_x[5]) + std::abs(steps_y[5]);
+
+        const int kind = triangle.shape_kind;
+        const float* parameters = triangle.shape_parameters;
+
+        size_t i = 0;
+
+    #ifdef __AVX2__
+        const __m256 lane_offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256i lane_indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        for (; i < count; i += 8) {
+            // Last group can be partial, it's loaded and stored with a mask
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int) std::min<size_t>(count - i, 8)),
+                                                    lane_indices);
+
+            const __m256 xs = _mm256_add_ps(_mm256_set1_ps((float) i), lane_offsets);
+
+            __m256 values[attribute_count];
+            for (int j = 0; j < attribute_count; ++ j)
+                values[j] = _mm256_add_ps(_mm256_set1_ps(start[j]), _mm256_mul_ps(xs, _mm256_set1_ps(steps_x[j])));
+
+            // ==> Coverage:
+
+            __m256 coverage;
+            if (kind == 0)
+                coverage = _mm256_mul_ps(edge_coverage(values[4], edge_width_x),
+                                         edge_coverage(values[5], edge_width_y));
+            else {
+                // GPU takes derivatives as differences with neighbouring pixels
+                const __m256 distance = shape_distance(kind, values[4], values[5], parameters);
+
+                const __m256 dx = _mm256_sub_ps(shape_distance(kind,
+                    _mm256_add_ps(values[4], _mm256_set1_ps(steps_x[4])),
+                    _mm256_add_ps(values[5], _mm256_set1_ps(steps_x[5])), parameters), distance);
+
+                const __m256 dy = _mm256_sub_ps(shape_distance(kind,
+                    _mm256_add_ps(values[4], _mm256_set1_ps(steps_y[4])),
+                    _mm256_add_ps(values[5], _mm256_set1_ps(steps_y[5])), parameters), distance);
+
+                const __m256 pixel = _mm256_max_ps(length(dx, dy), _mm256_set1_ps(min_pixel));
+                coverage = clamp(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_div_ps(distance, pixel)), 0.0f, 1.0f);
+            }
+
+            const __m256 alpha = clamp(_mm256_mul_ps(values[3], coverage), 0.0f, 1.0f);
+
+            // ==> Blending, eight RGBA pixels are eight 32-bit lanes:
+
+            uint8_t* target = pixels + i * 4;
+            const __m256i packed = _mm256_maskload_epi32((const int*) target, mask);
+
+            __m256i result = _mm256_setzero_si256();
+            for (int channel = 0; channel < 4; ++ channel) {
+                const __m256 destination = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(
+                    _mm256_srli_epi32(packed, channel * 8), _mm256_set1_epi32(0xff))), _mm256_set1_ps(1.0f / 255.0f));
+
+                const bool is_alpha = channel == 3;
+                const __m256 source = is_alpha ? alpha : clamp(values[channel], 0.0f, 1.0f);
+
+                const __m256 blended = clamp(blend_channel(source, alpha, destination, is_alpha, blend), 0.0f, 1.0f);
+                const __m256i bytes = _mm256_cvtps_epi32(_mm256_mul_ps(blended, _mm256_set1_ps(255.0f)));
+
+                result = _mm256_or_si256(result, _mm256_slli_epi32(bytes, channel * 8));
+            }
+
+            _mm256_maskstore_epi32((int*) target, mask, result);
+        }
+    #endif
+
+        for (; i < count; ++ i) {
+            float values[attribute_count];
+            for (int j = 0; j < attribute_count; ++ j)
+                values[j] = start[j] + (float) i * steps_x[j];
+
+            float coverage;
+            if (kind == 0)
+                coverage = edge_coverage(values[4], edge_width_x) * edge_coverage(values[5], edge_width_y);
+            else {
+                const float distance = shape_distance(kind, values[4], values[5], parameters);
+
+                const float dx = shape_distance(kind, values[4] + steps_x[4],
+                                                values[5] + steps_x[5], parameters) - distance;
+                const float dy = shape_distance(kind, values[4] + steps_y[4],
+                                                values[5] + steps_y[5], parameters) - distance;
+
+                coverage = std::clamp(0.5f - distance / std::max(std::sqrt(dx * dx + dy * dy), min_pixel),
+                                      0.0f, 1.0f);
+            }
+
+            const float alpha = std::clamp(values[3] * coverage, 0.0f, 1.0f);
+
+            uint8_t* target = pixels + i * 4;
+            for (int channel = 0; channel < 4; ++ channel) {
+                const bool is_alpha = channel == 3;
+                const float source = is_alpha ? alpha : std::clamp(values[channel], 0.0f, 1.0f);
+
+                const float blended = blend_channel(source, alpha, target[channel] * (1.0f / 255.0f), is_alpha, blend);
+                target[channel] = (uint8_t) std::nearbyint(std::clamp(blended, 0.0f, 1.0f) * 255.0f);
+            }
+        }
+    }
+
+    // ------------------------------------ TARGET -----------------------------------
+
+    software_rasterizer::software_rasterizer(thread_pool& pool): m_pool(pool) {}
+
+    void software_rasterizer::resize(size_t width, size_t height) {
+        if (width == m_image.width && height == m_image.height)
+            return;
+
+        m_image.resize(width, height);
+
+        m_tiles_x = (width  + tile_size - 1) / tile_size;
+        m_tiles_y = (height + tile_size - 1) / tile_size;
+
+        m_bins.assign(m_tiles_x * m_tiles_y, {});
+    }
+
+    void software_rasterizer::clear(math::vec4 color) {
+        const math::vec4 channels = color;
+
+        uint8_t bytes[4];
+        for (int channel = 0; channel < 4; ++ channel)
+            bytes[channel] = (uint8_t) std::nearbyint(std::clamp(channels[channel], 0.0f, 1.0f) * 255.0f);
+
+        for (size_t i = 0; i < m_image.pixels.size(); i += 4)
+            std::copy(bytes, bytes + 4, m_image.pixels.data() + i);
+    }
+
+    const rgba_image& software_rasterizer::get_image() const { return m_image; }
+
+    // ------------------------------------ SETUP ------------------------------------
+
+    void software_rasterizer::setup(const colored_vertex* corners, setup_triangle& triangle) const {
+        // ==> Snap to fixed point pixel coordinates, y goes down:
+
+        const float width = (float) m_image.width, height = (float) m_image.height;
+
+        int64_t xs[3], ys[3];
+        for (int k = 0; k < 3; ++ k) {
+            const math::vec2 point = corners[k].point;
+
+            xs[k] = to_fixed((point.x() * 0.5f + 0.5f) * width);
+            ys[k] = to_fixed((0.5f - point.y() * 0.5f) * height);
+        }
+
+        // ==> Edge functions, edge k goes between the other two vertices:
+
+        for (int k = 0; k < 3; ++ k) {
+            const int i = (k + 1) % 3, j = (k + 2) % 3;
+
+            triangle.a[k] = ys[i] - ys[j];
+            triangle.b[k] = xs[j] - xs[i];
+            triangle.c[k] = -(triangle.a[k] * xs[i] + triangle.b[k] * ys[i]);
+        }
+
+        int64_t area = triangle.a[0] * xs[0] + triangle.b[0] * ys[0] + triangle.c[0];
+
+        triangle.min_x = triangle.min_y = triangle.max_x = triangle.max_y = 0;
+        if (area == 0)
+            return;
+
+        // Either winding is drawn, as there's no face culling in GL path
+        if (area < 0) {
+            for (int k = 0; k < 3; ++ k)
+                triangle.a[k] = -triangle.a[k], triangle.b[k] = -triangle.b[k], triangle.c[k] = -triangle.c[k];
+
+            area = -area;
+        }
+
+        // Pixel centers exactly on an edge belong to one of the two triangles
+        // sharing it (edges of neighbours have opposite directions)
+        for (int k = 0; k < 3; ++ k)
+            triangle.bias[k] = triangle.a[k] > 0 || (triangle.a[k] == 0 && triangle.b[k] > 0) ? 0 : -1;
+
+        // ==> Pixels whose centers are inside of the bounding box:
+
+        const int64_t min_x = std::min({ xs[0], xs[1], xs[2] }), max_x = std::max({ xs[0], xs[1], xs[2] });
+        const int64_t min_y = std::min({ ys[0], ys[1], ys[2] }), max_y = std::max({ ys[0], ys[1], ys[2] });
+
+        triangle.min_x = (int) std::clamp<int64_t>((min_x - subpixel_half + subpixel_one - 1) >> subpixel_bits,
+                                                   0, (int64_t) m_image.width);
+        triangle.min_y = (int) std::clamp<int64_t>((min_y - subpixel_half + subpixel_one - 1) >> subpixel_bits,
+                                                   0, (int64_t) m_image.height);
+
+        triangle.max_x = (int) std::clamp<int64_t>(((max_x - subpixel_half) >> subpixel_bits) + 1,
+                                                   0, (int64_t) m_image.width);
+        triangle.max_y = (int) std::clamp<int64_t>(((max_y - subpixel_half) >> subpixel_bits) + 1,
+                                                   0, (int64_t) m_image.height);
+
+        triangle.inverse_area = (float) (1.0 / (double) area);
+
+        // ==> Attributes change linearly, so do weights of the vertices:
+
+        for (int k = 0; k < 3; ++ k) {
+            const math::vec4 color = corners[k].color;
+            const math::vec2 edge = corners[k].edge;
+
+            const float values[attribute_count] = { color.x(), color.y(), color.z(), color.w(), edge.x(), edge.y() };
+            for (int j = 0; j < attribute_count; ++ j)
+                triangle.attributes[j][k] = values[j];
+        }
+
+        for (int j = 0; j < attribute_count; ++ j) {
+            triangle.steps_x[j] = triangle.steps_y[j] = 0.0f;
+
+            for (int k = 0; k < 3; ++ k) {
+                const float value = triangle.attributes[j][k] * triangle.inverse_area;
+
+                triangle.steps_x[j] += (float) (triangle.a[k] * subpixel_one) * value;
+                triangle.steps_y[j] += (float) (triangle.b[k] * subpixel_one) * value;
+            }
+        }
+
+        const math::vec4 shape = corners[2].shape;
+
+        triangle.shape_kind = (int) (shape.x() + 0.5f);
+        triangle.shape_parameters[0] = shape.y();
+        triangle.shape_parameters[1] = shape.z();
+        triangle.shape_parameters[2] = shape.w();
+    }
+
+    // ---------------------------------- RASTERIZING --------------------------------
+
+    // Long thin triangles (lines) overlap most tiles of their box only with
+    // the box, region is skipped if its corners are all outside of some edge
+    bool software_rasterizer::overlaps(const setup_triangle& triangle,
+                                       int min_x, int min_y, int max_x, int max_y) {
+        const int64_t left = min_x * subpixel_one + subpixel_half, right = (max_x - 1) * subpixel_one + subpixel_half;
+        const int64_t top  = min_y * subpixel_one + subpixel_half, bottom = (max_y - 1) * subpixel_one + subpixel_half;
+
+        const int64_t xs[4] = { left, right, left, right }, ys[4] = { top, top, bottom, bottom };
+
+        for (int k = 0; k < 3; ++ k) {
+            bool is_outside = true;
+            for (int corner = 0; corner < 4 && is_outside; ++ corner)
+                is_outside = triangle.a[k] * xs[corner] + triangle.b[k] * ys[corner] +
+                             triangle.c[k] + triangle.bias[k] < 0;
+
+            if (is_outside)
+                return false;
+        }
+
+        return true;
+    }
+
+    void software_rasterizer::rasterize_tile(size_t tile, blend_mode blend) {
+
+        const int tile_x = (int) ((tile % m_tiles_x) * tile_size);
+        const int tile_y = (int) ((tile / m_tiles_x) * tile_size);
+
+        const int tile_end_x = std::min(tile_x + (int) tile_size, (int) m_image.width);
+        const int tile_end_y = std::min(tile_y + (int) tile_size, (int) m_image.height);
+
+        for (uint32_t index: m_bins[tile]) {
+            const setup_triangle& triangle = m_triangles[index];
+
+            const int start_x = std::max(triangle.min_x, tile_x), end_x = std::min(triangle.max_x, tile_end_x);
+            const int start_y = std::max(triangle.min_y, tile_y), end_y = std::min(triangle.max_y, tile_end_y);
+
+            if (start_x >= end_x || start_y >= end_y || !overlaps(triangle, start_x, start_y, end_x, end_y))
+                continue;
+
+            for (int y = start_y; y < end_y; ++ y) {
+                const int64_t sample_x = start_x * subpixel_one + subpixel_half;
+                const int64_t sample_y = y * subpixel_one + subpixel_half;
+
+                // ==> Pixels [first, last] of the row are inside of every edge:
+
+                int64_t first = 0, last = end_x - start_x - 1, row[3];
+
+                for (int k = 0; k < 3; ++ k) {
+                    row[k] = triangle.a[k] * sample_x + triangle.b[k] * sample_y + triangle.c[k];
+
+                    // Edge function changes by /step/ from pixel to pixel
+                    const int64_t value = row[k] + triangle.bias[k], step = triangle.a[k] * subpixel_one;
+
+                    if (step > 0) {
+                        if (value < 0)
+                            first = std::max(first, divide_up(-value, step));
+                    } else if (step < 0)
+                        last = value < 0 ? -1 : std::min(last, divide_down(value, -step));
+                    else if (value < 0)
+                        last = -1;
+                }
+
+                if (first > last)
+                    continue;
+
+                // ==> Attributes at the first pixel, edge k's function is vertex k's weight:
+
+                float weights[3];
+                for (int k = 0; k < 3; ++ k)
+                    weights[k] = (float) (row[k] + first * triangle.a[k] * subpixel_one) * triangle.inverse_area;
+
+                float start[attribute_count];
+                for (int j = 0; j < attribute_count; ++ j)
+                    start[j] = weights[0] * triangle.attributes[j][0] +
+                               weights[1] * triangle.attributes[j][1] +
+                               weights[2] * triangle.attributes[j][2];
+
+                shade_span(triangle, start, (size_t) (last - first + 1),
+                           m_image.get_pixel((size_t) (start_x + first), (size_t) y), blend);
+            }
+        }
+    }
+
+    // ------------------------------------ DRAWING ----------------------------------
+
+    void software_rasterizer::draw(std::span<const colored_vertex> vertices, blend_mode blend) {
+        const size_t triangle_count = vertices.size() / 3;
+        if (triangle_count == 0 || m_bins.empty())
+            return;
+
+        // ==> Set up every triangle independently:
+
+        m_triangles.resize(triangle_count);
+
+        constexpr size_t chunk_size = 1024;
+        m_pool.parallel_for((triangle_count + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+            const size_t end = std::min((chunk + 1) * chunk_size, triangle_count);
+
+            for (size_t i = chunk * chunk_size; i < end; ++ i)
+                setup(vertices.data() + i * 3, m_triangles[i]);
+        });
+
+        // ==> Bin them in submission order, which every tile then keeps:
+
+        for (std::vector<uint32_t>& bin: m_bins)
+            bin.clear();
+
+        for (size_t i = 0; i < triangle_count; ++ i) {
+            const setup_triangle& triangle = m_triangles[i];
+            if (triangle.min_x >= triangle.max_x || triangle.min_y >= triangle.max_y)
+                continue;
+
+            const size_t first_x = triangle.min_x / tile_size, last_x = (triangle.max_x - 1) / tile_size;
+            const size_t first_y = triangle.min_y / tile_size, last_y = (triangle.max_y - 1) / tile_size;
+
+            for (size_t y = first_y; y <= last_y; ++ y)
+                for (size_t x = first_x; x <= last_x; ++ x)
+                    m_bins[y * m_tiles_x + x].push_back((uint32_t) i);
+        }
+
+        // ==> Tiles don't overlap, so they're drawn without any locking:
+
+        m_pool.parallel_for(m_bins.size(), [&](size_t tile) {
+            rasterize_tile(tile, blend);
+        });
+    }
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "command-list.h"
+#include "rgba-image.h"
+#include "thread-pool.h"
+#include "vec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gl {
+
+    enum class render_backend {
+        OPENGL,  // Draws with GL (needs a context)
+        SOFTWARE // Rasterizes on CPU cores, doesn't call GL to draw
+    };
+
+    // CPU implementation of gl::draw(TRIANGLES, ...) with res/gradient.glsl,
+    // for machines without a GPU (CI, server-side report generation).
+    //
+    // Triangles are set up in fixed point (8 subpixel bits) and binned into
+    // square tiles, then tiles are rasterized in parallel, each one going
+    // through its triangles in submission order. Rows are shaded and blended
+    // eight pixels at a time with AVX2. Every pixel is written
+    // by exactly one thread in the same order, and coverage is decided by
+    // integer edge functions (with a tie-breaking rule for shared edges),
+    // so output is bit-identical for any number of threads.
+    //
+    // Drawing order replaces depth test: later triangles are drawn over
+    // earlier ones, which is what opaque depth-tested pass produces too.
+    class software_rasterizer {
+    public:
+        static constexpr size_t tile_size = 64; // In pixels
+
+        explicit software_rasterizer(thread_pool& pool = thread_pool::global());
+
+        // This class shouldn't be copied or moved
+        software_rasterizer(const software_rasterizer&) = delete;
+        software_rasterizer& operator=(const software_rasterizer&) = delete;
+
+        // Reallocates target (contents are lost) if size changed
+        void resize(size_t width, size_t height);
+
+        void clear(math::vec4 color);
+
+        // Each consecutive three /vertices/ (in view coordinates) form a triangle,
+        // they're shaded and blended as GL would do with gradient shader
+        void draw(std::span<const colored_vertex> vertices,
+                  blend_mode blend = blend_mode::ALPHA);
+
+        const rgba_image& get_image() const;
+
+    private:
+        // Interpolated values: color's channels, then edge distances
+        static constexpr int attribute_count = 6;
+
+        // Triangle in fixed point pixel coordinates (y goes down), ready to
+        // be rasterized: E(x, y) = a x + b y + c is non-negative inside
+        // (after bias) for each of its edges
+        struct setup_triangle final {
+            int64_t a[3], b[3], c[3];
+            int64_t bias[3];
+
+            // Pixels that can be covered, max is exclusive, empty if culled
+            int min_x, min_y, max_x, max_y;
+
+            float inverse_area;
+
+            // Attributes at each vertex, and how much they change from
+            // pixel to pixel along a row and along a column
+            float attributes[attribute_count][3];
+            float steps_x[attribute_count], steps_y[attribute_count];
+
+            // Flat, GL takes it from the last (provoking) vertex
+            int shape_kind;
+            float shape_parameters[3];
+        };
+
+        thread_pool& m_pool;
+        rgba_image m_image;
+
+        size_t m_tiles_x = 0, m_tiles_y = 0;
+
+        std::vector<setup_triangle> m_triangles;
+        std::vector<std::vector<uint32_t>> m_bins; // Triangle indices per tile
+
+        // Whether a pixel center of the region (max is exclusive) can be inside
+        static bool overlaps(const setup_triangle& triangle,
+                             int min_x, int min_y, int max_x, int max_y);
+
+        void setup(const colored_vertex* corners, setup_triangle& triangle) const;
+
+        void rasterize_tile(size_t tile, blend_mode blend);
+
+        // Shades and blends /count/ pixels of a row, /start/ are attributes
+        // at the first of them
+        static void shade_span(const setup_triangle& triangle, const float* start,
+                               size_t count, uint8_t* pixels, blend_mode blend);
+    };
+
+}
@@ -0,0 +1,45 @@
+#include "software-view.h"
+#include "opengl-wrapper.h"
+#include "vec-layout.h"
+
+#include <vector>
+
+namespace gl {
+
+    software_view::software_view(thread_pool& pool)
+        : m_rasterizer(pool),
+          m_blit_shader("res/blit.glsl"),
+          m_fullscreen_triangle(math::vector_layout<float, 2>(),
+                                std::vector<float> { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }) {
+
+        m_blit_shader.uniform("image", 0);
+    }
+
+    void software_view::draw(std::span<const colored_vertex> vertices, size_t width, size_t height) {
+        if (width == 0 || height == 0)
+            return; // Minimized window
+
+        m_rasterizer.resize(width, height);
+        m_rasterizer.clear({ 0.0f, 0.0f, 0.0f, 0.0f });
+        m_rasterizer.draw(vertices);
+
+        const rgba_image& frame = m_rasterizer.get_image();
+
+        if (m_image.get_width() != width || m_image.get_height() != height) {
+            m_image.assign(width, height, texture::format::RGBA, frame.pixels.data());
+            m_image.set_filtering(texture::filtering::NEAREST);
+        } else
+            m_image.update(0, 0, width, height, frame.pixels.data());
+
+        // Frame is already blended, it's copied as is
+        gl::raw::disable(GL_BLEND);
+
+        m_image.bind(0);
+        gl::draw(drawing_type::TRIANGLES, m_fullscreen_triangle, m_blit_shader, 0, 3);
+
+        gl::raw::enable(GL_BLEND);
+    }
+
+    const software_rasterizer& software_view::get_rasterizer() const { return m_rasterizer; }
+
+}
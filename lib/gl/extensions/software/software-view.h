@@ -0,0 +1,42 @@
+#pragma once
+
+#include "colored-vertex.h"
+#include "opengl-setup.h"
+#include "software-rasterizer.h"
+#include "texture.h"
+#include "thread-pool.h"
+#include "vertex-array.h"
+
+#include <cstddef>
+#include <span>
+
+namespace gl {
+
+    // Shows software rasterizer's frames in a window: image is rasterized on
+    // CPU cores, uploaded as a texture and copied to the framebuffer with a
+    // single full-screen triangle, that's all GL is used for
+    class software_view {
+    public:
+        // Should be created on GL thread
+        explicit software_view(thread_pool& pool = thread_pool::global());
+
+        // This class shouldn't be copied or moved
+        software_view(const software_view&) = delete;
+        software_view& operator=(const software_view&) = delete;
+
+        // Replaces whatever is in the framebuffer (of size in pixels) with
+        // /vertices/ drawn over transparent black, as window clears it
+        void draw(std::span<const colored_vertex> vertices, size_t width, size_t height);
+
+        const software_rasterizer& get_rasterizer() const;
+
+    private:
+        software_rasterizer m_rasterizer;
+
+        texture m_image;
+        shaders::shader_program m_blit_shader;
+
+        vertex_array m_fullscreen_triangle;
+    };
+
+}
@@ -0,0 +1,152 @@
+#include "column-file.h"
+#include "vec-layout.h"
+#include "vertex-buffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    static_assert(sizeof(float) == 4, "Column files store float32!");
+
+    column_file::column_file(const std::string& path): m_file(path) {
+        if constexpr (std::endian::native != std::endian::little)
+            throw std::runtime_error("Column files are only supported on little-endian hosts!");
+
+        header file_header;
+        if (m_file.size() < sizeof(file_header))
+            throw std::runtime_error("Column file is too small: '" + path + "'");
+
+        std::memcpy(&file_header, m_file.data(), sizeof(file_header));
+
+        if (std::memcmp(file_header.magic, file_magic, sizeof(file_magic)) != 0)
+            throw std::runtime_error("Not a column file: '" + path + "'");
+
+        m_column_count = file_header.column_count;
+        m_row_count = file_header.row_count;
+
+        const size_t offset = file_header.data_offset;
+        if (offset % alignof(float) != 0 || offset < sizeof(file_header))
+            throw std::runtime_error("Column file has misaligned data: '" + path + "'");
+
+        // Checked so that size computation can't overflow
+        const size_t available = (m_file.size() - std::min(m_file.size(), offset)) / sizeof(float);
+        if (m_column_count != 0 && m_row_count > available / m_column_count)
+            throw std::runtime_error("Column file is truncated: '" + path + "'");
+
+        m_columns = reinterpret_cast<const float*>(m_file.data() + offset);
+
+        // Whole file is usually streamed through, chunked traversals
+        // release what they've read, so read-ahead is only beneficial
+        m_file.advise(mapped_file::access_pattern::SEQUENTIAL);
+    }
+
+    size_t column_file::get_column_count() const { return m_column_count; }
+    size_t column_file::get_row_count() const { return m_row_count; }
+
+    size_t column_file::get_column_offset(size_t index) const {
+        return (size_t) (reinterpret_cast<const std::byte*>(m_columns) - m_file.data()) +
+               index * m_row_count * sizeof(float);
+    }
+
+    std::span<const float> column_file::column(size_t index) const {
+        if (index >= m_column_count)
+            throw std::out_of_range("Column file has no such column!");
+
+        return { m_columns + index * m_row_count, m_row_count };
+    }
+
+    // ------------------------------------ CHUNKS -----------------------------------
+
+    void column_file::for_each_chunk(size_t x_column, size_t y_column,
+                                     size_t first_row, size_t row_count,
+                                     const chunk_function& process, size_t chunk_rows) const {
+
+        const std::span<const float> xs = column(x_column), ys = column(y_column);
+
+        first_row = std::min(first_row, m_row_count);
+        row_count = std::min(row_count, m_row_count - first_row);
+        chunk_rows = std::max<size_t>(chunk_rows, 1);
+
+        const size_t x_offset = get_column_offset(x_column), y_offset = get_column_offset(y_column);
+        const size_t chunk_size = chunk_rows * sizeof(float);
+
+        for (size_t row = first_row; row < first_row + row_count; row += chunk_rows) {
+            const size_t count = std::min(chunk_rows, first_row + row_count - row);
+
+            // Next chunk is read while this one is processed
+            const size_t next = (row + count) * sizeof(float);
+            m_file.prefetch(x_offset + next, chunk_size);
+            m_file.prefetch(y_offset + next, chunk_size);
+
+            process(row, xs.subspan(row, count), ys.subspan(row, count));
+
+            // Done with this chunk, it doesn't have to stay resident
+            m_file.release(x_offset + row * sizeof(float), count * sizeof(float));
+            m_file.release(y_offset + row * sizeof(float), count * sizeof(float));
+        }
+    }
+
+    void column_file::upload(vertex_array& target, size_t x_column, size_t y_column,
+                             size_t first_row, size_t row_count, size_t chunk_rows) const {
+
+        row_count = std::min(row_count, m_row_count - std::min(first_row, m_row_count));
+
+        // Vertices are drawn with int first and count
+        if (row_count > (size_t) std::numeric_limits<int>::max())
+            throw std::length_error("Too many rows to upload into one vertex array!");
+
+        const size_t column_size = row_count * sizeof(float);
+        vertex_buffer columns({ nullptr, 2 * column_size });
+
+        for_each_chunk(x_column, y_column, first_row, row_count,
+            [&](size_t row, std::span<const float> xs, std::span<const float> ys) {
+                const size_t offset = (row - first_row) * sizeof(float);
+
+                columns.update(offset, { xs.data(), xs.size_bytes() });
+                columns.update(column_size + offset, { ys.data(), ys.size_bytes() });
+            }, chunk_rows);
+
+        target.set_layout(math::vector_layout<float, 1>(2));
+        target.assign_planar(std::move(columns), row_count);
+    }
+
+    // ------------------------------------ WRITING ----------------------------------
+
+    void column_file::write(const std::string& path,
+                            std::span<const std::span<const float>> columns) {
+
+        if constexpr (std::endian::native != std::endian::little)
+            throw std::runtime_error("Column files are only supported on little-endian hosts!");
+
+        const size_t row_count = columns.empty() ? 0 : columns.front().size();
+        for (std::span<const float> current: columns)
+            if (current.size() != row_count)
+                throw std::invalid_argument("All columns should have the same length!");
+
+        header file_header {};
+        std::memcpy(file_header.magic, file_magic, sizeof(file_magic));
+
+        file_header.column_count = (uint32_t) columns.size();
+        file_header.row_count    = (uint64_t) row_count;
+        file_header.data_offset  = sizeof(file_header);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Failed to create column file: '" + path + "'");
+
+        file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+        for (std::span<const float> current: columns)
+            file.write(reinterpret_cast<const char*>(current.data()),
+                       (std::streamsize) (current.size() * sizeof(float)));
+
+        if (!file)
+            throw std::runtime_error("Failed to write column file: '" + path + "'");
+    }
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "mapped-file.h"
+#include "vertex-array.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+namespace gl {
+
+    // Binary file with float32 columns of equal length, memory mapped, so
+    // opening is instant and columns are handed out as spans without copies.
+    //
+    // Layout (little-endian):
+    //     char     magic[8]     = "VDCOLS01"
+    //     uint32_t column_count
+    //     uint32_t reserved     = 0
+    //     uint64_t row_count
+    //     uint64_t data_offset  (from file's start, multiple of 4)
+    //     float    columns[column_count][row_count] (at data_offset)
+    //
+    // Only touched pages are resident: plotting sorted columns with
+    // drawing_manager::draw_plot reads just the visible range, chunked
+    // traversals below release every chunk once they're done with it.
+    class column_file final {
+    public:
+        static constexpr size_t default_chunk_rows = 1 << 20;
+
+        using chunk_function = std::function<void(size_t first_row,
+                                                  std::span<const float> xs,
+                                                  std::span<const float> ys)>;
+
+        explicit column_file(const std::string& path);
+
+        size_t get_column_count() const;
+        size_t get_row_count() const;
+
+        // Points straight into the mapping, valid while this object lives
+        std::span<const float> column(size_t index) const;
+
+        // Calls /process/ for consecutive chunks of rows [first_row, first_row + row_count)
+        // of two columns, reading ahead next chunk and releasing previous ones
+        void for_each_chunk(size_t x_column, size_t y_column,
+                            size_t first_row, size_t row_count,
+                            const chunk_function& process,
+                            size_t chunk_rows = default_chunk_rows) const;
+
+        // Fills /target/ (that's reallocated to fit) with two columns, copied
+        // chunk by chunk straight from the mapping: x of all rows, then y (see
+        // vertex_array::assign_planar), and sets its layout to two float
+        // attributes, x at location 0 and y at 1. Throws if the range is more
+        // than a vertex array can draw or GL can allocate.
+        void upload(vertex_array& target, size_t x_column, size_t y_column,
+                    size_t first_row, size_t row_count,
+                    size_t chunk_rows = default_chunk_rows) const;
+
+        static void write(const std::string& path,
+                          std::span<const std::span<const float>> columns);
+
+    private:
+        struct header final {
+            char magic[8];
+            uint32_t column_count;
+            uint32_t reserved;
+            uint64_t row_count;
+            uint64_t data_offset;
+        };
+
+        static constexpr char file_magic[8] = { 'V', 'D', 'C', 'O', 'L', 'S', '0', '1' };
+
+        mapped_file m_file;
+
+        size_t m_column_count, m_row_count;
+        const float* m_columns;
+
+        size_t get_column_offset(size_t index) const; // In bytes
+    };
+
+}
@@ -0,0 +1,141 @@
+#include "geometry-cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace gl {
+
+    static_assert(sizeof(geometry_cache::attribute) == 12 && sizeof(geometry_cache::range) == 16,
+                  "Geometry cache records shouldn't have padding!");
+
+    geometry_cache::geometry_cache(const std::string& path): m_file(path) {
+        header file_header;
+        if (m_file.size() < sizeof(file_header))
+            throw std::runtime_error("Geometry cache is too small: '" + path + "'");
+
+        std::memcpy(&file_header, m_file.data(), sizeof(file_header));
+
+        if (std::memcmp(file_header.magic, file_magic, sizeof(file_magic)) != 0)
+            throw std::runtime_error("Not a geometry cache: '" + path + "'");
+
+        if (file_header.version != version)
+            throw std::runtime_error("Geometry cache has unsupported version " +
+                                     std::to_string(file_header.version) + ": '" + path + "'");
+
+        m_vertex_size  = file_header.vertex_size;
+        m_vertex_count = file_header.vertex_count;
+
+        // ==> Tables follow the header, records are 4-byte aligned like it is:
+
+        const size_t tables_size = file_header.attribute_count * sizeof(attribute) +
+                                   file_header.range_count * sizeof(range);
+
+        const size_t offset = file_header.vertex_offset;
+        if (offset % page_alignment != 0 || offset < sizeof(file_header) + tables_size)
+            throw std::runtime_error("Geometry cache has misaligned data: '" + path + "'");
+
+        // Checked so that size computation can't overflow
+        const size_t available = m_file.size() - std::min(m_file.size(), offset);
+        if (offset > m_file.size() || (m_vertex_size != 0 && m_vertex_count > available / m_vertex_size))
+            throw std::runtime_error("Geometry cache is truncated: '" + path + "'");
+
+        const std::byte* tables = m_file.data() + sizeof(file_header);
+
+        m_attributes = { reinterpret_cast<const attribute*>(tables), file_header.attribute_count };
+        m_ranges = { reinterpret_cast<const range*>(tables + m_attributes.size_bytes()),
+                     file_header.range_count };
+
+        for (const range& current: m_ranges)
+            if (current.first > m_vertex_count || current.count > m_vertex_count - current.first)
+                throw std::runtime_error("Geometry cache has a range out of bounds: '" + path + "'");
+
+        m_vertices = m_file.data() + offset;
+
+        // Everything is uploaded at once, from start to end
+        m_file.advise(mapped_file::access_pattern::SEQUENTIAL);
+    }
+
+    size_t geometry_cache::get_vertex_count() const { return m_vertex_count; }
+
+    std::span<const geometry_cache::range> geometry_cache::get_ranges() const { return m_ranges; }
+
+    void geometry_cache::validate(const vertex_layout& layout, size_t vertex_size) const {
+        if (vertex_size != m_vertex_size || layout.get_stride() != m_vertex_size)
+            throw std::runtime_error("Geometry cache was written for vertices of another size!");
+
+        const std::vector<vertex>& elements = layout.get_elements();
+
+        bool is_same = elements.size() == m_attributes.size();
+        for (size_t i = 0; i < elements.size() && is_same; ++ i)
+            is_same = elements[i].get_type_id() == m_attributes[i].type_id &&
+                      elements[i].get_count()   == m_attributes[i].count   &&
+                      elements[i].get_size()    == m_attributes[i].size;
+
+        if (!is_same)
+            throw std::runtime_error("Geometry cache was written with another vertex layout!");
+    }
+
+    void geometry_cache::upload(vertex_array& target) const {
+        validate(target.get_layout(), m_vertex_size);
+
+        const size_t size = m_vertex_count * m_vertex_size;
+        target.assign(vertex_buffer({ m_vertices, size }), m_vertex_count);
+
+        // Driver has its own copy, pages can go
+        m_file.release((size_t) (m_vertices - m_file.data()), size);
+    }
+
+    // ------------------------------------ WRITING ----------------------------------
+
+    void geometry_cache::write(const std::string& path, const vertex_layout& layout,
+                               raw_data vertices, std::span<const range> ranges) {
+
+        const size_t vertex_size = layout.get_stride();
+        if (vertex_size == 0 || vertices.size % vertex_size != 0)
+            throw std::invalid_argument("Vertices don't match geometry cache's layout!");
+
+        const size_t vertex_count = vertices.size / vertex_size;
+        for (const range& current: ranges)
+            if (current.first > vertex_count || current.count > vertex_count - current.first)
+                throw std::out_of_range("Geometry cache range is out of bounds!");
+
+        std::vector<attribute> attributes;
+        for (const vertex& element: layout.get_elements())
+            attributes.push_back({ element.get_type_id(), (uint32_t) element.get_count(),
+                                   (uint32_t) element.get_size() });
+
+        header file_header {};
+        std::memcpy(file_header.magic, file_magic, sizeof(file_magic));
+
+        file_header.version         = version;
+        file_header.vertex_size     = (uint32_t) vertex_size;
+        file_header.attribute_count = (uint32_t) attributes.size();
+        file_header.range_count     = (uint32_t) ranges.size();
+        file_header.vertex_count    = (uint64_t) vertex_count;
+
+        const size_t tables_end = sizeof(file_header) + attributes.size() * sizeof(attribute) +
+                                  ranges.size_bytes();
+
+        file_header.vertex_offset = (tables_end + page_alignment - 1) / page_alignment * page_alignment;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Failed to create geometry cache: '" + path + "'");
+
+        const std::vector<char> padding(file_header.vertex_offset - tables_end, 0);
+
+        file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+        file.write(reinterpret_cast<const char*>(attributes.data()),
+                   (std::streamsize) (attributes.size() * sizeof(attribute)));
+        file.write(reinterpret_cast<const char*>(ranges.data()), (std::streamsize) ranges.size_bytes());
+        file.write(padding.data(), (std::streamsize) padding.size());
+        file.write(static_cast<const char*>(vertices.data), (std::streamsize) vertices.size);
+
+        if (!file)
+            throw std::runtime_error("Failed to write geometry cache: '" + path + "'");
+    }
+
+}
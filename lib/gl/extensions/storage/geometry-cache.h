@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mapped-file.h"
+#include "vertex-array.h"
+#include "vertex-buffer.h"
+#include "vertex-layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace gl {
+
+    // Binary file with already tessellated vertices and ranges to draw them
+    // with, memory mapped, so loading doesn't parse or touch any vertex: they
+    // are handed out as a span or uploaded straight from the mapping.
+    //
+    // Layout (native byte order, made for the same kind of machine):
+    //     char     magic[8]        = "VDGEOM\0\0"
+    //     uint32_t version         = 1
+    //     uint32_t vertex_size
+    //     uint32_t attribute_count
+    //     uint32_t range_count
+    //     uint64_t vertex_count
+    //     uint64_t vertex_offset   (from file's start, multiple of page_alignment)
+    //     attribute attributes[attribute_count]
+    //     range     ranges[range_count]
+    //     vertices  (at vertex_offset)
+    //
+    // Vertex data is page aligned, so the mapping can be handed to the driver
+    // directly and only the pages of vertices that are used are read.
+    class geometry_cache final {
+    public:
+        static constexpr uint32_t version = 1;
+        static constexpr size_t page_alignment = 4096;
+
+        // Element of vertex_layout (see gl::vertex)
+        struct attribute final {
+            uint32_t type_id, count, size;
+        };
+
+        // Vertices [first, first + count) are drawn with /state/ (its meaning
+        // is up to the user, e.g. draw_state bits of command_list)
+        struct range final {
+            uint32_t state;
+            uint32_t first, count;
+            uint32_t is_opaque;
+        };
+
+        // Maps the file and checks its header, throws if it's malformed
+        explicit geometry_cache(const std::string& path);
+
+        size_t get_vertex_count() const;
+        std::span<const range> get_ranges() const;
+
+        // Throws unless stored layout is /layout/ and vertices are /vertex_type/,
+        // so that stale caches aren't drawn as garbage after type changes
+        void validate(const vertex_layout& layout, size_t vertex_size) const;
+
+        // Points straight into the mapping, valid while this object lives
+        template <typename vertex_type>
+        std::span<const vertex_type> get_vertices(const vertex_layout& layout) const {
+            validate(layout, sizeof(vertex_type));
+            return { reinterpret_cast<const vertex_type*>(m_vertices), m_vertex_count };
+        }
+
+        // Uploads vertices into /target/ (whose layout they must match) with a
+        // single buffer upload from the mapping
+        void upload(vertex_array& target) const;
+
+        static void write(const std::string& path, const vertex_layout& layout,
+                          raw_data vertices, std::span<const range> ranges);
+
+    private:
+        struct header final {
+            char magic[8];
+
+            uint32_t version;
+            uint32_t vertex_size;
+            uint32_t attribute_count;
+            uint32_t range_count;
+
+            uint64_t vertex_count;
+            uint64_t vertex_offset;
+        };
+
+        static constexpr char file_magic[8] = { 'V', 'D', 'G', 'E', 'O', 'M', '\0', '\0' };
+
+        mapped_file m_file;
+
+        size_t m_vertex_size = 0, m_vertex_count = 0;
+
+        std::span<const attribute> m_attributes;
+        std::span<const range> m_ranges;
+        const std::byte* m_vertices = nullptr;
+    };
+
+}
@@ -0,0 +1,127 @@
+#include "mapped-file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gl {
+
+    static std::runtime_error system_error(const std::string& message, const std::string& path) {
+        return std::runtime_error(message + " '" + path + "': " + std::strerror(errno));
+    }
+
+    mapped_file::mapped_file(const std::string& path) {
+        const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor == -1)
+            throw system_error("Failed to open", path);
+
+        struct stat status;
+        if (fstat(descriptor, &status) == -1) {
+            close(descriptor);
+            throw system_error("Failed to stat", path);
+        }
+
+        m_size = (size_t) status.st_size;
+
+        // Zero-sized mappings aren't allowed, empty file is just empty
+        if (m_size != 0) {
+            void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping == MAP_FAILED) {
+                close(descriptor);
+                throw system_error("Failed to map", path);
+            }
+
+            m_data = static_cast<std::byte*>(mapping);
+        }
+
+        // Mapping stays valid after descriptor is closed
+        close(descriptor);
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)) {}
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+        if (this != &other) {
+            unmap();
+
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+
+        return *this;
+    }
+
+    const std::byte* mapped_file::data() const noexcept { return m_data; }
+    size_t mapped_file::size() const noexcept { return m_size; }
+
+    // ------------------------------------ PAGING -----------------------------------
+
+    static void advise_range(std::byte* data, size_t size, size_t offset, size_t length,
+                             int advice, bool whole_pages_only = false) {
+        if (data == nullptr || offset >= size)
+            return;
+
+        size_t end = offset + std::min(length, size - offset);
+
+        // madvise wants page-aligned start, either extend range to pages
+        // it touches, or shrink it to pages that are completely inside
+        const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+
+        if (whole_pages_only) {
+            offset = (offset + page_size - 1) / page_size * page_size;
+            end = end == size ? end : end / page_size * page_size;
+        } else
+            offset = offset / page_size * page_size;
+
+        if (offset >= end)
+            return;
+
+        // Hints are just hints, there's nothing to do if they fail
+        (void) madvise(data + offset, end - offset, advice);
+    }
+
+    void mapped_file::advise(access_pattern pattern) const {
+        int advice = MADV_NORMAL;
+        switch (pattern) {
+        case access_pattern::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+        case access_pattern::RANDOM:     advice = MADV_RANDOM;     break;
+        case access_pattern::NORMAL:     advice = MADV_NORMAL;     break;
+
+        default: break;
+        }
+
+        advise_range(m_data, m_size, 0, m_size, advice);
+    }
+
+    void mapped_file::prefetch(size_t offset, size_t length) const {
+        advise_range(m_data, m_size, offset, length, MADV_WILLNEED);
+    }
+
+    void mapped_file::release(size_t offset, size_t length) const {
+        // For a private read-only mapping pages are never dirty, so
+        // dropping them is safe, they'll be read from file again if needed.
+        // Pages shared with neighbouring ranges are kept, they may be in use.
+        advise_range(m_data, m_size, offset, length, MADV_DONTNEED, true);
+    }
+
+    // ----------------------------------- CLEANUP -----------------------------------
+
+    void mapped_file::unmap() noexcept {
+        if (m_data != nullptr)
+            munmap(m_data, m_size);
+
+        m_data = nullptr, m_size = 0;
+    }
+
+    mapped_file::~mapped_file() { unmap(); }
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace gl {
+
+    // Read-only memory mapping of a whole file. Mapping is instant no matter
+    // the size, pages are read in when they are first touched, and can be
+    // dropped again with release (they're re-read if touched after that).
+    class mapped_file final {
+    public:
+        enum class access_pattern {
+            NORMAL, SEQUENTIAL, RANDOM
+        };
+
+        explicit mapped_file(const std::string& path);
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept;
+        mapped_file& operator=(mapped_file&& other) noexcept;
+
+        const std::byte* data() const noexcept;
+        size_t size() const noexcept;
+
+        // ==> Paging hints (ranges are in bytes):
+
+        void advise(access_pattern pattern) const;
+
+        // Starts reading range in the background
+        void prefetch(size_t offset, size_t length) const;
+
+        // Lets kernel drop resident pages that lie completely inside range
+        void release(size_t offset, size_t length) const;
+
+        ~mapped_file();
+
+    private:
+        std::byte* m_data = nullptr;
+        size_t m_size = 0;
+
+        void unmap() noexcept;
+    };
+
+}
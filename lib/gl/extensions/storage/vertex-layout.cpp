@@ -43,9 +43,23 @@ namespace gl {
         return *this;
     }
 
+    const std::vector<vertex>& vertex_layout::get_elements() const { return vertices; }
+
+    size_t vertex_layout::get_stride() const {
+        size_t stride = 0;
+        for (const vertex& element: vertices)
+            stride += element.get_size();
+
+        return stride;
+    }
+
     // --------------------------------- VERTEX LAYOUT ---------------------------------
 
     vertex::vertex(const unsigned int type_id, const size_t count, const size_t size):
         type_id(type_id), count(count), size(size) {};
 
+    unsigned int vertex::get_type_id() const { return type_id; }
+    size_t vertex::get_count() const { return count; }
+    size_t vertex::get_size()  const { return size;  }
+
 };
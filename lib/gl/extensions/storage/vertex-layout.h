@@ -23,6 +23,12 @@ namespace gl {
 
         operator vertex_layout();
 
+        unsigned int get_type_id() const;
+        size_t get_count() const; // Components, e.g. 2 for vec2
+        size_t get_size()  const; // In bytes
+
+        bool operator==(const vertex& other) const = default;
+
         friend class vertex_array;
     };
 
@@ -38,6 +44,11 @@ namespace gl {
 
         vertex_layout& operator+(const vertex_layout& other);
 
+        const std::vector<vertex>& get_elements() const;
+        size_t get_stride() const; // Size of a whole vertex in bytes
+
+        bool operator==(const vertex_layout& other) const = default;
+
         friend class vertex_array;
     };
 
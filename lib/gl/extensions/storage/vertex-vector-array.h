@@ -1,18 +1,24 @@
 #pragma once
 
+#include "high-water-mark.h"
 #include "vertex-array.h"
 #include "vertex-buffer.h"
 #include "vertex-layout.h"
 
+#include <memory>
+#include <memory_resource>
 #include <vector>
 
 namespace gl {
 
-    template <typename value_type>
-    class vertex_vector_array: public std::vector<value_type> {
+    template <typename value_type, typename allocator_type = std::allocator<value_type>>
+    class vertex_vector_array: public std::vector<value_type, allocator_type> {
     public:
         vertex_vector_array(): m_element_array_holder() {}
 
+        explicit vertex_vector_array(const allocator_type& allocator)
+            : std::vector<value_type, allocator_type>(allocator), m_element_array_holder() {}
+
         void set_layout(gl::vertex_layout layout) {
             m_element_array_holder.set_layout(layout);
         }
@@ -24,12 +30,40 @@ namespace gl {
         void update() { m_element_array_holder.assign(*this); }
 
         void assign_and_update(std::initializer_list<value_type> init) {
-            std::vector<value_type>::assign(init);
+            std::vector<value_type, allocator_type>::assign(init);
             update();
         }
 
+        // ==> Shrink policy, for arrays that are refilled every frame:
+
+        // Clears the array for the next frame. Capacity stays, unless it's
+        // more than twice the largest size of the last /window/ frames,
+        // then it's cut down to that size (memory of spikes is given back).
+        void clear_frame() {
+            m_high_water.push(this->size());
+            this->clear();
+
+            const size_t peak = m_high_water.get();
+            if (this->capacity() > 2 * peak) {
+                this->shrink_to_fit();
+                this->reserve(peak);
+            }
+        }
+
+        void set_shrink_window(size_t window) { m_high_water = high_water_mark(window); }
+
     private:
         vertex_array m_element_array_holder;
+        high_water_mark m_high_water;
     };
 
+    namespace pmr {
+
+        // E.g. with a frame_arena, for vertices that live only a frame
+        template <typename value_type>
+        using vertex_vector_array =
+            gl::vertex_vector_array<value_type, std::pmr::polymorphic_allocator<value_type>>;
+
+    }
+
 };
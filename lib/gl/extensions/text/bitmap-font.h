@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Tiny bundled bitmap font, so text doesn't need any font files or
+// rasterization libraries. It's turned into a distance field atlas
+// (see glyph-atlas.h), which keeps it smooth at any size.
+namespace gl::bitmap_font {
+
+    constexpr size_t glyph_width = 5, glyph_height = 7;
+    constexpr char first_character = ' ', last_character = '~';
+
+    // Rows of character's glyph (unsupported characters look like '?')
+    const uint8_t* get_glyph(char character);
+
+    bool is_set(char character, size_t x, size_t y);
+
+}
@@ -0,0 +1,104 @@
+#include "glyph-atlas.h"
+#include "bitmap-font.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace gl {
+
+    namespace {
+
+        using namespace bitmap_font;
+
+        constexpr size_t glyph_count = last_character - first_character + 1;
+
+        constexpr size_t cell_width  = glyph_width  * glyph_atlas::scale + 2 * glyph_atlas::spread;
+        constexpr size_t cell_height = glyph_height * glyph_atlas::scale + 2 * glyph_atlas::spread;
+
+        // Distance from point to a unit square of font's pixel at (x, y)
+        float distance_to_pixel(float px, float py, float x, float y) {
+            const float dx = std::max({ x - px, 0.0f, px - (x + 1.0f) });
+            const float dy = std::max({ y - py, 0.0f, py - (y + 1.0f) });
+
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        // Signed distance (negative inside) from point to glyph's outline,
+        // in font's pixels, glyph is exact union of its set pixels
+        float glyph_distance(char character, float px, float py) {
+            const bool is_outside_box = px < 0.0f || py < 0.0f ||
+                px >= (float) glyph_width || py >= (float) glyph_height;
+
+            const bool is_inside = !is_outside_box &&
+                is_set(character, (size_t) px, (size_t) py);
+
+            float nearest = std::numeric_limits<float>::infinity();
+
+            // Nearest pixel of the other kind, box edge counts as unset
+            if (is_inside)
+                nearest = std::min({ px, py, (float) glyph_width - px, (float) glyph_height - py });
+
+            for (size_t y = 0; y < glyph_height; ++ y)
+                for (size_t x = 0; x < glyph_width; ++ x)
+                    if (is_set(character, x, y) != is_inside)
+                        nearest = std::min(nearest, distance_to_pixel(px, py, (float) x, (float) y));
+
+            return is_inside ? -nearest : nearest;
+        }
+
+    }
+
+    void glyph_atlas::render(std::vector<uint8_t>& pixels, size_t& width, size_t& height) {
+        const size_t rows = (glyph_count + columns - 1) / columns;
+
+        width = columns * cell_width, height = rows * cell_height;
+        pixels.assign(width * height, 0);
+
+        for (size_t i = 0; i < glyph_count; ++ i) {
+            const char character = (char) (first_character + (char) i);
+            const size_t cell_x = i % columns * cell_width, cell_y = i / columns * cell_height;
+
+            for (size_t y = 0; y < cell_height; ++ y)
+                for (size_t x = 0; x < cell_width; ++ x) {
+                    // Texel's center in font's pixels
+                    const float px = ((float) x + 0.5f - (float) spread) / (float) scale;
+                    const float py = ((float) y + 0.5f - (float) spread) / (float) scale;
+
+                    const float distance = glyph_distance(character, px, py) * (float) scale;
+                    const float value = std::clamp(0.5f - distance / (2.0f * (float) spread), 0.0f, 1.0f);
+
+                    pixels[(cell_y + y) * width + cell_x + x] = (uint8_t) std::lround(value * 255.0f);
+                }
+        }
+    }
+
+    glyph_atlas::glyph_atlas() {
+        std::vector<uint8_t> pixels;
+        size_t width = 0, height = 0;
+
+        render(pixels, width, height);
+        m_texture.assign(width, height, texture::format::RED, pixels.data());
+
+        for (size_t i = 0; i < glyph_count; ++ i) {
+            const float x = (float) (i % columns * cell_width);
+            const float y = (float) (i / columns * cell_height);
+
+            // Rows go from the top of the glyph, so v grows downwards
+            m_coordinates.push_back({
+                x / (float) width, y / (float) height,
+                (x + (float) cell_width) / (float) width, (y + (float) cell_height) / (float) height
+            });
+        }
+    }
+
+    const glyph_atlas::glyph_coordinates& glyph_atlas::get_coordinates(char character) const {
+        if (character < first_character || character > last_character)
+            character = '?';
+
+        return m_coordinates[(size_t) (character - first_character)];
+    }
+
+    const texture& glyph_atlas::get_texture() const { return m_texture; }
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "texture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+    // Signed distance field of every glyph of the bundled font, rendered once
+    // into a single-channel texture. Texel is 0.5 on glyph's outline, larger
+    // inside of it, so a shader can antialias text at any scale.
+    //
+    // Metrics are in font's pixels (glyph is 5x7 of them), each glyph's quad
+    // extends /padding/ of them outside of the glyph, so the falloff fits.
+    class glyph_atlas {
+    public:
+        static constexpr size_t scale = 4;   // Atlas texels per font pixel
+        static constexpr size_t spread = 6;  // Distances are clamped to that (in texels)
+
+        static constexpr float padding = (float) spread / (float) scale;
+
+        static constexpr float advance     = 6.0f; // Between consecutive glyphs
+        static constexpr float line_height = 9.0f; // Between consecutive lines
+
+        struct glyph_coordinates final {
+            float u0, v0, u1, v1;
+        };
+
+        // Renders and uploads atlas, should be created on GL thread
+        glyph_atlas();
+
+        const glyph_coordinates& get_coordinates(char character) const;
+        const texture& get_texture() const;
+
+        // CPU part of construction, fills row-major single-channel image
+        static void render(std::vector<uint8_t>& pixels, size_t& width, size_t& height);
+
+    private:
+        static constexpr size_t columns = 16;
+
+        texture m_texture;
+        std::vector<glyph_coordinates> m_coordinates;
+    };
+
+}
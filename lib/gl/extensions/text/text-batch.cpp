@@ -0,0 +1,117 @@
+#include "text-batch.h"
+#include "bitmap-font.h"
+#include "vec-layout.h"
+
+#include <algorithm>
+
+namespace gl {
+
+    text_batch::text_batch(): m_shader("res/text.glsl") {
+        m_vertices.set_layout(math::vector_layout<float, 2>() +
+                              math::vector_layout<float, 2>() +
+                              math::vector_layout<float, 4>());
+
+        m_shader.uniform("atlas", 0);
+    }
+
+    // ------------------------------------ SHAPING ----------------------------------
+
+    const text_batch::shaped_text& text_batch::shape(std::string_view text) {
+        if (auto found = m_cache.find(text); found != m_cache.end())
+            return found->second;
+
+        if (m_cache.size() >= max_cached_strings)
+            m_cache.clear();
+
+        constexpr float padding = glyph_atlas::padding;
+
+        shaped_text shaped { {}, 0.0f, 0.0f };
+
+        float x = 0.0f, y = 0.0f;
+        for (char character: text) {
+            if (character == '\n') {
+                x = 0.0f, y += glyph_atlas::line_height;
+                continue;
+            }
+
+            // Spaces have nothing to draw, but still move the pen
+            if (character != ' ')
+                shaped.glyphs.push_back({
+                    x - padding, y - padding,
+                    x + (float) bitmap_font::glyph_width  + padding,
+                    y + (float) bitmap_font::glyph_height + padding,
+                    m_atlas.get_coordinates(character)
+                });
+
+            x += glyph_atlas::advance;
+
+            // Last advance includes spacing, box ends with the glyph itself
+            shaped.width = std::max(shaped.width, x - (glyph_atlas::advance - bitmap_font::glyph_width));
+        }
+
+        shaped.height = y + (float) bitmap_font::glyph_height;
+
+        return m_cache.emplace(std::string(text), std::move(shaped)).first->second;
+    }
+
+    math::vec2 text_batch::measure(std::string_view text) {
+        const shaped_text& shaped = shape(text);
+        return { shaped.width, shaped.height };
+    }
+
+    // ------------------------------------ BATCHING ---------------------------------
+
+    void text_batch::add(const math::vec2 position, std::string_view text, float size,
+                         math::vec4 color, const math::vec2 anchor,
+                         size_t viewport_width, size_t viewport_height) {
+
+        if (text.empty() || viewport_width == 0 || viewport_height == 0)
+            return;
+
+        const shaped_text& shaped = shape(text);
+
+        // Font pixels to view coordinates (view is 2 units across, y goes up)
+        const float pixel = size / (float) bitmap_font::glyph_height;
+        const float scale_x =  pixel * 2.0f / (float) viewport_width;
+        const float scale_y = -pixel * 2.0f / (float) viewport_height;
+
+        const float origin_x = position.x() - anchor.x() * shaped.width  * scale_x;
+        const float origin_y = position.y() - anchor.y() * shaped.height * scale_y;
+
+        m_vertices.reserve(m_vertices.size() + shaped.glyphs.size() * 6);
+
+        for (const shaped_glyph& glyph: shaped.glyphs) {
+            const float x0 = origin_x + glyph.x0 * scale_x, y0 = origin_y + glyph.y0 * scale_y;
+            const float x1 = origin_x + glyph.x1 * scale_x, y1 = origin_y + glyph.y1 * scale_y;
+
+            const glyph_atlas::glyph_coordinates& uv = glyph.coordinates;
+
+            const text_vertex top_left     { { x0, y0 }, { uv.u0, uv.v0 }, color };
+            const text_vertex top_right    { { x1, y0 }, { uv.u1, uv.v0 }, color };
+            const text_vertex bottom_left  { { x0, y1 }, { uv.u0, uv.v1 }, color };
+            const text_vertex bottom_right { { x1, y1 }, { uv.u1, uv.v1 }, color };
+
+            m_vertices.insert(m_vertices.end(), {
+                top_left, top_right, bottom_right,
+                top_left, bottom_right, bottom_left
+            });
+        }
+    }
+
+    void text_batch::draw() {
+        if (m_vertices.empty())
+            return;
+
+        m_atlas.get_texture().bind(0);
+
+        m_vertices.update();
+        gl::draw(drawing_type::TRIANGLES, m_vertices, m_shader);
+
+        clear();
+    }
+
+    void text_batch::clear() { m_vertices.clear(); }
+
+    size_t text_batch::get_glyph_count() const { return m_vertices.size() / 6; }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "glyph-atlas.h"
+#include "opengl-setup.h"
+#include "vec.h"
+#include "vertex-vector-array.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gl {
+
+    struct text_vertex final {
+        math::vec<float, 2> point; // In view coordinates
+        math::vec<float, 2> uv;    // In glyph atlas
+        math::vec<float, 4> color;
+
+        text_vertex()
+            : point(0.0f, 0.0f), uv(0.0f, 0.0f), color(0.0f, 0.0f, 0.0f, 0.0f) {}
+
+        text_vertex(math::vec<float, 2> new_point, math::vec<float, 2> new_uv,
+                    math::vec<float, 4> new_color)
+            : point(new_point), uv(new_uv), color(new_color) {}
+    };
+
+    // Collects all text of a frame and draws it with a single textured-quad
+    // draw call. Strings are shaped (laid out into glyph quads) once and
+    // cached, so repeated labels (e.g. ticks) are just scaled and copied.
+    // Must be created and drawn on GL thread, adding text has no GL calls.
+    class text_batch {
+    public:
+        text_batch();
+
+        // This class shouldn't be copied or moved
+        text_batch(const text_batch&) = delete;
+        text_batch& operator=(const text_batch&) = delete;
+
+        // Adds /text/ (can have '\n') at /position/ (view coordinates) with
+        // glyphs /size/ pixels tall. /anchor/ is the point of the text's box
+        // that lands on /position/: (0, 0) is top left, (1, 1) is bottom right.
+        void add(math::vec2 position, std::string_view text, float size,
+                 math::vec4 color, math::vec2 anchor,
+                 size_t viewport_width, size_t viewport_height);
+
+        // Size of text's box in font pixels (multiply by size / 7 for screen pixels)
+        math::vec2 measure(std::string_view text);
+
+        // Uploads and draws everything added since the last draw, then clears
+        void draw();
+        void clear();
+
+        size_t get_glyph_count() const;
+
+    private:
+        // Cache is dropped when it grows bigger than that, labels that
+        // are still in use get shaped again on the next frame
+        static constexpr size_t max_cached_strings = 4096;
+
+        struct shaped_glyph final {
+            float x0, y0, x1, y1; // In font pixels from text's top left corner
+            glyph_atlas::glyph_coordinates coordinates;
+        };
+
+        struct shaped_text final {
+            std::vector<shaped_glyph> glyphs;
+            float width, height;
+        };
+
+        // Lets cache be searched by std::string_view without a copy
+        struct string_hash final {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view text) const {
+                return std::hash<std::string_view>{}(text);
+            }
+        };
+
+        glyph_atlas m_atlas;
+        shaders::shader_program m_shader;
+
+        vertex_vector_array<text_vertex> m_vertices;
+
+        std::unordered_map<std::string, shaped_text, string_hash, std::equal_to<>> m_cache;
+
+        const shaped_text& shape(std::string_view text);
+    };
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace gl {
+
+    // Bounded lock-free queue for exactly one producer and one consumer thread.
+    // Neither side ever blocks: push fails when queue is full, pop when empty.
+    template <typename value_type, size_t capacity>
+    class spsc_queue {
+        static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                      "Capacity should be a power of two!");
+
+    public:
+        spsc_queue() = default;
+
+        // This class shouldn't be copied or moved
+        spsc_queue(const spsc_queue&) = delete;
+        spsc_queue& operator=(const spsc_queue&) = delete;
+
+        // ==> Producer side:
+
+        // Fails if fewer than /keep_free/ slots would be left after push,
+        // so that less important values leave room for the others
+        bool try_push(const value_type& value, size_t keep_free = 0) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cached_head + keep_free >= capacity) {
+                m_cached_head = m_head.load(std::memory_order_acquire);
+
+                if (tail - m_cached_head + keep_free >= capacity)
+                    return false; // Still full
+            }
+
+            m_items[tail & (capacity - 1)] = value;
+            m_tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // ==> Consumer side:
+
+        bool try_pop(value_type& value) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cached_tail) {
+                m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+                if (head == m_cached_tail)
+                    return false; // Still empty
+            }
+
+            value = m_items[head & (capacity - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Approximate, exact only when called from one of the two threads
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) ==
+                   m_tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr size_t cache_line_size = 64;
+
+        // Head and tail are kept on separate cache lines, each side also
+        // caches other side's index to avoid touching its line on every call
+        alignas(cache_line_size) std::atomic<size_t> m_head { 0 };
+        size_t m_cached_tail = 0; // Consumer's copy
+
+        alignas(cache_line_size) std::atomic<size_t> m_tail { 0 };
+        size_t m_cached_head = 0; // Producer's copy
+
+        alignas(cache_line_size) std::array<value_type, capacity> m_items {};
+    };
+
+}
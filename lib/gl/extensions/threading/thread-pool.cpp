@@ -0,0 +1,136 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace gl {
+
+    // Set in worker threads, and in calling thread while it runs its share
+    // of a loop: loops submitted from them run serially, otherwise nested
+    // parallel_for would wait for itself (or relock m_submit_mutex) forever
+    static thread_local bool is_pool_worker = false;
+
+    thread_pool::thread_pool(size_t thread_count) {
+        if (thread_count == 0)
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+        // Calling thread is also a worker, so spawn one thread less
+        for (size_t i = 0; i + 1 < thread_count; ++ i)
+            m_workers.emplace_back(&thread_pool::worker_loop, this);
+    }
+
+    size_t thread_pool::size() const noexcept {
+        return m_workers.size() + 1;
+    }
+
+    thread_pool& thread_pool::global() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    void thread_pool::run_iterations(const task_type& task, size_t count) {
+        size_t index = 0;
+        while ((index = m_next_index.fetch_add(1, std::memory_order_relaxed)) < count) {
+            try {
+                task(index);
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+                if (!m_exception)
+                    m_exception = std::current_exception();
+
+                // Skip the rest of the loop, it's going to fail anyway
+                m_next_index.store(count, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void thread_pool::worker_loop() {
+        is_pool_worker = true;
+
+        size_t seen_generation = 0;
+        while (true) {
+            const task_type* task = nullptr;
+            size_t count = 0;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_job_posted.wait(lock, [&] {
+                    return m_stopping || m_generation != seen_generation;
+                });
+
+                if (m_stopping)
+                    return;
+
+                seen_generation = m_generation;
+
+                // Woke up too late, loop has already been finished by others
+                if (m_task == nullptr)
+                    continue;
+
+                // Loop can't finish (and be replaced) while we are busy,
+                // so it's safe to keep using this snapshot without a lock
+                task = m_task, count = m_count;
+                ++ m_busy_workers;
+            }
+
+            run_iterations(*task, count);
+
+            std::lock_guard lock(m_mutex);
+            if (-- m_busy_workers == 0)
+                m_job_done.notify_all();
+        }
+    }
+
+    void thread_pool::parallel_for(size_t count, const task_type& task) {
+        if (count == 0)
+            return;
+
+        if (is_pool_worker || m_workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++ i)
+                task(i);
+
+            return;
+        }
+
+        std::lock_guard submit_lock(m_submit_mutex);
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            m_task = &task, m_count = count;
+            m_next_index.store(0, std::memory_order_relaxed);
+
+            m_exception = nullptr;
+            ++ m_generation;
+        }
+
+        m_job_posted.notify_all();
+
+        // Iterations that call parallel_for again (e.g. decimation inside
+        // a parallel_recorder panel) have to know they're already in a loop
+        const bool was_pool_worker = std::exchange(is_pool_worker, true);
+        run_iterations(task, count);
+        is_pool_worker = was_pool_worker;
+
+        std::unique_lock lock(m_mutex);
+
+        // Some workers may still be finishing their last iterations
+        m_job_done.wait(lock, [&] { return m_busy_workers == 0; });
+        m_task = nullptr;
+
+        if (m_exception)
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_job_posted.notify_all();
+        for (std::thread& worker: m_workers)
+            worker.join();
+    }
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gl {
+
+    // Fixed set of worker threads that execute data-parallel loops. Every
+    // loop is blocking: caller participates in it and returns only after all
+    // iterations are done, so no futures or task handles are ever needed.
+    class thread_pool {
+    public:
+        using task_type = std::function<void(size_t)>;
+
+        // Zero means "use every available core"
+        explicit thread_pool(size_t thread_count = 0);
+
+        // This class shouldn't be copied or moved
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        // Calls task(i) for every i in [0, count) and waits for completion,
+        // first exception thrown by any of the iterations is rethrown here.
+        void parallel_for(size_t count, const task_type& task);
+
+        // Same for any callable, it's passed by reference, so loops don't
+        // allocate (std::function would copy big lambdas to the heap)
+        template <typename function_type>
+        void parallel_for(size_t count, const function_type& task) {
+            parallel_for(count, task_type(std::cref(task)));
+        }
+
+        // Number of threads working on a loop (including calling thread)
+        size_t size() const noexcept;
+
+        // Lazily created pool shared by the whole library
+        static thread_pool& global();
+
+        ~thread_pool();
+
+    private:
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_job_posted, m_job_done;
+
+        // Serializes loops submitted from different threads
+        std::mutex m_submit_mutex;
+
+        // ==> Currently executed loop:
+
+        const task_type* m_task = nullptr;
+        size_t m_count = 0;
+
+        std::atomic<size_t> m_next_index { 0 };
+        size_t m_busy_workers = 0;
+
+        size_t m_generation = 0;
+        bool m_stopping = false;
+
+        std::exception_ptr m_exception;
+
+        void worker_loop();
+        void run_iterations(const task_type& task, size_t count);
+    };
+
+}
@@ -0,0 +1,130 @@
+#include "upload-service.h"
+#include "fence.h"
+#include "gpu-resources.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    upload_service::upload_service(GLFWwindow* shared_window, std::function<void()> on_completed)
+        : m_context(nullptr), m_on_completed(std::move(on_completed)) {
+
+        // Context needs a window, but nobody has to see it
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_context = glfwCreateWindow(1, 1, "", NULL, shared_window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        if (m_context == NULL)
+            throw std::runtime_error("Failed to create upload context!");
+
+        m_worker = std::thread(&upload_service::worker_loop, this);
+    }
+
+    // ---------------------------------- SUBMISSION ---------------------------------
+
+    void upload_service::submit(raw_data data, completion_function done) {
+        submit_job({ data, nullptr, std::move(done) });
+    }
+
+    void upload_service::submit_job(job new_job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_queued.push_back(std::make_unique<job>(std::move(new_job)));
+            ++ m_pending;
+        }
+
+        m_job_posted.notify_one();
+    }
+
+    size_t upload_service::get_pending_count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending;
+    }
+
+    void upload_service::collect() {
+        std::deque<std::unique_ptr<job>> completed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            completed.swap(m_completed);
+            m_pending -= completed.size();
+        }
+
+        std::exception_ptr first_error;
+        for (std::unique_ptr<job>& current: completed) {
+            if (current->error) {
+                if (!first_error)
+                    first_error = current->error;
+
+                continue;
+            }
+
+            current->done(std::move(*current->result));
+        }
+
+        if (first_error)
+            std::rethrow_exception(first_error);
+    }
+
+    // ------------------------------------ WORKER -----------------------------------
+
+    void upload_service::worker_loop() {
+        glfwMakeContextCurrent(m_context);
+
+        while (true) {
+            std::unique_ptr<job> current;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_job_posted.wait(lock, [this] { return m_stopping || !m_queued.empty(); });
+
+                // Jobs that weren't started yet are abandoned
+                if (m_stopping)
+                    break;
+
+                current = std::move(m_queued.front());
+                m_queued.pop_front();
+            }
+
+            try {
+                current->result.emplace(current->data);
+
+                // Buffer can be used in another context only once upload
+                // is actually done, not when it's just queued in this one
+                fence uploaded;
+                uploaded.insert();
+                uploaded.wait();
+            } catch (...) {
+                current->error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completed.push_back(std::move(current));
+            }
+
+            if (m_on_completed)
+                m_on_completed();
+
+            // Buffers of failed jobs were released in this context
+            gpu_resources::collect();
+        }
+
+        gpu_resources::flush();
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    upload_service::~upload_service() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_job_posted.notify_one();
+        m_worker.join();
+
+        glfwDestroyWindow(m_context);
+    }
+
+}
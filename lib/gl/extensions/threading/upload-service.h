@@ -0,0 +1,91 @@
+#pragma once
+
+#include "vertex-buffer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace gl {
+
+    // Uploads buffers from a worker thread that owns a hidden GL context,
+    // sharing objects with the window's one, so big static data can be loaded
+    // without stalling frames. Finished buffers are handed back (in order of
+    // submission) on the thread that calls collect, that is the render thread.
+    //
+    // GLFW allows creating and destroying contexts only on main thread, so
+    // that's where this should be constructed and destroyed, and while the
+    // shared context isn't current on any other thread (before draw_loop).
+    class upload_service {
+    public:
+        // Called with a buffer that's ready to be used, see vertex_array::assign
+        using completion_function = std::function<void(vertex_buffer buffer)>;
+
+        // /on_completed/ is called from the worker (e.g. to request a redraw)
+        explicit upload_service(GLFWwindow* shared_window,
+                                std::function<void()> on_completed = {});
+
+        // This class shouldn't be copied or moved
+        upload_service(const upload_service&) = delete;
+        upload_service& operator=(const upload_service&) = delete;
+
+        // /data/ should stay alive and unchanged until /done/ is called
+        void submit(raw_data data, completion_function done);
+
+        // Same, but the service keeps data alive by itself
+        template <typename value_type>
+        void submit(std::vector<value_type> data, completion_function done) {
+            auto owned = std::make_shared<std::vector<value_type>>(std::move(data));
+
+            submit_job({ { owned->data(), owned->size() * sizeof(value_type) },
+                         std::move(owned), std::move(done) });
+        }
+
+        // Calls completion functions of finished uploads, rethrows the first
+        // upload error (if any). Should be called once per frame.
+        void collect();
+
+        // Submitted, but not yet collected
+        size_t get_pending_count() const;
+
+        ~upload_service();
+
+    private:
+        struct job final {
+            raw_data data;
+            std::shared_ptr<const void> owner;
+
+            completion_function done;
+
+            std::optional<vertex_buffer> result {};
+            std::exception_ptr error {};
+        };
+
+        GLFWwindow* m_context;
+        std::function<void()> m_on_completed;
+
+        std::thread m_worker;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_job_posted;
+
+        std::deque<std::unique_ptr<job>> m_queued, m_completed;
+        size_t m_pending = 0;
+
+        bool m_stopping = false;
+
+        void submit_job(job new_job);
+        void worker_loop();
+    };
+
+}
@@ -2,14 +2,61 @@
 
 #include "vec.h"
 
+#include <bit>
+#include <cstdint>
+
+// Vertex of plain triangles (without edges or shapes), it's the first part
+// of colored_vertex, so command_list uploads plain ranges in this layout
+struct plain_vertex final {
+    math::vec<float, 2> point;
+    math::vec<float, 4> color;
+
+    float depth; // See colored_vertex
+};
+
 struct colored_vertex final {
     math::vec<float, 2> point;
     math::vec<float, 4> color;
 
+    // Drawing order (1 is the first primitive of the frame), later primitives
+    // are in front of earlier ones, so opaque ones can be depth-tested in any
+    // order. Assigned by drawing_manager, shader turns it into depth.
+    float depth;
+
+    // Distances to the edges of an antialiased line (across and along it),
+    // scaled so they are 1 on its boundary, zero means there are no edges.
+    // For SDF shapes it's the position in shape's own coordinates instead.
+    math::vec<float, 2> edge;
+
+    // SDF shape's kind and up to three parameters, evaluated by the fragment
+    // shader (see res/gradient.glsl), zero kind means it's not a shape
+    math::vec<float, 4> shape;
+
     colored_vertex()
-        : point(0.0f, 0.0f), color(0.0f, 0.0f, 0.0f, 0.0f) {};
+        : point(0.0f, 0.0f), color(0.0f, 0.0f, 0.0f, 0.0f), depth(0.0f),
+          edge(0.0f, 0.0f), shape(0.0f, 0.0f, 0.0f, 0.0f) {};
 
     colored_vertex(math::vec<float, 2> new_point,
                    math::vec<float, 4> new_color)
-        : point(new_point), color(new_color) {};
+        : point(new_point), color(new_color), depth(0.0f),
+          edge(0.0f, 0.0f), shape(0.0f, 0.0f, 0.0f, 0.0f) {};
+
+    colored_vertex(math::vec<float, 2> new_point,
+                   math::vec<float, 4> new_color,
+                   math::vec<float, 2> new_edge)
+        : point(new_point), color(new_color), depth(0.0f),
+          edge(new_edge), shape(0.0f, 0.0f, 0.0f, 0.0f) {};
+
+    colored_vertex(math::vec<float, 2> new_point,
+                   math::vec<float, 4> new_color,
+                   math::vec<float, 2> new_edge,
+                   math::vec<float, 4> new_shape)
+        : point(new_point), color(new_color), depth(0.0f), edge(new_edge), shape(new_shape) {};
+
+    // Plain vertices are made with exact zeros, so bit patterns are compared
+    // (-0.0 would count as an edge, which is just drawn the slower way)
+    bool is_plain() const {
+        return (std::bit_cast<uint32_t>(edge.x()) | std::bit_cast<uint32_t>(edge.y()) |
+                std::bit_cast<uint32_t>(shape.x())) == 0;
+    }
 };
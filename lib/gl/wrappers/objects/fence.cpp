@@ -0,0 +1,71 @@
+#include "fence.h"
+#include "opengl-wrapper.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    fence::fence(): sync(nullptr) {}
+
+    fence::fence(fence&& other) noexcept
+        : sync(std::exchange(other.sync, nullptr)) {}
+
+    fence& fence::operator=(fence&& other) noexcept {
+        if (this != &other) {
+            reset();
+            sync = std::exchange(other.sync, nullptr);
+        }
+
+        return *this;
+    }
+
+    void fence::insert() {
+        reset();
+        sync = gl::raw::fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    bool fence::is_set() const noexcept {
+        return sync != nullptr;
+    }
+
+    bool fence::is_signaled() const {
+        if (!is_set())
+            return true;
+
+        GLenum status = gl::raw::client_wait_sync(sync, 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    void fence::wait() {
+        if (!is_set())
+            return;
+
+        // Flush on first wait, otherwise fence may never reach the GPU
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+        const GLuint64 timeout = 1'000'000'000; // 1 second, in nanoseconds
+        while (true) {
+            GLenum status = gl::raw::client_wait_sync(sync, flags, timeout);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                break;
+
+            if (status == GL_WAIT_FAILED)
+                throw std::runtime_error("Failed to wait for GL fence!");
+
+            flags = 0;
+        }
+
+        reset();
+    }
+
+    void fence::reset() {
+        if (sync != nullptr)
+            gl::raw::delete_sync(std::exchange(sync, nullptr));
+    }
+
+    fence::~fence() {
+        reset();
+    }
+
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace gl {
+
+    // Marks a point in GL command stream, lets CPU find out (or wait until)
+    // GPU finishes every command that was submitted before that point
+    class fence final {
+    private:
+        GLsync sync;
+
+    public:
+        fence();
+
+        fence(const fence&) = delete;
+        fence& operator=(const fence&) = delete;
+
+        fence(fence&& other) noexcept;
+        fence& operator=(fence&& other) noexcept;
+
+        // Replaces previous point (if any) with the current end of stream
+        void insert();
+
+        bool is_set() const noexcept;
+
+        // Doesn't block, unset fence is considered signaled
+        bool is_signaled() const;
+
+        // Blocks until GPU reaches fence, then releases it
+        void wait();
+
+        void reset();
+
+        ~fence();
+    };
+
+};
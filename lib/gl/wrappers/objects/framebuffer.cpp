@@ -0,0 +1,70 @@
+#include "framebuffer.h"
+#include "gpu-resources.h"
+#include "opengl-wrapper.h"
+
+#include <stdexcept>
+
+namespace gl {
+
+    framebuffer::framebuffer(): id(0), depth_id(0) {
+        gl::raw::gen_framebuffers(1, &id);
+        gl::raw::gen_renderbuffers(1, &depth_id);
+
+        gpu_resources::on_created(resource_category::FRAMEBUFFER);
+        gpu_resources::on_created(resource_category::RENDERBUFFER);
+    }
+
+    // 24-bit depth is stored in 32 bits by common drivers
+    static constexpr size_t depth_pixel_size = 4;
+
+    void framebuffer::resize(size_t width, size_t height, texture::format new_format) {
+        if (width == color.get_width() && height == color.get_height() && new_format == color_format)
+            return;
+
+        const size_t old_depth_size = color.get_width() * color.get_height() * depth_pixel_size;
+        color_format = new_format;
+
+        color.assign(width, height, color_format, nullptr);
+        color.set_filtering(texture::filtering::NEAREST);
+
+        gl::raw::bind_renderbuffer(GL_RENDERBUFFER, depth_id);
+        gl::raw::renderbuffer_storage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24,
+                                      (GLsizei) width, (GLsizei) height);
+
+        gpu_resources::on_resized(resource_category::RENDERBUFFER, old_depth_size,
+                                  width * height * depth_pixel_size);
+
+        bind();
+
+        gl::raw::framebuffer_texture2_d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                        GL_TEXTURE_2D, color.get_id(), 0);
+        gl::raw::framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                          GL_RENDERBUFFER, depth_id);
+
+        const GLenum status = gl::raw::check_framebuffer_status(GL_FRAMEBUFFER);
+        bind_default();
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+            throw std::runtime_error("Framebuffer is incomplete!");
+    }
+
+    void framebuffer::bind() const {
+        gl::raw::bind_framebuffer(GL_FRAMEBUFFER, id);
+    }
+
+    void framebuffer::bind_default() {
+        gl::raw::bind_framebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    const texture& framebuffer::get_color() const { return color; }
+
+    size_t framebuffer::get_width()  const { return color.get_width();  }
+    size_t framebuffer::get_height() const { return color.get_height(); }
+
+    framebuffer::~framebuffer() {
+        gpu_resources::release(resource_category::FRAMEBUFFER, id);
+        gpu_resources::release(resource_category::RENDERBUFFER, depth_id,
+                               get_width() * get_height() * depth_pixel_size);
+    }
+
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "texture.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+namespace gl {
+
+    // Offscreen render target: color texture (can be sampled afterwards)
+    // with a depth buffer, so everything drawn to the window can be drawn here
+    class framebuffer final {
+    public:
+        framebuffer();
+
+        framebuffer(const framebuffer&) = delete;
+        framebuffer& operator=(const framebuffer&) = delete;
+
+        // (Re)allocates attachments, does nothing if size and format are the same
+        void resize(size_t width, size_t height, texture::format color_format);
+
+        // Following draws go here, until another framebuffer is bound
+        void bind() const;
+
+        // Following draws go to the window again
+        static void bind_default();
+
+        const texture& get_color() const;
+
+        size_t get_width()  const;
+        size_t get_height() const;
+
+        ~framebuffer();
+
+    private:
+        unsigned int id;
+        unsigned int depth_id; // Renderbuffer
+
+        texture color;
+        texture::format color_format = texture::format::RGBA;
+    };
+
+};
@@ -0,0 +1,306 @@
+#include "gpu-resources.h"
+#include "fence.h"
+#include "opengl-wrapper.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gl {
+
+    namespace {
+
+        struct released_object final {
+            resource_category category;
+            unsigned int id;
+            size_t bytes;
+
+            // Vertex arrays and framebuffers aren't shared between contexts,
+            // so objects are deleted only in the one they were released in
+            GLFWwindow* context;
+        };
+
+        // Objects released in one context during one frame, deleted together
+        struct deletion_batch final {
+            GLFWwindow* context;
+
+            fence done;
+            std::vector<released_object> objects;
+        };
+
+        struct resources_state final {
+            std::array<std::atomic<size_t>, resource_category_count> live_counts {}, bytes {};
+
+            std::atomic<size_t> total_bytes = 0, pending_count = 0;
+
+            // Guards pending objects, batches and budget function
+            std::mutex mutex;
+            std::vector<released_object> pending;
+
+            // Oldest first, batches of different contexts are interleaved
+            std::deque<deletion_batch> batches;
+
+            std::atomic<size_t> budget = 0;
+            std::atomic<bool> is_over_budget = false;
+            gpu_resources::budget_function on_exceeded;
+        };
+
+        resources_state& get_state() {
+            // Never destroyed, objects with static storage may be released after it
+            static resources_state* const state = new resources_state();
+            return *state;
+        }
+
+    }
+
+    const char* get_name(resource_category category) {
+        switch (category) {
+            case resource_category::BUFFER:       return "buffers";
+            case resource_category::VERTEX_ARRAY: return "vertex arrays";
+            case resource_category::TEXTURE:      return "textures";
+            case resource_category::RENDERBUFFER: return "renderbuffers";
+            case resource_category::FRAMEBUFFER:  return "framebuffers";
+            case resource_category::SHADER:       return "shaders";
+            case resource_category::PROGRAM:      return "programs";
+
+            default: return "unknown";
+        }
+    }
+
+    std::ostream& operator<<(std::ostream& out, const resource_report& report) {
+        constexpr double mebibyte = 1024.0 * 1024.0;
+
+        for (size_t i = 0; i < resource_category_count; ++ i) {
+            const resource_usage& usage = report.categories[i];
+            if (usage.live_count == 0)
+                continue;
+
+            out << std::left << std::setw(14) << get_name((resource_category) i) << std::right
+                << std::setw(7) << usage.live_count << " objects "
+                << std::fixed << std::setprecision(2) << std::setw(10)
+                << (double) usage.bytes / mebibyte << " MiB\n";
+        }
+
+        out << "total " << std::fixed << std::setprecision(2) << (double) report.total_bytes / mebibyte
+            << " MiB, " << report.pending_count << " objects waiting for deletion\n";
+
+        return out;
+    }
+
+    // ---------------------------------- ACCOUNTING ---------------------------------
+
+    static void check_budget(resources_state& state) {
+        const size_t budget = state.budget.load(std::memory_order_relaxed);
+        if (budget == 0 || state.total_bytes.load(std::memory_order_relaxed) <= budget)
+            return;
+
+        // Only the thread that crossed the budget warns
+        if (state.is_over_budget.exchange(true))
+            return;
+
+        gpu_resources::budget_function on_exceeded;
+        {
+            std::lock_guard lock(state.mutex);
+            on_exceeded = state.on_exceeded;
+        }
+
+        const resource_report report = gpu_resources::get_report();
+        if (on_exceeded)
+            on_exceeded(report);
+        else
+            std::cerr << "GPU memory budget of " << budget / (1024 * 1024)
+                      << " MiB is exceeded:\n" << report;
+    }
+
+    void gpu_resources::on_created(resource_category category) {
+        get_state().live_counts[(size_t) category].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void gpu_resources::on_resized(resource_category category, size_t old_bytes, size_t new_bytes) {
+        resources_state& state = get_state();
+
+        if (new_bytes >= old_bytes) {
+            state.bytes[(size_t) category].fetch_add(new_bytes - old_bytes, std::memory_order_relaxed);
+            state.total_bytes.fetch_add(new_bytes - old_bytes, std::memory_order_relaxed);
+
+            check_budget(state);
+        } else {
+            state.bytes[(size_t) category].fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+            state.total_bytes.fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+        }
+    }
+
+    static void forget_object(resources_state& state, const released_object& object);
+
+    void gpu_resources::release(resource_category category, unsigned int id, size_t bytes) {
+        resources_state& state = get_state();
+
+        const released_object object { category, id, bytes, glfwGetCurrentContext() };
+        state.pending_count.fetch_add(1, std::memory_order_relaxed);
+
+        // Without a context object is already gone along with its context
+        if (object.context == nullptr) {
+            forget_object(state, object);
+            return;
+        }
+
+        std::lock_guard lock(state.mutex);
+        state.pending.push_back(object);
+    }
+
+    // ----------------------------------- DELETION ----------------------------------
+
+    static void forget_object(resources_state& state, const released_object& object) {
+        state.live_counts[(size_t) object.category].fetch_sub(1, std::memory_order_relaxed);
+        state.bytes[(size_t) object.category].fetch_sub(object.bytes, std::memory_order_relaxed);
+
+        const size_t total = state.total_bytes.fetch_sub(object.bytes, std::memory_order_relaxed) - object.bytes;
+        state.pending_count.fetch_sub(1, std::memory_order_relaxed);
+
+        // Warn again next time budget is crossed
+        if (total <= state.budget.load(std::memory_order_relaxed))
+            state.is_over_budget.store(false, std::memory_order_relaxed);
+    }
+
+    static void delete_object(resources_state& state, const released_object& object) {
+        switch (object.category) {
+            case resource_category::BUFFER:       gl::raw::delete_buffers(1, &object.id);       break;
+            case resource_category::VERTEX_ARRAY: gl::raw::delete_vertex_arrays(1, &object.id); break;
+            case resource_category::TEXTURE:      gl::raw::delete_textures(1, &object.id);      break;
+            case resource_category::RENDERBUFFER: gl::raw::delete_renderbuffers(1, &object.id); break;
+            case resource_category::FRAMEBUFFER:  gl::raw::delete_framebuffers(1, &object.id);  break;
+            case resource_category::SHADER:       gl::raw::delete_shader(object.id);            break;
+            case resource_category::PROGRAM:      gl::raw::delete_program(object.id);           break;
+
+            default: break;
+        }
+
+        forget_object(state, object);
+    }
+
+    static void delete_batch(resources_state& state, deletion_batch& batch) {
+        for (const released_object& object: batch.objects)
+            delete_object(state, object);
+
+        batch.done.reset();
+    }
+
+    // Takes pending objects that were released in /context/
+    static std::vector<released_object> take_pending(resources_state& state, GLFWwindow* context) {
+        const auto others = std::stable_partition(state.pending.begin(), state.pending.end(),
+            [context](const released_object& object) { return object.context != context; });
+
+        std::vector<released_object> released(others, state.pending.end());
+        state.pending.erase(others, state.pending.end());
+
+        return released;
+    }
+
+    void gpu_resources::collect() {
+        GLFWwindow* const context = glfwGetCurrentContext();
+        if (context == nullptr)
+            return;
+
+        resources_state& state = get_state();
+        std::lock_guard lock(state.mutex);
+
+        // Fence goes after everything that could still use released objects
+        std::vector<released_object> released = take_pending(state, context);
+        if (!released.empty()) {
+            deletion_batch& batch = state.batches.emplace_back();
+
+            batch.context = context;
+            batch.objects = std::move(released);
+            batch.done.insert();
+        }
+
+        // Fences of one context are signaled in order, its first busy batch stops
+        for (auto batch = state.batches.begin(); batch != state.batches.end(); ) {
+            if (batch->context != context) {
+                ++ batch;
+                continue;
+            }
+
+            if (!batch->done.is_signaled())
+                break;
+
+            delete_batch(state, *batch);
+            batch = state.batches.erase(batch);
+        }
+    }
+
+    void gpu_resources::flush() {
+        GLFWwindow* const context = glfwGetCurrentContext();
+        if (context == nullptr)
+            return;
+
+        resources_state& state = get_state();
+        std::lock_guard lock(state.mutex);
+
+        const std::vector<released_object> released = take_pending(state, context);
+
+        const bool has_batches = std::ranges::any_of(state.batches,
+            [context](const deletion_batch& batch) { return batch.context == context; });
+
+        if (released.empty() && !has_batches)
+            return;
+
+        gl::raw::finish();
+
+        for (auto batch = state.batches.begin(); batch != state.batches.end(); ) {
+            if (batch->context != context) {
+                ++ batch;
+                continue;
+            }
+
+            delete_batch(state, *batch);
+            batch = state.batches.erase(batch);
+        }
+
+        for (const released_object& object: released)
+            delete_object(state, object);
+    }
+
+    // ---------------------------------- REPORTING ----------------------------------
+
+    resource_report gpu_resources::get_report() {
+        resources_state& state = get_state();
+
+        resource_report report;
+        for (size_t i = 0; i < resource_category_count; ++ i) {
+            report.categories[i].live_count = state.live_counts[i].load(std::memory_order_relaxed);
+            report.categories[i].bytes = state.bytes[i].load(std::memory_order_relaxed);
+        }
+
+        report.total_bytes = state.total_bytes.load(std::memory_order_relaxed);
+        report.pending_count = state.pending_count.load(std::memory_order_relaxed);
+
+        return report;
+    }
+
+    void gpu_resources::set_budget(size_t bytes, budget_function on_exceeded) {
+        resources_state& state = get_state();
+        {
+            std::lock_guard lock(state.mutex);
+            state.on_exceeded = std::move(on_exceeded);
+        }
+
+        state.budget.store(bytes, std::memory_order_relaxed);
+        state.is_over_budget.store(false, std::memory_order_relaxed);
+
+        // Usage may already be over the new budget
+        check_budget(state);
+    }
+
+    size_t gpu_resources::get_budget() {
+        return get_state().budget.load(std::memory_order_relaxed);
+    }
+
+}
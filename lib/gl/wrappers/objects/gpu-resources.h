@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+namespace gl {
+
+    enum class resource_category: uint8_t {
+        BUFFER, VERTEX_ARRAY, TEXTURE, RENDERBUFFER, FRAMEBUFFER, SHADER, PROGRAM
+    };
+
+    inline constexpr size_t resource_category_count = 7;
+
+    const char* get_name(resource_category category);
+
+    struct resource_usage final {
+        size_t live_count = 0; // Objects that exist in GL (queued for deletion included)
+        size_t bytes = 0;      // Their storage, as requested (driver may pad it)
+    };
+
+    struct resource_report final {
+        std::array<resource_usage, resource_category_count> categories {};
+
+        size_t total_bytes = 0;
+        size_t pending_count = 0; // Released, but not deleted yet
+
+        const resource_usage& operator[](resource_category category) const {
+            return categories[(size_t) category];
+        }
+    };
+
+    // One line per category that has live objects
+    std::ostream& operator<<(std::ostream& out, const resource_report& report);
+
+    // Keeps count of every GL object made by wrappers and deletes them when
+    // they're no longer needed. Wrappers don't delete their objects directly,
+    // they release them here, and deletion is deferred until a fence shows
+    // that GPU is done with every command submitted before release, so that
+    // deleting an object never waits on (or races with) frames in flight.
+    //
+    // Objects are deleted in the context that was current when they were
+    // released (vertex arrays and framebuffers aren't shared), collect and
+    // flush only handle objects of the context that is current on calling
+    // thread. gl::window does that once per frame, and flushes before its
+    // context is destroyed, upload_service does the same for its context.
+    // Objects released with no current context are gone with it already.
+    //
+    // Everything here is thread safe, e.g. upload_service's worker can
+    // drop buffers while window's thread collects its own.
+    class gpu_resources final {
+    public:
+        // Called with usage that went over budget, from the thread that
+        // allocated storage, once each time budget is crossed
+        using budget_function = std::function<void(const resource_report& report)>;
+
+        gpu_resources() = delete;
+
+        // ==> Accounting (called by wrappers):
+
+        static void on_created(resource_category category);
+
+        // Storage of an object was (re)allocated
+        static void on_resized(resource_category category, size_t old_bytes, size_t new_bytes);
+
+        // Queues object for deletion, its /bytes/ are released along with it
+        static void release(resource_category category, unsigned int id, size_t bytes = 0);
+
+        // ==> Deletion:
+
+        // Fences objects released in current context since its previous
+        // collect, deletes those that GPU no longer uses. Should be called
+        // once per frame.
+        static void collect();
+
+        // Waits for GPU and deletes everything released in current context
+        static void flush();
+
+        // ==> Reporting:
+
+        static resource_report get_report();
+
+        // Warns when total bytes go over /bytes/ (0 disables the budget).
+        // By default warning with a report is written to std::cerr.
+        static void set_budget(size_t bytes, budget_function on_exceeded = {});
+        static size_t get_budget();
+    };
+
+}
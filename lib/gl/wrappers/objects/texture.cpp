@@ -0,0 +1,124 @@
+#include "texture.h"
+#include "gpu-resources.h"
+#include "opengl-wrapper.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace gl {
+
+    texture::texture(): id(0) {
+        gl::raw::gen_textures(1, &id);
+        gpu_resources::on_created(resource_category::TEXTURE);
+
+        // Without mipmaps default minification filter leaves texture incomplete
+        set_filtering(filtering::LINEAR);
+    }
+
+    texture::texture(texture&& other) noexcept
+        : id(std::exchange(other.id, 0)),
+          width(std::exchange(other.width, 0)), height(std::exchange(other.height, 0)),
+          pixel_format(other.pixel_format) {}
+
+    texture& texture::operator=(texture&& other) noexcept {
+        if (this != &other) {
+            release();
+
+            id = std::exchange(other.id, 0);
+
+            width  = std::exchange(other.width,  0);
+            height = std::exchange(other.height, 0);
+
+            pixel_format = other.pixel_format;
+        }
+
+        return *this;
+    }
+
+    static GLint get_internal_format(texture::format pixel_format) {
+        switch (pixel_format) {
+            case texture::format::RED:       return GL_R8;
+            case texture::format::RGBA:      return GL_RGBA8;
+            case texture::format::RED_FLOAT: return GL_R32F;
+
+            default: return GL_RGBA8;
+        }
+    }
+
+    static GLenum get_pixel_format(texture::format pixel_format) {
+        return pixel_format == texture::format::RGBA ? GL_RGBA : GL_RED;
+    }
+
+    static GLenum get_pixel_type(texture::format pixel_format) {
+        return pixel_format == texture::format::RED_FLOAT ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    }
+
+    static size_t get_pixel_size(texture::format pixel_format) {
+        return pixel_format == texture::format::RED ? 1 : 4;
+    }
+
+    size_t texture::get_size_bytes() const {
+        return width * height * get_pixel_size(pixel_format);
+    }
+
+    void texture::assign(size_t new_width, size_t new_height, format new_format, const void* pixels) {
+        const size_t old_size = get_size_bytes();
+
+        width = new_width, height = new_height;
+        pixel_format = new_format;
+
+        bind();
+
+        // Single-channel rows aren't 4-byte aligned in general
+        gl::raw::pixel_storei(GL_UNPACK_ALIGNMENT, 1);
+        gl::raw::tex_image2_d(GL_TEXTURE_2D, 0, get_internal_format(pixel_format),
+                              (GLsizei) width, (GLsizei) height, 0,
+                              get_pixel_format(pixel_format), get_pixel_type(pixel_format), pixels);
+
+        gpu_resources::on_resized(resource_category::TEXTURE, old_size, get_size_bytes());
+    }
+
+    void texture::update(size_t x, size_t y, size_t update_width, size_t update_height,
+                         const void* pixels) {
+
+        if (x + update_width > width || y + update_height > height)
+            throw std::out_of_range("Texture update is out of its bounds!");
+
+        bind();
+
+        gl::raw::pixel_storei(GL_UNPACK_ALIGNMENT, 1);
+        gl::raw::tex_sub_image2_d(GL_TEXTURE_2D, 0, (GLint) x, (GLint) y,
+                                  (GLsizei) update_width, (GLsizei) update_height,
+                                  get_pixel_format(pixel_format), get_pixel_type(pixel_format), pixels);
+    }
+
+    void texture::set_filtering(filtering mode) {
+        bind();
+
+        gl::raw::tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) mode);
+        gl::raw::tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) mode);
+
+        gl::raw::tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl::raw::tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    void texture::bind(unsigned int unit) const {
+        gl::raw::active_texture(GL_TEXTURE0 + unit);
+        gl::raw::bind_texture(GL_TEXTURE_2D, id);
+    }
+
+    size_t texture::get_width()  const { return width;  }
+    size_t texture::get_height() const { return height; }
+
+    unsigned int texture::get_id() const { return id; }
+
+    void texture::release() {
+        if (id != 0)
+            gpu_resources::release(resource_category::TEXTURE, std::exchange(id, 0), get_size_bytes());
+    }
+
+    texture::~texture() {
+        release();
+    }
+
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+namespace gl {
+
+    // Two-dimensional texture, either single-channel (8 bits, e.g. masks
+    // and distance fields), RGBA (8 bits per channel) or single-channel
+    // float (e.g. render target for counters)
+    class texture final {
+    public:
+        enum class format {
+            RED, RGBA, RED_FLOAT
+        };
+
+        enum class filtering {
+            NEAREST = GL_NEAREST, LINEAR = GL_LINEAR
+        };
+
+        texture();
+
+        texture(const texture&) = delete;
+        texture& operator=(const texture&) = delete;
+
+        // Moved from texture is left empty (without GL object)
+        texture(texture&& other) noexcept;
+        texture& operator=(texture&& other) noexcept;
+
+        // Reallocates storage, /pixels/ are tightly packed rows (can be null),
+        // of bytes, or of floats for RED_FLOAT
+        void assign(size_t width, size_t height, format pixel_format, const void* pixels);
+
+        // Overwrites a rectangle of already allocated storage
+        void update(size_t x, size_t y, size_t width, size_t height, const void* pixels);
+
+        void set_filtering(filtering mode);
+
+        // Binds to texture unit /unit/ (that's what sampler uniforms refer to)
+        void bind(unsigned int unit = 0) const;
+
+        size_t get_width()  const;
+        size_t get_height() const;
+
+        unsigned int get_id() const;
+
+        // Storage that was allocated (without mipmaps, which aren't used)
+        size_t get_size_bytes() const;
+
+        ~texture();
+
+    private:
+        unsigned int id;
+
+        size_t width = 0, height = 0;
+        format pixel_format = format::RGBA;
+
+        // Hands GL object over to gpu_resources for deferred deletion
+        void release();
+    };
+
+};
@@ -2,29 +2,85 @@
 #include "vertex-buffer.h"
 #include "vertex-layout.h"
 
+#include "gpu-resources.h"
 #include "opengl-wrapper.h"
 
+#include <utility>
+
 namespace gl {
-    vertex_array::vertex_array(): buffer(), layout() {
-        gl::raw::gen_vertex_arrays(1, &this->id);
+    static unsigned int generate_vertex_array_id() {
+        unsigned int id = 0;
+        gl::raw::gen_vertex_arrays(1, &id);
+        gpu_resources::on_created(resource_category::VERTEX_ARRAY);
+
+        return id;
     }
 
+    vertex_array::vertex_array()
+        : id(generate_vertex_array_id()), element_count(0), buffer(), layout(),
+          is_planar(false) {}
+
     vertex_array::vertex_array(vertex_layout new_layout)
-        : buffer(), layout(new_layout) {
-        gl::raw::gen_vertex_arrays(1, &this->id);
+        : id(generate_vertex_array_id()), element_count(0), buffer(), layout(new_layout),
+          is_planar(false) {}
+
+    vertex_array::vertex_array(vertex_array&& other) noexcept
+        : id(std::exchange(other.id, 0)),
+          element_count(std::exchange(other.element_count, 0)),
+          buffer(std::move(other.buffer)), layout(std::move(other.layout)),
+          is_planar(std::exchange(other.is_planar, false)) {}
+
+    vertex_array& vertex_array::operator=(vertex_array&& other) noexcept {
+        if (this != &other) {
+            if (id != 0)
+                gpu_resources::release(resource_category::VERTEX_ARRAY, id);
+
+            id = std::exchange(other.id, 0);
+            element_count = std::exchange(other.element_count, 0);
+
+            buffer = std::move(other.buffer);
+            layout = std::move(other.layout);
+
+            is_planar = std::exchange(other.is_planar, false);
+        }
+
+        return *this;
     }
 
     void vertex_array::set_layout(vertex_layout new_layout) {
         this->layout = new_layout;
     }
 
+    const vertex_layout& vertex_array::get_layout() const { return this->layout; }
+
     vertex_array::vertex_array(vertex_layout new_layout, raw_data new_data)
         : vertex_array(new_layout) { assign(new_data); }
 
 
     void vertex_array::assign(raw_data new_data) {
         this->buffer.set_data(new_data);
-        
+        this->is_planar = false;
+
+        update_attributes();
+    }
+
+    void vertex_array::assign(vertex_buffer&& filled_buffer, size_t new_element_count) {
+        this->buffer = std::move(filled_buffer);
+        this->element_count = new_element_count;
+        this->is_planar = false;
+
+        update_attributes();
+    }
+
+    void vertex_array::assign_planar(vertex_buffer&& filled_buffer, size_t new_element_count) {
+        this->buffer = std::move(filled_buffer);
+        this->element_count = new_element_count;
+        this->is_planar = true;
+
+        update_attributes();
+    }
+
+    void vertex_array::update_attributes() {
         this->bind();
         this->buffer.bind();
 
@@ -32,17 +88,20 @@ namespace gl {
         for (vertex current: this->layout.vertices)
             total_size += current.size;
 
-        unsigned int offset = 0;
+        size_t offset = 0;
         for (unsigned int i = 0; i < this->layout.vertices.size(); ++ i) {
             const vertex& layout_element = this->layout.vertices[i];
 
+            // Planar attribute's values are packed, next one starts after all of them
+            const size_t stride = is_planar ? layout_element.size : total_size;
+
             gl::raw::enable_vertex_attrib_array(i);
             gl::raw::vertex_attrib_pointer(i, (int) layout_element.count,
                                            layout_element.type_id, GL_FALSE,
-                                           (int) total_size,
-                                           (const void*)(uintptr_t) offset);
+                                           (int) stride,
+                                           (const void*) offset);
 
-            offset += layout_element.size;
+            offset += is_planar ? layout_element.size * element_count : layout_element.size;
         }
     }
 
@@ -51,6 +110,14 @@ namespace gl {
         assign(new_data);
     }
 
+    void vertex_array::reserve(size_t size) {
+        assign({ nullptr, size });
+    }
+
+    void vertex_array::update(size_t offset, raw_data new_data) {
+        this->buffer.update(offset, new_data);
+    }
+
     size_t vertex_array::get_element_count() const {
         return element_count;
     }
@@ -59,7 +126,14 @@ namespace gl {
         return buffer.size();
     }      
 
-    vertex_array::~vertex_array() {}
+    const vertex_buffer& vertex_array::get_buffer() const {
+        return buffer;
+    }
+
+    vertex_array::~vertex_array() {
+        if (id != 0)
+            gpu_resources::release(resource_category::VERTEX_ARRAY, id);
+    }
 
     void vertex_array::bind() const { gl::raw::bind_vertex_array(this->id); }
 
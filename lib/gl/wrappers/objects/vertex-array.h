@@ -18,14 +18,27 @@ namespace gl {
         vertex_buffer buffer;
         vertex_layout layout;
 
+        // Attributes aren't interleaved, see assign_planar
+        bool is_planar;
+
+        // Points attributes of current layout to current buffer
+        void update_attributes();
+
     public:
         vertex_array();
 
         vertex_array(vertex_layout new_layout);
         vertex_array(vertex_layout new_layout, raw_data new_data);
 
-        template <typename value_type>
-        void assign(std::vector<value_type> data_buffer) {
+        vertex_array(const vertex_array&) = delete;
+        vertex_array& operator=(const vertex_array&) = delete;
+
+        // Moved from array is left empty (without GL objects)
+        vertex_array(vertex_array&& other) noexcept;
+        vertex_array& operator=(vertex_array&& other) noexcept;
+
+        template <typename value_type, typename allocator_type>
+        void assign(const std::vector<value_type, allocator_type>& data_buffer) {
             this->element_count = data_buffer.size();
 
             size_t layout_size = 0;
@@ -33,13 +46,13 @@ namespace gl {
                 layout_size += current.size;
 
             assign(this->layout, {
-                    (void*) &(*data_buffer.begin()),
+                    data_buffer.data(),
                     layout_size * data_buffer.size()
             });
         }
 
-        template <typename value_type>
-        void assign(vertex_layout new_layout, std::vector<value_type> data_buffer) {
+        template <typename value_type, typename allocator_type>
+        void assign(vertex_layout new_layout, const std::vector<value_type, allocator_type>& data_buffer) {
             this->layout = new_layout;
             assign(data_buffer);
         }
@@ -51,11 +64,27 @@ namespace gl {
         void assign(raw_data new_buffer);
         void assign(vertex_layout new_layout, raw_data new_data);
 
+        // Takes over already filled buffer (e.g. uploaded in another context)
+        void assign(vertex_buffer&& filled_buffer, size_t new_element_count);
+
+        // Same, but buffer holds values of one attribute for all elements,
+        // then of the next one (e.g. columns copied as they are), instead
+        // of whole vertices one after another
+        void assign_planar(vertex_buffer&& filled_buffer, size_t new_element_count);
+
         void set_layout(vertex_layout layout);
+        const vertex_layout& get_layout() const;
+
+        // Allocates /size/ bytes of uninitialized storage, that is then filled
+        // in parts with update (element count is left for caller to track)
+        void reserve(size_t size);
+        void update(size_t offset, raw_data new_data);
 
         size_t size() const;
         size_t get_element_count() const;
 
+        const vertex_buffer& get_buffer() const;
+
         void bind() const;
 
         ~vertex_array();
@@ -1,11 +1,20 @@
 #include "vertex-buffer.h"
+#include "gpu-resources.h"
 #include "opengl-wrapper.h"
 
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
 namespace gl {
 
+    // Allocations from this size on are checked to have succeeded
+    static constexpr size_t checked_allocation_size = 64 << 20;
+
     static unsigned int generate_buffer_id() {
         unsigned int id = 0;
         gl::raw::gen_buffers(1, &id);
+        gpu_resources::on_created(resource_category::BUFFER);
 
         return id;
     }
@@ -19,22 +28,75 @@ namespace gl {
         set_data(new_data);
     }
 
+    vertex_buffer::vertex_buffer(vertex_buffer&& other) noexcept
+        : id(std::exchange(other.id, 0)),
+          data(std::exchange(other.data, { NULL, 0 })) {}
+
+    vertex_buffer& vertex_buffer::operator=(vertex_buffer&& other) noexcept {
+        if (this != &other) {
+            release();
+
+            id   = std::exchange(other.id, 0);
+            data = std::exchange(other.data, { NULL, 0 });
+        }
+
+        return *this;
+    }
+
     vertex_buffer::~vertex_buffer() {
-        // gl::raw::delete_buffers(1, &id);
+        release();
+    }
+
+    void vertex_buffer::release() {
+        if (id != 0)
+            gpu_resources::release(resource_category::BUFFER, std::exchange(id, 0), data.size);
+
+        data = { NULL, 0 };
     }
 
     void vertex_buffer::set_data(raw_data new_data) {
+        if (new_data.size > (size_t) std::numeric_limits<GLsizeiptr>::max())
+            throw std::length_error("Vertex buffer is too big for GL to allocate!");
+
+        gpu_resources::on_resized(resource_category::BUFFER, data.size, new_data.size);
         this->data = new_data;
 
         bind();
-        gl::raw::buffer_data(GL_ARRAY_BUFFER, (int) data.size,
+        gl::raw::buffer_data(GL_ARRAY_BUFFER, (GLsizeiptr) data.size,
                              data.data, GL_DYNAMIC_DRAW);
+
+        // Errors aren't checked in release builds, and big allocations are
+        // the ones that fail (asking for size costs a query, so only them)
+        if (data.size >= checked_allocation_size) {
+            GLint64 allocated = 0;
+            gl::raw::get_buffer_parameteri64v(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &allocated);
+
+            if ((size_t) allocated != data.size) {
+                gpu_resources::on_resized(resource_category::BUFFER, data.size, 0);
+                data = { NULL, 0 };
+
+                throw std::runtime_error("GL failed to allocate vertex buffer!");
+            }
+        }
+    }
+
+    void vertex_buffer::update(size_t offset, raw_data new_data) {
+        if (offset + new_data.size > data.size)
+            throw std::out_of_range("vertex buffer update is out of its bounds");
+
+        bind();
+        gl::raw::buffer_sub_data(GL_ARRAY_BUFFER, (GLintptr) offset,
+                                 (GLsizeiptr) new_data.size, new_data.data);
     }
 
     size_t vertex_buffer::size() const {
         return data.size;
     }
 
+    unsigned int vertex_buffer::get_id() const {
+        return id;
+    }
+
     void vertex_buffer::bind() const {
         gl::raw::bind_buffer(GL_ARRAY_BUFFER, id);
     }
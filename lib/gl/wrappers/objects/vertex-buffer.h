@@ -5,7 +5,7 @@
 namespace gl {
 
     struct raw_data final {
-        void* data;
+        const void* data;
         size_t size;
     };
 
@@ -14,6 +14,9 @@ namespace gl {
         unsigned int id; 
         raw_data data;
 
+        // Hands GL object over to gpu_resources for deferred deletion
+        void release();
+
     public:
         vertex_buffer();
         vertex_buffer(raw_data new_data);
@@ -21,12 +24,21 @@ namespace gl {
         vertex_buffer(const vertex_buffer&) = delete;
         vertex_buffer& operator=(const vertex_buffer&) = delete;
 
+        // Moved from buffer is left empty (without GL object)
+        vertex_buffer(vertex_buffer&& other) noexcept;
+        vertex_buffer& operator=(vertex_buffer&& other) noexcept;
+
         ~vertex_buffer();
 
         void set_data(raw_data new_data);
+
+        // Overwrites part of already allocated storage (without reallocating)
+        void update(size_t offset, raw_data new_data);
+
         void bind() const;
 
         size_t size() const;
+        unsigned int get_id() const;
     };
 
 };
@@ -30,24 +30,62 @@ GLuint glCreateProgram(),
 GLint glGetUniformLocation(GLuint program, const GLchar *name),
 GLuint glCreateShader(GLenum shaderType),
 void glAttachShader(GLuint program, GLuint shader),
+void glActiveTexture(GLenum texture),
 void glBegin(GLenum mode),
 void glBindBuffer(GLenum target, GLuint buffer),
+void glBindFramebuffer(GLenum target, GLuint framebuffer),
+void glBindRenderbuffer(GLenum target, GLuint renderbuffer),
+void glBindTexture(GLenum target, GLuint texture),
 void glBindVertexArray(GLuint array),
+void glBlendFunc(GLenum sfactor, GLenum dfactor),
 void glBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage),
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data),
+GLenum glCheckFramebufferStatus(GLenum target),
 void glClear(GLbitfield mask),
+void glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value),
+GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout),
 void glColor3f(GLfloat red, GLfloat green, GLfloat blue),
 void glCompileShader(GLuint shader),
+void glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size),
 void glDeleteBuffers(GLsizei n, const GLuint *buffers),
+void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers),
 void glDeleteProgram(GLuint program),
+void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers),
+void glDeleteShader(GLuint shader),
+void glDeleteSync(GLsync sync),
+void glDeleteTextures(GLsizei n, const GLuint *textures),
+void glDeleteVertexArrays(GLsizei n, const GLuint *arrays),
+void glDepthFunc(GLenum func),
+void glDepthMask(GLboolean flag),
+void glDisable(GLenum cap),
 void glDrawArrays(GLenum mode, GLint first, GLsizei count),
+void glEnable(GLenum cap),
 void glEnableVertexAttribArray(GLuint index),
 void glEnd(),
+GLsync glFenceSync(GLenum condition, GLbitfield flags),
+void glFinish(),
+void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer),
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level),
 void glGenBuffers(GLsizei n, GLuint *buffers),
+void glGenFramebuffers(GLsizei n, GLuint *framebuffers),
+void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers),
+void glGenTextures(GLsizei n, GLuint *textures),
 void glGenVertexArrays(GLsizei n, GLuint *arrays),
+void glGetBufferParameteri64v(GLenum target, GLenum value, GLint64 *data),
+void glGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, GLvoid *data),
+void glGetIntegerv(GLenum pname, GLint *data),
 void glGetShaderInfoLog(GLuint shader, GLsizei maxLength, GLsizei *length, GLchar *infoLog),
 void glGetShaderiv(GLuint shader, GLenum pname, GLint *params),
 void glLinkProgram(GLuint program),
+void glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount),
+void glPixelStorei(GLenum pname, GLint param),
+void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *data),
+void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height),
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height),
 void glShaderSource(GLuint shader, GLsizei count, const GLchar **string, const GLint *length),
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *data),
+void glTexParameteri(GLenum target, GLenum pname, GLint param),
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels),
 void glUniform1f(GLint location, GLfloat v0),
 void glUniform1fv(GLint location, GLsizei count, const GLfloat *value),
 void glUniform1d(GLint location, GLdouble v0),
@@ -92,6 +130,7 @@ void glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, co
 void glUseProgram(GLuint program),
 void glValidateProgram(GLuint program),
 void glVertex2f(GLfloat x, GLfloat y),
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height),
 void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer))')
 
 divert(0)dnl
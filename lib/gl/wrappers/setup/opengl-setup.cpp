@@ -1,4 +1,5 @@
 #include "opengl-setup.h"
+#include "gpu-resources.h"
 #include "vec.h"
 #include "uniforms.h"
 #include "vertex-array.h"
@@ -15,7 +16,13 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <thread>
+#include <utility>
 
 
 namespace gl {
@@ -31,6 +38,7 @@ namespace gl {
         const shaders::shader_type type = shader_names[shader_to_compile.type];
 
         unsigned int id = glCreateShader((unsigned int) type);
+        gpu_resources::on_created(resource_category::SHADER);
 
         const char* src = shader_to_compile.source_code.c_str();
         gl::raw::shader_source(id, 1, &src, nullptr);
@@ -55,6 +63,8 @@ namespace gl {
             // Because /message/ was already copied to /error_message/
             delete[] message;
 
+            gpu_resources::release(resource_category::SHADER, id);
+
             throw std::runtime_error(error_message);
         }
 
@@ -67,8 +77,16 @@ namespace gl {
         std::vector<shaders::compiled_shader> compiled_shaders;
         compiled_shaders.reserve(raw_shaders.size());
 
-        for (auto raw_shader: raw_shaders)
-            compiled_shaders.push_back(compile_shader(raw_shader));
+        try {
+            for (auto raw_shader: raw_shaders)
+                compiled_shaders.push_back(compile_shader(raw_shader));
+        } catch (...) {
+            // Shaders that did compile would be lost otherwise
+            for (const shaders::compiled_shader& shader: compiled_shaders)
+                gpu_resources::release(resource_category::SHADER, shader.id);
+
+            throw;
+        }
 
         return compiled_shaders;
     }
@@ -103,7 +121,25 @@ namespace gl {
 
     // --------------------------------- SHADER PROGRAM --------------------------------
 
-    shaders::shader_program::shader_program(): id(glCreateProgram()) {}
+    shaders::shader_program::shader_program(): id(glCreateProgram()) {
+        gpu_resources::on_created(resource_category::PROGRAM);
+    }
+
+    shaders::shader_program::shader_program(shader_program&& other) noexcept
+        : id(std::exchange(other.id, 0)),
+          uniform_locations(std::move(other.uniform_locations)) {}
+
+    shaders::shader_program& shaders::shader_program::operator=(shader_program&& other) noexcept {
+        if (this != &other) {
+            if (id != 0)
+                gpu_resources::release(resource_category::PROGRAM, id);
+
+            id = std::exchange(other.id, 0);
+            uniform_locations = std::move(other.uniform_locations);
+        }
+
+        return *this;
+    }
 
     shaders::shader_program::shader_program(const std::string filename): shader_program() {
         from_file(filename);
@@ -116,8 +152,10 @@ namespace gl {
         gl::raw::link_program(id);
         gl::raw::validate_program(id);
 
-        // for (auto shader: raw_shaders)
-        //     gl::raw::delete_program(shader.id);
+        // Linked program keeps what it needs, attached shaders are
+        // only flagged for deletion and go away along with it
+        for (auto shader: raw_shaders)
+            gpu_resources::release(resource_category::SHADER, shader.id);
     };
 
     void shaders::shader_program::from_shaders(const std::vector<shaders::raw_shader> raw_shaders) {
@@ -141,7 +179,8 @@ namespace gl {
     }
 
     shaders::shader_program::~shader_program() {
-        gl::raw::delete_program(id);
+        if (id != 0)
+            gpu_resources::release(resource_category::PROGRAM, id);
     }
 
     int shaders::shader_program::get_uniform_location_cached(std::string name) const {
@@ -186,17 +225,18 @@ namespace gl {
 
     // ---------------------------------- GLFW WINDOW ----------------------------------
 
-    // GLFWwindow <=> gl::window mapping for deducing gl::window in key callback
-    static std::map<GLFWwindow*, gl::window*> window_mapping {};
-
-    window::window(const int width, const int height, const char* title)
-        : current_fps(0), width(width), height(height) {
+    window::window(const int width, const int height, const char* title, const int msaa_samples)
+        : current_fps(0), width(width), height(height), framebuffer_width(0), framebuffer_height(0) {
 
         if (!glfwInit())
             throw std::runtime_error("Failed to initialize glfw!");
 
+        glfwWindowHint(GLFW_SAMPLES, msaa_samples);
         glfw_window = glfwCreateWindow(width, height, title, NULL, NULL);
 
+        // Hints are global, don't let them affect other windows
+        glfwWindowHint(GLFW_SAMPLES, 0);
+
         if (glfw_window == NULL) {
             glfwTerminate();
 
@@ -207,7 +247,11 @@ namespace gl {
                                      std::string(error_message));
         }
 
-        window_mapping[glfw_window] = this;
+        // Differs from window size on high-DPI screens
+        glfwGetFramebufferSize(glfw_window, &framebuffer_width, &framebuffer_height);
+
+        // Lets callbacks find gl::window without any lookups
+        glfwSetWindowUserPointer(glfw_window, this);
 
         bind();
 
@@ -215,6 +259,10 @@ namespace gl {
             throw std::runtime_error("Failed to initialize glew!");
 
         glEnable(GL_BLEND); // Allow transparency
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        if (msaa_samples > 0)
+            glEnable(GL_MULTISAMPLE);
     }
     
     void window::bind() const {
@@ -230,35 +278,380 @@ namespace gl {
         return this->glfw_window;
     }
 
+    static gl::window& get_window(GLFWwindow* window) {
+        return *static_cast<gl::window*>(glfwGetWindowUserPointer(window));
+    }
+
     static void key_press_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
         // Unused for now (maybe in the future this could take advantage of them)
         (void) scancode;
         (void) mods;
             
-        if (action == GLFW_PRESS || action == GLFW_REPEAT)
-            window_mapping[window]->on_key_pressed((gl::key) key);
+        if (action == GLFW_PRESS || action == GLFW_REPEAT) {
+            window_event event {};
+            event.type = window_event::event_type::KEY_PRESSED;
+            event.timestamp = glfwGetTime();
+
+            event.pressed_key = (gl::key) key;
+            event.is_repeat = action == GLFW_REPEAT;
+            event.repeat_count = 1;
+
+            get_window(window).push_event(event);
+        }
     }
 
     static void mouse_press_callback(GLFWwindow* window, double xpos, double ypos) {
-        gl::window &current_window = *window_mapping[window];
+        window_event event {};
+        event.type = window_event::event_type::MOUSE_MOVED;
+        event.timestamp = glfwGetTime();
 
-        // Get current window dimensions:
-        int width, height;
-        glfwGetWindowSize(current_window.get_glfw_window(), &width, &height);
+        event.x = xpos, event.y = ypos;
+
+        get_window(window).push_event(event);
+    }
+
+    static void framebuffer_resize_callback(GLFWwindow* window, int framebuffer_width,
+                                            int framebuffer_height) {
+        window_event event {};
+        event.type = window_event::event_type::RESIZED;
+        event.timestamp = glfwGetTime();
+
+        event.framebuffer_width  = framebuffer_width;
+        event.framebuffer_height = framebuffer_height;
+
+        glfwGetWindowSize(window, &event.width, &event.height);
+
+        get_window(window).push_event(event);
+    }
+
+    static void refresh_callback(GLFWwindow* window) {
+        // Contents were damaged (e.g. window was uncovered), draw them again
+        get_window(window).request_redraw();
+    }
+
+    void window::use_render_thread(bool enabled) {
+        render_thread_enabled = enabled;
+    }
+
+    void window::push_event(const window_event& event) {
+        if (event.type == window_event::event_type::MOUSE_MOVED) {
+            // Queued once callbacks of this poll are done, with later moves merged
+            pending_cursor = event;
+            has_pending_cursor = true;
 
-        if (xpos > current_window.width)
             return;
+        }
 
-        ypos -= height;
-        ypos += current_window.width;
+        // Cursor should get where it was before this event first
+        push_pending_events();
 
-        if (ypos < 0)
+        // Consumer is hopelessly behind, there's nothing better than to drop
+        if (!events.try_push(event))
+            dropped_events.fetch_add(1, std::memory_order_relaxed);
+
+        // Idle render thread sleeps until something happens
+        if (policy == redraw_policy::ON_DEMAND && render_thread_enabled)
+            wake_render_thread();
+    }
+
+    void window::push_pending_events() {
+        if (!has_pending_cursor)
+            return;
+
+        // Doesn't fit, stays pending (and gets replaced by newer position)
+        if (!events.try_push(pending_cursor, discrete_event_reserve))
             return;
 
-        current_window.on_mouse_moved({
-            xpos / (current_window.width / 2.0) - 1.0,
-            1.0 - ypos / (current_window.height / 2.0)
+        has_pending_cursor = false;
+
+        if (policy == redraw_policy::ON_DEMAND && render_thread_enabled)
+            wake_render_thread();
+    }
+
+    size_t window::get_dropped_event_count() const noexcept {
+        return dropped_events.load(std::memory_order_relaxed);
+    }
+
+    // ---------------------------------- REDRAW POLICY ---------------------------------
+
+    void window::set_redraw_policy(redraw_policy new_policy) {
+        policy = new_policy;
+    }
+
+    void window::request_redraw() {
+        redraw_requested.store(true, std::memory_order_release);
+
+        if (render_thread_enabled)
+            wake_render_thread();
+        else
+            glfwPostEmptyEvent(); // Interrupt glfwWaitEvents*
+    }
+
+    window::animation_id window::register_animation(double tick_rate) {
+        if (tick_rate <= 0.0)
+            throw std::invalid_argument("Animation's tick rate should be positive!");
+
+        animations.push_back({ 1.0 / tick_rate, glfwGetTime(), true });
+        return animations.size() - 1;
+    }
+
+    void window::set_animation_active(animation_id id, bool is_active) {
+        animation& current = animations.at(id);
+
+        // Resumed animation ticks right away
+        if (!current.is_active && is_active)
+            current.next_tick = glfwGetTime();
+
+        current.is_active = is_active;
+    }
+
+    double window::get_time_until_next_tick(double now) const {
+        double time_left = std::numeric_limits<double>::infinity();
+        for (const animation& current: animations)
+            if (current.is_active)
+                time_left = std::min(time_left, current.next_tick - now);
+
+        return std::max(time_left, 0.0);
+    }
+
+    bool window::is_redraw_needed(double now) const {
+        return redraw_requested.load(std::memory_order_acquire) || !events.empty() ||
+               get_time_until_next_tick(now) <= 0.0;
+    }
+
+    void window::start_on_demand_frame(double now) {
+        redraw_requested.store(false, std::memory_order_release);
+
+        for (animation& current: animations) {
+            if (!current.is_active || current.next_tick > now)
+                continue;
+
+            // Don't try to catch up with ticks missed while idle or slow
+            current.next_tick = std::max(current.next_tick + current.period, now);
+        }
+    }
+
+    void window::wake_render_thread() {
+        // Empty critical section orders wake up with waiter's predicate check
+        { std::lock_guard lock(wakeup_mutex); }
+        wakeup.notify_one();
+    }
+
+    bool window::wait_for_redraw() {
+        std::unique_lock lock(wakeup_mutex);
+
+        while (is_running.load(std::memory_order_acquire)) {
+            const double now = glfwGetTime();
+            if (is_redraw_needed(now)) {
+                start_on_demand_frame(now);
+                return true;
+            }
+
+            const double timeout = get_time_until_next_tick(now);
+            if (std::isinf(timeout))
+                wakeup.wait(lock);
+            else
+                wakeup.wait_for(lock, std::chrono::duration<double>(timeout));
+        }
+
+        return false;
+    }
+
+    void window::wait_events_until_redraw() {
+        while (!glfwWindowShouldClose(glfw_window)) {
+            const double now = glfwGetTime();
+            if (is_redraw_needed(now)) {
+                start_on_demand_frame(now);
+                return;
+            }
+
+            const double timeout = get_time_until_next_tick(now);
+            if (std::isinf(timeout))
+                glfwWaitEvents();
+            else
+                glfwWaitEventsTimeout(timeout);
+
+            push_pending_events();
+        }
+    }
+
+    // ----------------------------------- FRAME LOOP -----------------------------------
+
+    void window::dispatch_event(const window_event& event) {
+        switch (event.type) {
+        case window_event::event_type::KEY_PRESSED:
+            // Coalesced repeats are replayed, so handlers behave as before
+            for (int i = 0; i < event.repeat_count; ++ i)
+                on_key_pressed(event.pressed_key);
+
+            break;
+
+        case window_event::event_type::MOUSE_MOVED: {
+            double xpos = event.x, ypos = event.y;
+
+            if (xpos > width)
+                return;
+
+            ypos -= height;
+            ypos += width;
+
+            if (ypos < 0)
+                return;
+
+            on_mouse_moved({
+                xpos / (width / 2.0) - 1.0,
+                1.0 - ypos / (height / 2.0)
+            });
+
+            break;
+        }
+
+        case window_event::event_type::RESIZED:
+            on_resized(event.width, event.height);
+            break;
+
+        default: break;
+        }
+    }
+
+    void window::on_events(std::span<const window_event> batch) {
+        for (const window_event& event: batch)
+            dispatch_event(event);
+    }
+
+    // Tries to merge /next/ event into the /last/ one in batch, so handlers are
+    // called once per frame, no matter how often mouse or keyboard report
+    static bool coalesce_events(window_event& last, const window_event& next) {
+        if (last.type != next.type)
+            return false;
+
+        switch (next.type) {
+        case window_event::event_type::MOUSE_MOVED:
+        case window_event::event_type::RESIZED:
+            last = next; // Only the latest position (or size) matters
+            return true;
+
+        case window_event::event_type::KEY_PRESSED:
+            if (!next.is_repeat || last.pressed_key != next.pressed_key)
+                return false;
+
+            last.repeat_count += next.repeat_count;
+            last.timestamp = next.timestamp;
+
+            return true;
+
+        default: return false;
+        }
+    }
+
+    void window::process_events() {
+        event_batch.clear();
+
+        window_event event {};
+        while (events.try_pop(event)) {
+            if (event.type == window_event::event_type::RESIZED) {
+                // Events before resize are handled with the size they were
+                // reported for, so they go before window state is updated
+                if (!event_batch.empty() && event_batch.back().type != event.type) {
+                    on_events(event_batch);
+                    event_batch.clear();
+                }
+
+                width = event.width, height = event.height;
+                framebuffer_width = event.framebuffer_width, framebuffer_height = event.framebuffer_height;
+                gl::raw::viewport(0, 0, event.framebuffer_width, event.framebuffer_height);
+            }
+
+            if (event_batch.empty() || !coalesce_events(event_batch.back(), event))
+                event_batch.push_back(event);
+        }
+
+        if (!event_batch.empty())
+            on_events(event_batch);
+    }
+
+    void window::render_frame() {
+        process_events();
+
+        if (uploads != nullptr)
+            uploads->collect();
+
+        gl::raw::clear(GL_COLOR_BUFFER_BIT);
+
+        draw();
+
+        glfwSwapBuffers(glfw_window);
+
+        // Objects released during this frame are deleted once GPU is past it
+        gpu_resources::collect();
+
+        double current_time = glfwGetTime();
+        fps_counter ++;
+        if (current_time - last_fps_time >= 1.0) {
+            current_fps = fps_counter;
+            on_fps_updated();
+
+            fps_counter = 0;
+            last_fps_time = current_time;
+        }
+    }
+
+    void window::run_render_thread() {
+        // Context can be current only in one thread at a time
+        glfwMakeContextCurrent(nullptr);
+
+        std::exception_ptr render_exception;
+        std::thread render_thread([&]() {
+            bind();
+
+            try {
+                while (is_running.load(std::memory_order_acquire)) {
+                    if (policy == redraw_policy::ON_DEMAND && !wait_for_redraw())
+                        break;
+
+                    render_frame();
+                }
+
+                teardown();
+            } catch (...) {
+                render_exception = std::current_exception();
+            }
+
+            glfwMakeContextCurrent(nullptr);
+
+            // Wake up main thread if it was render thread that decided to stop
+            is_running.store(false, std::memory_order_release);
+            glfwPostEmptyEvent();
         });
+
+        // Main thread only pumps events, callbacks hand them to render thread
+        while (is_running.load(std::memory_order_acquire) &&
+               !glfwWindowShouldClose(glfw_window)) {
+            glfwWaitEvents();
+            push_pending_events();
+        }
+
+        is_running.store(false, std::memory_order_release);
+        wake_render_thread();
+
+        render_thread.join();
+
+        bind(); // Give context back, so GL objects can be freed here
+
+        if (render_exception)
+            std::rethrow_exception(render_exception);
+    }
+
+    void window::enable_background_uploads() {
+        if (uploads == nullptr)
+            uploads = std::make_unique<upload_service>(glfw_window, [this]() { request_redraw(); });
+    }
+
+    upload_service& window::get_upload_service() {
+        if (uploads == nullptr)
+            throw std::runtime_error("Background uploads aren't enabled!");
+
+        return *uploads;
     }
 
     void window::draw_loop() {
@@ -266,31 +659,40 @@ namespace gl {
 
         glfwSetKeyCallback(this->glfw_window, &key_press_callback);
         glfwSetCursorPosCallback(this->glfw_window, &mouse_press_callback);
+        glfwSetFramebufferSizeCallback(this->glfw_window, &framebuffer_resize_callback);
+        glfwSetWindowRefreshCallback(this->glfw_window, &refresh_callback);
 
-        static int fps_counter = 0;
-
-        double last_time = glfwGetTime();
-        while (!glfwWindowShouldClose(glfw_window)) {
-            gl::raw::clear(GL_COLOR_BUFFER_BIT);
+        fps_counter = 0;
+        last_fps_time = glfwGetTime();
 
-            draw();
+        is_running.store(true, std::memory_order_release);
 
-            glfwSwapBuffers(glfw_window);
-            glfwPollEvents();
+        if (render_thread_enabled) {
+            run_render_thread();
+            return;
+        }
 
-            double current_time = glfwGetTime();
-            fps_counter ++;
-            if (current_time - last_time >= 1.0) {
-                current_fps = fps_counter;
-                on_fps_updated();
+        while (!glfwWindowShouldClose(glfw_window)) {
+            render_frame();
 
-                fps_counter = 0;
-                last_time = current_time;
+            if (policy == redraw_policy::ON_DEMAND)
+                wait_events_until_redraw();
+            else {
+                glfwPollEvents();
+                push_pending_events();
             }
         }
+
+        teardown();
     }
 
     window::~window() {
+        // Upload context has to be gone before GLFW is
+        uploads.reset();
+
+        // Objects released by now can only be deleted while context exists
+        gpu_resources::flush();
+
         glfwTerminate();
     }
 
@@ -300,4 +702,20 @@ namespace gl {
         array.bind(); shaders.bind();
         gl::raw::draw_arrays((unsigned int) type, 0, (int) array.get_element_count());
     }
+
+    void draw(drawing_type type, const vertex_array& array, const shaders::shader_program& shaders,
+              size_t first, size_t count) {
+        array.bind(); shaders.bind();
+        gl::raw::draw_arrays((unsigned int) type, (int) first, (int) count);
+    }
+
+    void draw(drawing_type type, const vertex_array& array, const shaders::shader_program& shaders,
+              std::span<const int> firsts, std::span<const int> counts) {
+
+        if (firsts.size() != counts.size())
+            throw std::invalid_argument("Every drawn range should have a count!");
+
+        array.bind(); shaders.bind();
+        gl::raw::multi_draw_arrays((unsigned int) type, firsts.data(), counts.data(), (int) firsts.size());
+    }
 }
@@ -3,13 +3,20 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <initializer_list>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "math.h"
+#include "spsc-queue.h"
+#include "upload-service.h"
 #include "vec.h"
 #include "vertex-array.h"
 #include "vertex-vector-array.h"
@@ -34,6 +41,8 @@ namespace gl::shaders {
 
     std::vector<raw_shader> extract_shaders(std::string filename);
 
+    // Compiled shaders are owned by caller until they're passed to
+    // shader_program::from_shaders, which releases them after linking
     compiled_shader compile_shader(const raw_shader& shader_to_compile);
 
     std::vector<compiled_shader>
@@ -42,12 +51,19 @@ namespace gl::shaders {
 
     class shader_program final {
     private:
-        const unsigned int id;
+        unsigned int id;
 
     public:
         shader_program();
         shader_program(std::string filename);
 
+        shader_program(const shader_program&) = delete;
+        shader_program& operator=(const shader_program&) = delete;
+
+        // Moved from program is left empty (without GL object)
+        shader_program(shader_program&& other) noexcept;
+        shader_program& operator=(shader_program&& other) noexcept;
+
         void bind() const;
         unsigned int get_id() const;
 
@@ -193,15 +209,128 @@ namespace gl {
         MENU          = GLFW_KEY_MENU,
     };
 
+    // Input and window state changes, as they're passed from GLFW callbacks
+    // (that run on main thread) to the thread that renders and handles them
+    struct window_event final {
+        enum class event_type {
+            KEY_PRESSED, MOUSE_MOVED, RESIZED
+        } type;
+
+        // When event was reported (in glfwGetTime's seconds), for
+        // coalesced events it's the time of the latest one
+        double timestamp;
+
+        // ==> KEY_PRESSED only:
+
+        key pressed_key;
+        bool is_repeat;
+
+        // Number of presses (or repeats) merged into this event
+        int repeat_count;
+
+        // Cursor position in screen coordinates (MOUSE_MOVED only)
+        double x, y;
+
+        // New window size in screen coordinates (RESIZED only)
+        int width, height;
+
+        // New framebuffer size in pixels (RESIZED only)
+        int framebuffer_width, framebuffer_height;
+    };
+
+    enum class redraw_policy {
+        // Draw frames back to back, as fast as possible (or vsync allows)
+        CONTINUOUS,
+
+        // Draw only on input, request_redraw or animation tick, sleep otherwise
+        ON_DEMAND
+    };
+
     class window {
     private:
         int current_fps;
         GLFWwindow* glfw_window;
 
+        // ==> Frame loop state:
+
+        int fps_counter = 0;
+        double last_fps_time = 0.0;
+
+        bool render_thread_enabled = false;
+        std::atomic<bool> is_running { false };
+
+        // ==> Input, produced on main thread, consumed on rendering thread:
+
+        static constexpr size_t event_queue_capacity = 1024;
+        spsc_queue<window_event, event_queue_capacity> events;
+
+        // Cursor moves never take these last slots, they're left for
+        // key presses and resizes, that can't be merged into one
+        static constexpr size_t discrete_event_reserve = 256;
+
+        // Producer side: only the latest cursor position is queued, once
+        // callbacks of a poll are done (or before the next discrete event)
+        window_event pending_cursor {};
+        bool has_pending_cursor = false;
+
+        void push_pending_events();
+
+        // Written only by producer, see get_dropped_event_count
+        std::atomic<size_t> dropped_events { 0 };
+
+        // Coalesced events of the current frame, reused between frames
+        std::vector<window_event> event_batch;
+
+        void process_events();
+
+        void render_frame();
+        void run_render_thread();
+
+        // ==> On demand rendering:
+
+        redraw_policy policy = redraw_policy::CONTINUOUS;
+        std::atomic<bool> redraw_requested { false };
+
+        struct animation final {
+            double period, next_tick;
+            bool is_active;
+        };
+
+        // Touched only by the thread that handles events
+        std::vector<animation> animations;
+
+        // Idle render thread sleeps here (only with render thread)
+        std::mutex wakeup_mutex;
+        std::condition_variable wakeup;
+
+        double get_time_until_next_tick(double now) const;
+        bool is_redraw_needed(double now) const;
+
+        void start_on_demand_frame(double now);
+
+        void wake_render_thread();
+
+        // Both return once next frame should be drawn, first one returns
+        // false instead if window was closed while waiting
+        bool wait_for_redraw();
+        void wait_events_until_redraw();
+
+        // ==> Background uploads (if enabled):
+
+        std::unique_ptr<upload_service> uploads;
+
     public:
-        const int width, height;
+        // Current window size (in screen coordinates), changed on resize
+        int width, height;
 
-        window(int width, int height, const char* title);
+        // Current framebuffer size (in pixels), changed on resize. Unlike
+        // glfwGetFramebufferSize, can be read from the render thread.
+        int framebuffer_width, framebuffer_height;
+
+        // Non-zero /msaa_samples/ makes framebuffer multisampled, which
+        // antialiases everything without shaders' help (but costs memory
+        // and fill rate), see also drawing_manager::set_antialiasing
+        window(int width, int height, const char* title, int msaa_samples = 0);
 
         // This class shouldn't be copied or moved
         window(const window&) = delete;
@@ -212,13 +341,58 @@ namespace gl {
         int get_fps() const noexcept;
         GLFWwindow* get_glfw_window() const noexcept;
 
+        // Key presses and resizes lost because the thread that handles
+        // them fell too far behind (cursor moves are merged, not lost)
+        size_t get_dropped_event_count() const noexcept;
+
+        // Render thread owns GL context and handles input, while main thread
+        // only waits for events, so slow frames don't delay input processing
+        // (and vice versa). Should be chosen before draw_loop is called.
+        void use_render_thread(bool enabled = true);
+
+        // ==> Redrawing control:
+
+        // Should be chosen before draw_loop is called
+        void set_redraw_policy(redraw_policy new_policy);
+
+        // Schedules a frame in ON_DEMAND mode (can be called from any thread)
+        void request_redraw();
+
+        using animation_id = size_t;
+
+        // Animation keeps ON_DEMAND window redrawing at its own rate while
+        // it's active. Animations should be managed from setup or handlers.
+        animation_id register_animation(double tick_rate);
+        void set_animation_active(animation_id id, bool is_active);
+
+        // ==> Background uploads:
+
+        // Creates a hidden context that shares objects with this window, its
+        // finished uploads are handed back at the start of every frame (and
+        // request a redraw). Should be enabled before draw_loop is called.
+        void enable_background_uploads();
+        upload_service& get_upload_service();
+
         void draw_loop();
 
+        // Called from GLFW callbacks, not meant to be used directly
+        void push_event(const window_event& event);
+
         virtual void setup() {};
         virtual void draw() = 0;
 
+        // Called after window is closed (at the end of draw_loop)
+        virtual void teardown() {};
+
         virtual void on_fps_updated() {};
 
+        // Called once per frame with all events that happened since the last
+        // one: cursor moves are merged into the latest position and key
+        // repeats are counted. Batch is split at resizes, so that events of
+        // one call are all for the same window size. By default calls
+        // handlers below for each.
+        virtual void on_events(std::span<const window_event> batch);
+
         virtual void on_key_pressed(key pressed_key) {
             (void) pressed_key; // Ignore parameter
         };
@@ -227,7 +401,15 @@ namespace gl {
             (void) cursor; // Ignore parameter
         }
 
+        virtual void on_resized(int new_width, int new_height) {
+            (void) new_width, (void) new_height; // Ignore parameters
+        }
+
         virtual ~window();
+
+    protected:
+        // Calls handler corresponding to event's type
+        void dispatch_event(const window_event& event);
     };
 
     enum class drawing_type {
@@ -248,8 +430,16 @@ namespace gl {
     void draw(drawing_type type, const vertex_array& array,
               const shaders::shader_program& shaders);
 
-    template <typename value_type>
-    void draw(drawing_type type, const vertex_vector_array<value_type>& array,
+    // Draws only /count/ elements starting from /first/
+    void draw(drawing_type type, const vertex_array& array,
+              const shaders::shader_program& shaders, size_t first, size_t count);
+
+    // Draws several ranges (/firsts/[i], /counts/[i]) with a single call
+    void draw(drawing_type type, const vertex_array& array, const shaders::shader_program& shaders,
+              std::span<const int> firsts, std::span<const int> counts);
+
+    template <typename value_type, typename allocator_type>
+    void draw(drawing_type type, const vertex_vector_array<value_type, allocator_type>& array,
               const shaders::shader_program& shaders) {
 
         draw(type, array.get_vertex_array(), shaders);
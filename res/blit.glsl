@@ -0,0 +1,23 @@
+#shader vertex   ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+// Single triangle that covers the whole viewport
+layout(location = 0) in vec2 position;
+
+void main() {
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+#shader fragment ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+out vec4 color;
+
+uniform sampler2D image; // Same size as the viewport, rows go from top to bottom
+
+void main() {
+    ivec2 size = textureSize(image, 0);
+    color = texelFetch(image, ivec2(gl_FragCoord.x, size.y - 1 - int(gl_FragCoord.y)), 0);
+}
@@ -4,12 +4,30 @@
 
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec4 color;
+layout(location = 2) in float depth;
+
+// Plain vertices (see plain_vertex) don't have these, attributes without
+// arrays read as (0, 0, 0, 1), so there are no edges and no shape
+layout(location = 3) in vec2 edge;
+layout(location = 4) in vec4 shape;
 
 out vec4 frag_color;
+out vec2 frag_edge;
+flat out vec4 frag_shape;
+
+// Maps positions into view, frames are recorded in view coordinates already,
+// retained primitives (see retained_scene::draw_gpu) are in world ones
+uniform vec2 scale = vec2(1.0);
+uniform vec2 shift = vec2(0.0);
 
 void main() {
     frag_color = color;
-    gl_Position = position;
+    frag_edge = edge;
+    frag_shape = shape;
+
+    // Drawing order to depth: later triangles are closer, step of 2^-22 is two
+    // steps of a 24-bit depth buffer (which maps [-1, 1] to [0, 1])
+    gl_Position = vec4(position.xy * scale + shift, 1.0 - depth * (1.0 / 4194304.0), 1.0);
 }
 
 #shader fragment ------------------------------------------------------------------------------------------
@@ -17,8 +35,72 @@ void main() {
 #version 460 core
 
 in vec4 frag_color;
+in vec2 frag_edge;
+flat in vec4 frag_shape;
+
 out vec4 color;
 
+// Shape kinds, same as drawing_manager::sdf_shape
+const int SHAPE_NONE               = 0;
+const int SHAPE_CIRCLE             = 1;
+const int SHAPE_RING               = 2;
+const int SHAPE_ROUNDED_RECT       = 3;
+const int SHAPE_ISOSCELES_TRIANGLE = 4;
+
+// Edge distance is 1 on line's boundary, derivatives tell how much it
+// changes per pixel, so this is (signed) distance to the boundary in pixels,
+// which is turned into coverage of the pixel. Zero distance (no edges) gives
+// zero derivatives and full coverage.
+float edge_coverage(float distance) {
+    float pixel = max(fwidth(distance), 1e-6);
+    return clamp(0.5 + (1.0 - abs(distance)) / pixel, 0.0, 1.0);
+}
+
+// Signed distance to the shape's boundary (negative inside), in shape's own
+// coordinates, where the shape is centered at the origin
+float shape_distance(int kind, vec2 p, vec3 parameters) {
+    switch (kind) {
+    case SHAPE_CIRCLE:
+        return length(p) - parameters.x;
+
+    case SHAPE_RING:
+        return abs(length(p) - parameters.x) - parameters.y;
+
+    case SHAPE_ROUNDED_RECT: {
+        vec2 q = abs(p) - parameters.xy + parameters.z;
+        return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - parameters.z;
+    }
+
+    case SHAPE_ISOSCELES_TRIANGLE: {
+        // Half of base's width and height, tip is on top (at -height / 2)
+        vec2 q = parameters.xy;
+        p = vec2(abs(p.x), p.y + q.y / 2.0);
+
+        vec2 a = p - q * clamp(dot(p, q) / dot(q, q), 0.0, 1.0);
+        vec2 b = p - q * vec2(clamp(p.x / q.x, 0.0, 1.0), 1.0);
+
+        float k = sign(q.y);
+        float d = min(dot(a, a), dot(b, b));
+        float s = max(k * (p.x * q.y - p.y * q.x), k * (p.y - q.y));
+
+        return sqrt(d) * sign(s);
+    }
+
+    default:
+        return 0.0;
+    }
+}
+
 void main() {
-    color = frag_color;
+    int kind = int(frag_shape.x + 0.5);
+
+    // Derivatives are taken outside of branches, where they're well defined
+    float distance = shape_distance(kind, frag_edge, frag_shape.yzw);
+    float pixel = max(length(vec2(dFdx(distance), dFdy(distance))), 1e-6);
+
+    float coverage = kind == SHAPE_NONE
+        ? edge_coverage(frag_edge.x) * edge_coverage(frag_edge.y)
+        : clamp(0.5 - distance / pixel, 0.0, 1.0);
+
+    color = vec4(frag_color.rgb, frag_color.a * coverage);
 }
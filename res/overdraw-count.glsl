@@ -0,0 +1,23 @@
+#shader vertex   ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+// Same vertices as res/gradient.glsl, only position and depth matter
+layout(location = 0) in vec4 position;
+layout(location = 2) in float depth;
+
+void main() {
+    gl_Position = vec4(position.xy, 1.0 - depth * (1.0 / 4194304.0), 1.0);
+}
+
+#shader fragment ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+out vec4 color;
+
+// Added up (with one, one blending) into a float target, so every
+// pixel ends up with the number of fragments shaded for it
+void main() {
+    color = vec4(1.0, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,42 @@
+#shader vertex   ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+// Single triangle that covers the whole viewport
+layout(location = 0) in vec2 position;
+
+void main() {
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+#shader fragment ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+out vec4 color;
+
+uniform sampler2D counts;     // Fragments shaded per pixel
+uniform float max_overdraw;   // Shown as the hottest color
+
+const int stop_count = 5;
+const vec3 stops[stop_count] = vec3[](
+    vec3(0.0, 0.0, 0.6), // Shaded once
+    vec3(0.0, 0.6, 1.0),
+    vec3(0.0, 0.9, 0.2),
+    vec3(1.0, 0.9, 0.0),
+    vec3(1.0, 0.0, 0.0)  // max_overdraw and more
+);
+
+void main() {
+    float count = texelFetch(counts, ivec2(gl_FragCoord.xy), 0).r;
+
+    if (count < 0.5) {
+        color = vec4(0.0, 0.0, 0.0, 1.0); // Never shaded
+        return;
+    }
+
+    float t = clamp((count - 1.0) / max(max_overdraw - 1.0, 1.0), 0.0, 1.0) * float(stop_count - 1);
+    int stop = min(int(t), stop_count - 2);
+
+    color = vec4(mix(stops[stop], stops[stop + 1], t - float(stop)), 1.0);
+}
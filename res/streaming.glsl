@@ -0,0 +1,25 @@
+#shader vertex   ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+layout(location = 0) in vec2 position;
+
+// Maps samples (stored relative to series' origin) into view, scrolling
+// is just a change of shift, samples in the buffer are never touched
+uniform vec2 scale;
+uniform vec2 shift;
+
+void main() {
+    gl_Position = vec4(position * scale + shift, 0.0, 1.0);
+}
+
+#shader fragment ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+uniform vec4 series_color;
+out vec4 color;
+
+void main() {
+    color = series_color;
+}
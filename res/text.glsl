@@ -0,0 +1,39 @@
+#shader vertex   ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec4 color;
+
+out vec2 frag_uv;
+out vec4 frag_color;
+
+void main() {
+    frag_uv = uv;
+    frag_color = color;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+#shader fragment ------------------------------------------------------------------------------------------
+
+#version 460 core
+
+in vec2 frag_uv;
+in vec4 frag_color;
+
+out vec4 color;
+
+// Signed distance field of glyphs (see glyph-atlas.h), 0.5 on the outline
+uniform sampler2D atlas;
+
+void main() {
+    float distance = texture(atlas, frag_uv).r;
+
+    // Derivative says how much distance changes per screen pixel,
+    // so the edge is exactly one pixel wide at any text size
+    float pixel = max(fwidth(distance), 1e-6);
+    float coverage = clamp((distance - 0.5) / pixel + 0.5, 0.0, 1.0);
+
+    color = vec4(frag_color.rgb, frag_color.a * coverage);
+}
@@ -0,0 +1,143 @@
+#include "command-replay.h"
+#include "drawing-manager.h"
+#include "offscreen-canvas.h"
+#include "opengl-setup.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Replays a recording (see command_recorder) into an offscreen canvas and
+// prints how long each frame took, e.g. to compare two builds on exactly
+// the same frames. Software backend is used by default, it needs no GPU or
+// display, --gl replays with GL in a hidden window instead. With --repeat N
+// recording is replayed N times and the fastest time of each frame is kept.
+// Checksums of software frames don't change unless output does.
+
+static uint64_t get_checksum(const gl::rgba_image& image) {
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (uint8_t byte: image.pixels)
+        hash = (hash ^ byte) * 1099511628211ull;
+
+    return hash;
+}
+
+// Only provides a GL context, it's never shown
+class context_window: public gl::window {
+public:
+    using gl::window::window;
+    void draw() override {}
+};
+
+static double get_percentile(std::vector<double> times, double fraction) {
+    std::sort(times.begin(), times.end());
+    return times[(size_t) (fraction * (double) (times.size() - 1) + 0.5)];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <recording> [--gl] [--repeat N]\n";
+        return 1;
+    }
+
+    bool with_gl = false;
+    size_t repeat_count = 1;
+
+    for (int i = 2; i < argc; ++ i) {
+        if (std::strcmp(argv[i], "--gl") == 0)
+            with_gl = true;
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat_count = std::max<size_t>(std::strtoul(argv[++ i], nullptr, 10), 1);
+        else
+            throw std::invalid_argument("Unknown option \"" + std::string(argv[i]) + "\"!");
+    }
+
+    gl::command_replay replay(argv[1]);
+    const size_t frame_count = replay.get_frame_count();
+
+    std::unique_ptr<context_window> context;
+    if (with_gl) {
+        if (!glfwInit())
+            throw std::runtime_error("Failed to initialize glfw!");
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        context = std::make_unique<context_window>(64, 64, "draw-replay");
+    }
+
+    const gl::render_backend backend = with_gl ? gl::render_backend::OPENGL : gl::render_backend::SOFTWARE;
+
+    // Milliseconds per frame (fastest of repeats), minimized frames aren't timed
+    std::vector<double> times(frame_count, -1.0);
+    std::vector<uint64_t> checksums(frame_count, 0);
+
+    std::unique_ptr<gl::offscreen_canvas> canvas;
+
+    for (size_t repeat = 0; repeat < repeat_count; ++ repeat) {
+        for (size_t i = 0; i < frame_count; ++ i) {
+            const gl::recorded_frame& frame = replay.get_frame(i);
+            if (frame.viewport_width == 0 || frame.viewport_height == 0)
+                continue;
+
+            // Canvas is only recreated when window was resized
+            if (canvas == nullptr || canvas->get_image().width != frame.viewport_width ||
+                                     canvas->get_image().height != frame.viewport_height) {
+                canvas = std::make_unique<gl::offscreen_canvas>(frame.viewport_width,
+                                                                frame.viewport_height, backend);
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            const gl::rgba_image& image = canvas->render([&](gl::drawing_manager& mgr) {
+                replay.replay(i, mgr);
+            });
+
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (times[i] < 0.0 || elapsed.count() < times[i])
+                times[i] = elapsed.count();
+
+            checksums[i] = get_checksum(image);
+        }
+    }
+
+    std::vector<double> timed;
+    std::printf("%8s %10s %8s %8s %18s\n", "frame", "time, ms", "calls", "events", "checksum");
+
+    for (size_t i = 0; i < frame_count; ++ i) {
+        const gl::recorded_frame& frame = replay.get_frame(i);
+        if (times[i] < 0.0)
+            continue;
+
+        std::printf("%8zu %10.3f %8zu %8zu %18llx\n", i, times[i], frame.call_count,
+                    frame.events.size(), (unsigned long long) checksums[i]);
+
+        timed.push_back(times[i]);
+    }
+
+    if (timed.empty()) {
+        std::cout << "recording has no frames to replay\n";
+        return 0;
+    }
+
+    double total = 0.0;
+    for (double time: timed)
+        total += time;
+
+    std::printf("\n%zu frames (%s, %zu repeats): total %.3f ms, "
+                "min %.3f, median %.3f, p95 %.3f, max %.3f ms/frame\n",
+                timed.size(), with_gl ? "opengl" : "software", repeat_count, total,
+                get_percentile(timed, 0.0), get_percentile(timed, 0.5),
+                get_percentile(timed, 0.95), get_percentile(timed, 1.0));
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "drawing-manager.h"
+#include "offscreen-canvas.h"
+#include "opengl-setup.h"
+#include "thread-pool.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// Renders the same scene with the software rasterizer (on one thread and
+// on every core) and, with --gl, with GL in a hidden window, then compares
+// timings and images. Software images should be identical to each other.
+
+static constexpr size_t width = 1920, height = 1080;
+static constexpr int frames = 20;
+
+static void draw_scene(gl::drawing_manager& mgr) {
+    rectangle axes { { -1.0f, -1.0f }, { 1.0f, 1.0f } };
+    mgr.set_axes(axes);
+
+    // Overlapping translucent triangles
+    for (int i = 0; i < 400; ++ i) {
+        const float angle = (float) i * 0.37f, radius = 0.2f + 0.6f * (float) (i % 17) / 17.0f;
+        const math::vec2 center { radius * std::cos(angle), radius * std::sin(angle) };
+
+        mgr.set_color({ 0.5f + 0.5f * std::sin(angle), 0.4f, 0.5f + 0.5f * std::cos(angle) });
+        mgr.set_alpha(0.35f);
+
+        mgr.draw_triangle(center, { center.x() + 0.15f, center.y() }, { center.x(), center.y() + 0.2f });
+    }
+
+    // Thousands of thin antialiased lines
+    mgr.set_alpha(0.8f);
+    mgr.set_width(0.002f);
+    mgr.set_antialiasing(gl::antialiasing_mode::ANALYTIC);
+
+    for (int i = 0; i < 1000; ++ i) {
+        const float t = (float) i / 1000.0f;
+
+        mgr.set_color({ t, 1.0f - t, 0.5f });
+        mgr.draw_antialiased_line({ -1.0f + 2.0f * t, -0.9f }, { std::sin(t * 40.0f), 0.9f });
+    }
+
+    // SDF shapes
+    mgr.set_alpha(1.0f);
+    for (int i = 0; i < 2000; ++ i) {
+        const float x = -0.95f + 1.9f * (float) (i % 50) / 50.0f, y = -0.95f + 1.9f * (float) (i / 50) / 40.0f;
+
+        mgr.set_color({ 0.9f, 0.6f, 0.1f });
+
+        if (i % 2 == 0)
+            mgr.draw_circle({ x, y }, 0.012f);
+        else
+            mgr.draw_ring({ x, y }, 0.012f, 0.003f);
+    }
+}
+
+static uint64_t get_checksum(const gl::rgba_image& image) {
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (uint8_t byte: image.pixels)
+        hash = (hash ^ byte) * 1099511628211ull;
+
+    return hash;
+}
+
+// Largest difference of a channel between two images of the same size
+static int get_max_difference(const gl::rgba_image& first, const gl::rgba_image& second) {
+    int max_difference = 0;
+    for (size_t i = 0; i < first.pixels.size(); ++ i)
+        max_difference = std::max(max_difference, std::abs((int) first.pixels[i] - (int) second.pixels[i]));
+
+    return max_difference;
+}
+
+// Milliseconds per frame
+static double time_frames(gl::offscreen_canvas& canvas) {
+    canvas.render(draw_scene); // Warm up
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++ i)
+        canvas.render(draw_scene);
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+// Only provides a GL context, it's never shown
+class context_window: public gl::window {
+public:
+    using gl::window::window;
+    void draw() override {}
+};
+
+int main(int argc, char** argv) {
+    const bool with_gl = argc > 1 && std::strcmp(argv[1], "--gl") == 0;
+
+    gl::thread_pool single_thread(1);
+
+    gl::offscreen_canvas serial(width, height, gl::render_backend::SOFTWARE, single_thread);
+    gl::offscreen_canvas parallel(width, height, gl::render_backend::SOFTWARE);
+
+    const double serial_time = time_frames(serial), parallel_time = time_frames(parallel);
+
+    std::cout << "software, 1 thread:  " << serial_time << " ms/frame\n"
+              << "software, " << gl::thread_pool::global().size() << " threads: "
+              << parallel_time << " ms/frame\n";
+
+    const bool is_identical = get_checksum(serial.get_image()) == get_checksum(parallel.get_image());
+    std::cout << "images are " << (is_identical ? "identical" : "DIFFERENT") << "\n";
+
+    if (with_gl) {
+        if (!glfwInit())
+            throw std::runtime_error("Failed to initialize glfw!");
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        context_window context(64, 64, "raster-benchmark");
+
+        gl::offscreen_canvas hardware(width, height, gl::render_backend::OPENGL);
+        const double gl_time = time_frames(hardware);
+
+        std::cout << "opengl (with readback): " << gl_time << " ms/frame\n"
+                  << "max channel difference from software: "
+                  << get_max_difference(hardware.get_image(), parallel.get_image()) << "\n";
+    }
+
+    return is_identical ? 0 : 1;
+}
@@ -1,9 +1,15 @@
 #include "axes.h"
+#include "command-recorder.h"
 #include "drawing-manager.h"
 #include "gl.h"
 #include "opengl-setup.h"
+#include "retained-scene.h"
 #include "simple-window.h"
 
+#include <cstring>
+#include <iostream>
+#include <memory>
+
 class vector_drawer: public gl::simple_drawing_window {
 public:
     using gl::simple_drawing_window::simple_drawing_window;
@@ -25,6 +31,11 @@ public:
         const float right_delta = 0.2f;
         m_selectable_vec_axes =
             right_view.shrink({ right_delta, right_delta });
+
+        build_selectable_scene();
+
+        // Keeps window redrawing while vector rotates, even without input
+        register_animation(ROTATION_TICK_RATE);
     }
 
     void loop_draw(gl::drawing_manager &mgr) override {
@@ -42,14 +53,24 @@ public:
         mgr.set_color({ 0.5f, 0.7f, 0.3f });
 
         mgr.set_axes(m_rotating_vec_axes);
-        if (get_fps()) // At the start (before enough data is collected), fps is zero
-            m_rotating_vec.rotate(-0.1f / (float) get_fps());
+
+        // Frames aren't evenly spaced with on demand redrawing, use real time
+        double current_time = glfwGetTime();
+        m_rotating_vec.rotate(-0.1 * (current_time - m_last_rotation_time));
+        m_last_rotation_time = current_time;
 
         draw_vec_with_axes(mgr, m_rotating_vec);
 
-        mgr.set_axes(m_selectable_vec_axes);
-        draw_vec_with_axes(mgr, m_selectable_vec);
+        if (is_selectable_panel_tessellated()) {
+            mgr.set_axes(m_selectable_vec_axes);
+            m_selectable_scene.draw(mgr);
+        }
+    }
 
+    void window_draw() override {
+        // Selectable panel is kept on GPU, only the moved vector is uploaded again
+        if (!is_selectable_panel_tessellated())
+            m_selectable_scene.draw_gpu(m_selectable_vec_axes);
     }
 
     void on_key_pressed(gl::key pressed_key) override {
@@ -75,13 +96,13 @@ public:
         math::vec transformed =
             m_selectable_vec_axes.get_world_coordinates(cursor);
 
-        if (transformed.x() > +1.0f || transformed.y() > +1.0f)
-            return;
-
-        if (transformed.x() < -1.0f || transformed.y() < -1.0f)
+        // Only the area itself counts, not frame's lines sticking out of it
+        const auto picked = m_selectable_scene.pick(transformed, 0.0f);
+        if (picked != m_selectable_area[0] && picked != m_selectable_area[1])
             return;
 
         m_selectable_vec = transformed;
+        m_selectable_scene.move_line(m_selectable_vec_id, { 0.0f, 0.0f }, m_selectable_vec);
     }
 
 private:
@@ -89,12 +110,27 @@ private:
     math::vec2 m_selectable_vec = { 0.6f,  0.6f };
     math::vec2   m_rotating_vec = { 0.6f,  0.6f };
 
+    double m_last_rotation_time = glfwGetTime();
+    const double ROTATION_TICK_RATE = 60.0; // Hz
+
 
     axes m_rotating_vec_axes, m_selectable_vec_axes;
 
+    // Selectable vector's panel doesn't change between frames, except for
+    // the vector itself, so it's kept in a scene that's also used for picking
+    // (drawn from GL thread, so event handlers can change it directly)
+    gl::retained_scene m_selectable_scene;
+    gl::retained_scene::primitive_id m_selectable_vec_id = 0, m_selectable_area[2] = { 0, 0 };
+
     const float BOUNDING_BOX_WIDTH = 0.02f;
     const float AXES_WIDTH = 0.02f;
 
+    // Overdraw counting, recording and software rendering only see what goes
+    // through drawing_manager, so then panel is drawn with the rest of frame
+    bool is_selectable_panel_tessellated() const {
+        return is_overdraw_mode() || is_software_rendering() || get_recorder() != nullptr;
+    }
+
     void draw_bounding_box(gl::drawing_manager &mgr) {
         // All sides of our available rectangle:
         math::vec x0 = { -1.0f, -1.0f }, x1 = { -1.0f,   1.0f };
@@ -113,6 +149,34 @@ private:
     }
 
 
+    // Same as draw_vec_with_axes, but retained
+    void build_selectable_scene() {
+        math::vec x0 = { -1.0f, -1.0f }, x1 = { -1.0f,   1.0f };
+        math::vec x2 = {  1.0f,  1.0f }, x3 = {  1.0f,  -1.0f };
+
+        const math::vec4 line_color = { 0.0f, 0.4f, 0.2f, 1.0f };
+
+        m_selectable_scene.clear();
+
+        m_selectable_scene.add_line(x0, x1, line_color, BOUNDING_BOX_WIDTH);
+        m_selectable_scene.add_line(x1, x2, line_color, BOUNDING_BOX_WIDTH);
+        m_selectable_scene.add_line(x2, x3, line_color, BOUNDING_BOX_WIDTH);
+        m_selectable_scene.add_line(x3, x0, line_color, BOUNDING_BOX_WIDTH);
+
+        m_selectable_vec_id = m_selectable_scene.add_vector({ 0.0f, 0.0f }, m_selectable_vec,
+                                                            line_color, BOUNDING_BOX_WIDTH * 1.5f);
+
+        m_selectable_scene.add_line({  0.0f, -1.0f }, {  0.0f, 1.0f }, line_color, AXES_WIDTH);
+        m_selectable_scene.add_line({ -1.0f,  0.0f }, {  1.0f, 0.0f }, line_color, AXES_WIDTH);
+
+        // Area is transparent, so it can go on top: pick prefers
+        // primitives drawn later, and it shouldn't lose to lines inside it
+        const math::vec4 area_color = { 0.5f, 0.5f, 0.5f, 0.0f };
+
+        m_selectable_area[0] = m_selectable_scene.add_triangle(x0, x1, x2, area_color);
+        m_selectable_area[1] = m_selectable_scene.add_triangle(x2, x3, x0, area_color);
+    }
+
     void draw_vec_with_axes(gl::drawing_manager &mgr, math::vec2 vector) {
         // All sides of our available rectangle:
         math::vec x0 = { -1.0f, -1.0f }, x1 = { -1.0f,   1.0f };
@@ -143,7 +207,24 @@ private:
 
 };
 
-int main() {
+int main(int argc, char** argv) {
     vector_drawer drawer(1080, 1080, "My vector drawer!");
+
+    // Nothing changes between input events and rotation ticks, so don't
+    // waste CPU and GPU on drawing the same frame over and over again
+    drawer.set_redraw_policy(gl::redraw_policy::ON_DEMAND);
+
+    // Overdraw mode (F2) reports how much each frame shades
+    drawer.set_overdraw_callback([](const gl::overdraw_report& report) {
+        std::cout << report << std::endl;
+    });
+
+    // With "--record <file>" the session can be replayed later (see draw-replay)
+    std::unique_ptr<gl::command_recorder> recorder;
+    if (argc == 3 && std::strcmp(argv[1], "--record") == 0) {
+        recorder = std::make_unique<gl::command_recorder>(argv[2]);
+        drawer.set_recorder(recorder.get());
+    }
+
     drawer.draw_loop();
 }